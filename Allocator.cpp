@@ -0,0 +1,192 @@
+#include "Allocator.h"
+#include <cstdlib>
+#include <new>
+#include <atomic>
+#include <cstdint>
+#include <sys/mman.h>
+
+namespace {
+
+size_t huge_length(size_t size)
+{
+  return (size + huge_page - 1) / huge_page * huge_page;
+}
+
+// 多映射一个大页，截去首尾使起点按大页对齐
+void *map_huge(size_t size)
+{
+  size_t len = huge_length(size);
+  if(len < size)
+    throw std::bad_alloc();
+  void *p = mmap(nullptr, len + huge_page, PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if(p == MAP_FAILED)
+    throw std::bad_alloc();
+  uintptr_t a = (uintptr_t)p;
+  uintptr_t b = (a + huge_page - 1) / huge_page * huge_page;
+  if(b > a)
+    munmap(p, b - a);
+  munmap((void *)(b + len), a + huge_page - b);
+  madvise((void *)b, len, MADV_HUGEPAGE);
+  return (void *)b;
+}
+
+class MallocAllocator : public Allocator {
+public:
+  void *allocate(size_t size) override
+  {
+    if(size >= huge_alloc_min)
+      return map_huge(size);
+    void *p;
+    if(posix_memalign(&p, alloc_align, size))
+      throw std::bad_alloc();
+    return p;
+  }
+
+  void deallocate(void *p, size_t size) noexcept override
+  {
+    if(size >= huge_alloc_min)
+      munmap(p, huge_length(size));
+    else
+      free(p);
+  }
+};
+
+// 尺寸分级：64 字节以下为一级，其上每个二倍区间再均分四级
+constexpr size_t min_block = 64;
+constexpr size_t nclass = 4 * (20 - 6) + 1;     // 覆盖到 pool_max
+constexpr size_t cache_limit = 32 << 20;        // 每个线程缓存的字节数上限
+
+static_assert(pool_max == (size_t)1 << 20);
+
+// 返回 size 所属级别，block 置为该级的块大小
+size_t size_class(size_t size, size_t &block)
+{
+  if(size <= min_block)
+  {
+    block = min_block;
+    return 0;
+  }
+  unsigned p = 63 - __builtin_clzll(size - 1);  // 2^p < size <= 2^(p+1)
+  size_t k = (size - 1) >> (p - 2);              // 4 <= k < 8
+  block = (k + 1) << (p - 2);
+  return (p - 6) * 4 + (k - 4) + 1;
+}
+
+struct FreeBlock {
+  FreeBlock *next;
+};
+
+class Pool {
+private:
+  FreeBlock  *lists[nclass] = { };
+  PoolStats  stats = { };
+  bool       alive = true;
+
+public:
+  ~Pool()
+  {
+    release();
+    alive = false;
+  }
+
+  void *allocate(size_t size)
+  {
+    ++stats.allocs;
+    if(size > pool_max)
+      return malloc_allocator().allocate(size);
+    size_t block, c = size_class(size, block);
+    if(FreeBlock *b = lists[c])
+    {
+      lists[c] = b->next;
+      ++stats.hits;
+      --stats.cached_blocks;
+      stats.cached_bytes -= block;
+      return b;
+    }
+    return malloc_allocator().allocate(block);
+  }
+
+  void deallocate(void *p, size_t size)
+  {
+    ++stats.frees;
+    if(size > pool_max)
+      return malloc_allocator().deallocate(p, size);
+    size_t block, c = size_class(size, block);
+    // 线程退出后析构的矩阵直接释放
+    if(!alive || stats.cached_bytes + block > cache_limit)
+      return free(p);
+    FreeBlock *b = (FreeBlock *)p;
+    b->next = lists[c];
+    lists[c] = b;
+    ++stats.cached_blocks;
+    stats.cached_bytes += block;
+  }
+
+  size_t release()
+  {
+    size_t bytes = stats.cached_bytes;
+    for(FreeBlock *&head : lists)
+      while(FreeBlock *b = head)
+      {
+        head = b->next;
+        free(b);
+      }
+    stats.cached_blocks = 0;
+    stats.cached_bytes = 0;
+    return bytes;
+  }
+
+  PoolStats get_stats() const { return stats; }
+};
+
+thread_local Pool pool;
+
+class PoolAllocator : public Allocator {
+public:
+  void *allocate(size_t size) override
+  {
+    return pool.allocate(size);
+  }
+
+  void deallocate(void *p, size_t size) noexcept override
+  {
+    pool.deallocate(p, size);
+  }
+};
+
+MallocAllocator              malloc_alloc;
+PoolAllocator                pool_alloc;
+std::atomic<Allocator *>     current(&pool_alloc);
+
+}  // namespace
+
+Allocator &malloc_allocator()
+{
+  return malloc_alloc;
+}
+
+Allocator &pool_allocator()
+{
+  return pool_alloc;
+}
+
+void set_allocator(Allocator &alloc)
+{
+  current = &alloc;
+}
+
+Allocator &get_allocator()
+{
+  return *current.load(std::memory_order_relaxed);
+}
+
+PoolStats pool_stats()
+{
+  return pool.get_stats();
+}
+
+size_t pool_release()
+{
+  return pool.release();
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Basic.h"
+
+// 分配的内存按缓存行对齐
+constexpr size_t alloc_align = 64;
+
+// 矩阵数据区分配器接口
+// 数据区记录分配它的分配器，释放时交还原分配器，分配器须比其分配的数据区存活更久
+class Allocator {
+public:
+  virtual ~Allocator() = default;
+
+  // 分配至少 size 字节，按 alloc_align 对齐，失败时抛 bad_alloc
+  virtual void *allocate(size_t size) = 0;
+
+  // 归还 allocate(size) 得到的内存，可在任意线程调用
+  virtual void deallocate(void *p, size_t size) noexcept = 0;
+};
+
+// 直接调用 posix_memalign 和 free
+// 不小于 huge_alloc_min 字节的块改用 mmap 按大页对齐映射，并建议内核使用透明大页
+Allocator &malloc_allocator();
+constexpr size_t huge_alloc_min = 64 << 20;
+constexpr size_t huge_page = 2 << 20;
+
+// 按尺寸分级的线程局部池（默认分配器）
+// 小于 pool_max 字节的块释放后留在当前线程的空闲链表中供再次分配，
+// 更大的块直接向系统申请和释放；每个线程缓存的总字节数有上限，超出部分直接释放
+Allocator &pool_allocator();
+constexpr size_t pool_max = 1 << 20;
+
+// 设置新建矩阵使用的分配器，对所有线程生效
+void set_allocator(Allocator &);
+
+// 获取新建矩阵使用的分配器
+Allocator &get_allocator();
+
+// 当前线程的池统计
+struct PoolStats {
+  size_t allocs;         // 分配次数
+  size_t hits;           // 由空闲链表满足的分配次数
+  size_t frees;          // 释放次数
+  size_t cached_blocks;  // 空闲链表中的块数
+  size_t cached_bytes;   // 空闲链表中的字节数
+};
+PoolStats pool_stats();
+
+// 将当前线程空闲链表中的块全部交还系统，返回交还的字节数
+// 线程退出时自动调用
+size_t pool_release();
@@ -0,0 +1,157 @@
+#include "TestBasic.h"
+#include "Allocator.h"
+#include "Matrix.h"
+#include <thread>
+#include <vector>
+#include <ctime>
+#include <cstdint>
+
+using namespace std;
+
+void test_malloc_allocator();
+void test_pool();
+void test_pool_threads();
+void test_set_allocator();
+void test_pool_repeat();
+
+int main()
+{
+  test_malloc_allocator();
+  test_pool();
+  test_pool_threads();
+  test_set_allocator();
+  test_pool_repeat();
+}
+
+void test_malloc_allocator()
+{
+  Allocator &alloc = malloc_allocator();
+  void *p = alloc.allocate(100);
+  assert(p && (uintptr_t)p % alloc_align == 0);
+  alloc.deallocate(p, 100);
+  ASSERT_EXCEPTION(bad_alloc, alloc.allocate(~(size_t)0 / 2);)
+
+  // 大块按大页对齐映射
+  size_t size = huge_alloc_min + 100;
+  char *h = (char *)alloc.allocate(size);
+  assert((uintptr_t)h % huge_page == 0);
+  h[0] = h[size - 1] = 1;
+  alloc.deallocate(h, size);
+  TEST_PASSED;
+}
+
+// 同级的块释放后被再次分配
+void test_pool()
+{
+  Allocator &alloc = pool_allocator();
+  pool_release();
+  PoolStats s0 = pool_stats();
+  assert(s0.cached_blocks == 0 && s0.cached_bytes == 0);
+
+  void *p = alloc.allocate(65);
+  alloc.deallocate(p, 65);
+  PoolStats s1 = pool_stats();
+  assert(s1.allocs == s0.allocs + 1 && s1.frees == s0.frees + 1);
+  assert(s1.cached_blocks == 1 && s1.cached_bytes >= 65);
+
+  void *q = alloc.allocate(70);
+  assert(q == p);
+  PoolStats s2 = pool_stats();
+  assert(s2.hits == s1.hits + 1 && s2.cached_blocks == 0 && s2.cached_bytes == 0);
+
+  // 不同级的块不复用
+  void *r = alloc.allocate(1000);
+  assert(r != q && (uintptr_t)r % alloc_align == 0);
+  alloc.deallocate(q, 70);
+  alloc.deallocate(r, 1000);
+  assert(pool_stats().cached_blocks == 2);
+
+  // 超过 pool_max 的块不缓存
+  void *big = alloc.allocate(pool_max + 1);
+  alloc.deallocate(big, pool_max + 1);
+  assert(pool_stats().cached_blocks == 2);
+
+  size_t bytes = pool_stats().cached_bytes;
+  assert(pool_release() == bytes);
+  assert(pool_stats().cached_blocks == 0 && pool_stats().cached_bytes == 0);
+  TEST_PASSED;
+}
+
+// 其他线程分配的矩阵可在本线程析构，线程退出时缓存交还系统
+void test_pool_threads()
+{
+  pool_release();
+  vector<Matrix> matrices;
+  thread t([&] {
+    for(int i = 0; i < 100; ++i)
+      matrices.emplace_back(3, 3);
+    Matrix(4, 4);
+    assert(pool_stats().cached_blocks == 1);
+  });
+  t.join();
+  matrices.clear();
+  assert(pool_stats().cached_blocks == 100);
+  Matrix A(3, 3);
+  assert(pool_stats().cached_blocks == 99);
+  pool_release();
+  TEST_PASSED;
+}
+
+class CountingAllocator : public Allocator {
+public:
+  size_t live = 0;
+
+  void *allocate(size_t size) override
+  {
+    ++live;
+    return malloc_allocator().allocate(size);
+  }
+
+  void deallocate(void *p, size_t size) noexcept override
+  {
+    --live;
+    malloc_allocator().deallocate(p, size);
+  }
+};
+
+// 数据区交还分配它的分配器
+void test_set_allocator()
+{
+  assert(&get_allocator() == &pool_allocator());
+  CountingAllocator counting;
+  Matrix A(3, 3);
+  set_allocator(counting);
+  assert(&get_allocator() == &counting);
+  {
+    Matrix B(3, 3), C = B;
+    assert(counting.live == 1);
+    set_allocator(pool_allocator());
+    Matrix D(3, 3);
+    assert(counting.live == 1);
+  }
+  assert(counting.live == 0);
+  TEST_PASSED;
+}
+
+void test_pool_repeat()
+{
+  for(size_t n : {3, 40, 100})
+  for(Allocator *alloc : {&malloc_allocator(), &pool_allocator()})
+  {
+    set_allocator(*alloc);
+    Matrix A(n, n);
+    A.fill(1);
+    clock_t start = clock();
+    for(int t = 0; t < 100000; ++t)
+    {
+      Matrix B = A * 2 + A;
+      Matrix C(n, 1);
+    }
+    clock_t diff = clock() - start;
+    cout << "It took " << (double)diff / CLOCKS_PER_SEC
+         << " s to create 200000 temporaries around " << n << "x" << n << " with "
+         << (alloc == &malloc_allocator() ? "malloc." : "pool.") << endl;
+  }
+  set_allocator(pool_allocator());
+  TEST_PASSED;
+}
@@ -0,0 +1,169 @@
+#include "Band.h"
+#include "Kernel.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+BandMatrix::BandMatrix(size_t n, size_t kl, size_t ku)
+  : lower(kl), upper(ku), ab(n, kl + ku + 1)
+{
+  ab.fill(0);
+}
+
+BandMatrix::BandMatrix(const Matrix &A, size_t kl, size_t ku)
+  : BandMatrix(A.nr(), kl, ku)
+{
+  if(!A.square())
+    throw std::domain_error("band matrix must be square");
+  const ElementKernels &ek = element_kernels();
+  for(size_t i = 0; i < n(); ++i)
+  {
+    size_t j0 = i > kl ? i - kl : 0, j1 = std::min(n(), i + ku + 1);
+    ek.assign(j1 - j0, &(*this)(i, j0), 1, &A(i, j0), A.sc());
+  }
+}
+
+Matrix BandMatrix::dense() const
+{
+  Matrix A(n(), n());
+  A.fill(0);
+  const ElementKernels &ek = element_kernels();
+  for(size_t i = 0; i < n(); ++i)
+  {
+    size_t j0 = i > lower ? i - lower : 0, j1 = std::min(n(), i + upper + 1);
+    ek.assign(j1 - j0, &A(i, j0), 1, &(*this)(i, j0), 1);
+  }
+  return A;
+}
+
+Matrix operator*(const BandMatrix &A, const Matrix &X)
+{
+  if(A.n() != X.nr())
+    throw std::domain_error("inconsistent shapes");
+  size_t n = A.n();
+  Matrix Y(n, X.nc());
+  Y.fill(0);
+  const ElementKernels &ek = element_kernels();
+  for(size_t i = 0; i < n; ++i)
+  {
+    size_t j0 = i > A.kl() ? i - A.kl() : 0, j1 = std::min(n, i + A.ku() + 1);
+    for(size_t j = j0; j < j1; ++j)
+      ek.axpy(X.nc(), &Y(i, 0), Y.sc(), &X(j, 0), X.sc(), A(i, j));
+  }
+  return Y;
+}
+
+void solve_tridiagonal(const BandMatrix &T, const Matrix &B)
+{
+  if(T.kl() != 1 || T.ku() != 1)
+    throw std::invalid_argument("not a tridiagonal matrix");
+  size_t n = T.n(), m = B.nc();
+  if(B.nr() != n)
+    throw std::domain_error("inconsistent shapes");
+  if(B.empty())
+    return;
+
+  // 消元后的上对角元 c_i = du_i / p_i，p_i 为主元
+  std::vector<Number> c(n);
+  for(size_t i = 0; i < n; ++i)
+  {
+    Number l = i ? T(i, i - 1) : 0;
+    Number p = T(i, i) - (i ? l * c[i - 1] : 0);
+    if(p == 0)
+      throw i;
+    Number r = 1 / p;
+    c[i] = i + 1 < n ? T(i, i + 1) * r : 0;
+    for(size_t k = 0; k < m; ++k)
+      B(i, k) = (B(i, k) - (i ? l * B(i - 1, k) : 0)) * r;
+  }
+  for(size_t i = n - 1; i-- > 0; )
+    for(size_t k = 0; k < m; ++k)
+      B(i, k) -= c[i] * B(i + 1, k);
+}
+
+BandLU::BandLU(const BandMatrix &A)
+  : lower(A.kl()), upper(A.kl() + A.ku()), lu(A.n(), 2 * A.kl() + A.ku() + 1), piv(A.n()),
+    singular(A.n())
+{
+  lu.fill(0);
+  Matrix head = lu.col_slice(0, A.kl() + A.ku() + 1);
+  head = A.band();
+  factor();
+}
+
+// 第 k 步在 [k, k + kl] 行中选主元，交换后消去其下 kl 行
+// 换上来的行最远延伸到 k + kl + ku 列，恰好落在加宽的存储内
+void BandLU::factor()
+{
+  size_t n = this->n();
+  for(size_t k = 0; k < n; ++k)
+  {
+    size_t i1 = std::min(n, k + lower + 1), j1 = std::min(n, k + upper + 1);
+    size_t p = k;
+    for(size_t i = k + 1; i < i1; ++i)
+      if(std::abs(at(i, k)) > std::abs(at(p, k)))
+        p = i;
+    piv[k] = p;
+    // 两行的存储偏移不同，逐列交换
+    if(p != k)
+      for(size_t j = k; j < j1; ++j)
+        std::swap(at(k, j), at(p, j));
+
+    Number d = at(k, k);
+    if(d == 0)
+    {
+      if(singular == n)
+        singular = k;
+      continue;
+    }
+    for(size_t i = k + 1; i < i1; ++i)
+    {
+      Number l = at(i, k) /= d;
+      if(l != 0)
+      {
+        Number *a = &at(i, k + 1);
+        const Number *u = &at(k, k + 1);
+        for(size_t j = 0; j < j1 - k - 1; ++j)
+          a[j] -= l * u[j];
+      }
+    }
+  }
+}
+
+void BandLU::solve(const Matrix &B) const
+{
+  size_t n = this->n(), m = B.nc();
+  if(B.nr() != n)
+    throw std::invalid_argument("inconsistent A and B");
+  if(!invertible())
+    throw singular;
+
+  if(B.empty())
+    return;
+
+  // 逐行处理，B 的各列在内层
+  for(size_t k = 0; k < n; ++k)
+  {
+    if(piv[k] != k)
+      for(size_t c = 0; c < m; ++c)
+        std::swap(B(k, c), B(piv[k], c));
+    for(size_t i = k + 1; i < std::min(n, k + lower + 1); ++i)
+    {
+      Number l = at(i, k);
+      for(size_t c = 0; c < m; ++c)
+        B(i, c) -= l * B(k, c);
+    }
+  }
+  for(size_t i = n; i-- > 0; )
+  {
+    for(size_t j = i + 1; j < std::min(n, i + upper + 1); ++j)
+    {
+      Number u = at(i, j);
+      for(size_t c = 0; c < m; ++c)
+        B(i, c) -= u * B(j, c);
+    }
+    Number r = 1 / at(i, i);
+    for(size_t c = 0; c < m; ++c)
+      B(i, c) *= r;
+  }
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Basic.h"
+#include "Matrix.h"
+#include <vector>
+
+// n 阶带状矩阵，kl 条下对角线、ku 条上对角线
+// 紧凑存储为 n 行 kl + ku + 1 列的矩阵，A(i, j) 存于第 i 行第 j - i + kl 列，
+// 同一行的带内元素在内存中连续；带外超出矩阵边界的存储位置不使用
+class BandMatrix {
+private:
+  size_t  lower;  // 下带宽 kl
+  size_t  upper;  // 上带宽 ku
+  Matrix  ab;     // 紧凑存储
+
+public:
+  // 零矩阵
+  BandMatrix(size_t n, size_t kl, size_t ku);
+
+  // 取稠密方阵（可以是视图）带内的元素，忽略带外元素；A 非方阵时抛 domain_error
+  BandMatrix(const Matrix &A, size_t kl, size_t ku);
+
+  size_t n() const { return ab.nr(); }
+  size_t kl() const { return lower; }
+  size_t ku() const { return upper; }
+
+  // 紧凑存储
+  const Matrix &band() const { return ab; }
+
+  // (i, j) 是否在带内
+  bool in_band(size_t i, size_t j) const { return j + lower >= i && j <= i + upper; }
+
+  // 带内矩阵元，不检查 (i, j) 是否在带内
+  Number &operator()(size_t i, size_t j) const { return ab(i, j + lower - i); }
+
+  // 稠密副本
+  Matrix dense() const;
+};
+
+// 带状矩阵与稠密矩阵之积；形状不一致时抛 domain_error
+Matrix operator*(const BandMatrix &A, const Matrix &X);
+
+// 追赶法（Thomas 算法）求解三对角方程组 T X = B，结果写回 B，B 可有任意列
+// 不选主元，适用于对角占优或对称正定的 T
+// T 不是三对角（kl、ku 不为 1）时抛 invalid_argument，B 行数与 T 不等时抛 domain_error
+// 主元为零时抛 size_t 所在行
+void solve_tridiagonal(const BandMatrix &T, const Matrix &B);
+
+// 列主元带状 LU 分解 P A = L U，U 的上带宽增至 kl + ku
+// 分解结果可反复用于求解不同右端项，时间与 n (kl + ku) kl 成正比
+class BandLU {
+private:
+  size_t               lower;     // 下带宽 kl
+  size_t               upper;     // U 的上带宽 kl + ku
+  Matrix               lu;        // n 行 2 kl + ku + 1 列，(i, j) 存于第 i 行第 j - i + kl 列
+  std::vector<size_t>  piv;       // 第 k 步与第 piv[k] 行交换
+  size_t               singular;  // 首个零主元所在行，非奇异时为 n
+
+  Number &at(size_t i, size_t j) const { return lu(i, j + lower - i); }
+  void factor();
+
+public:
+  // 分解 A 的副本；A 奇异时分解照常完成，求解时抛错
+  explicit BandLU(const BandMatrix &A);
+
+  size_t n() const { return lu.nr(); }
+  bool invertible() const { return singular == n(); }
+
+  // 求解 A X = B，结果写回 B，B 可有任意列
+  // B 行数与 A 不等时抛 invalid_argument
+  // A 奇异时抛 size_t 首个零主元所在行
+  void solve(const Matrix &B) const;
+};
@@ -0,0 +1,353 @@
+#include "TestBasic.h"
+#include "TestMatrix.h"
+#include "Band.h"
+#include "BatchSolve.h"
+#include "LU.h"
+#include <random>
+#include <ctime>
+#include <cmath>
+
+using namespace std;
+
+void test_band_matrix();
+void test_tridiagonal();
+void test_band_lu();
+void test_band_errors();
+void test_tridiagonal_batch();
+void test_band_repeat();
+
+int main()
+{
+  seed_engine();
+  test_band_matrix();
+  test_tridiagonal();
+  test_band_lu();
+  test_band_errors();
+  test_tridiagonal_batch();
+  test_band_repeat();
+}
+
+// 带内随机的带状矩阵，shift 加在对角线上
+static BandMatrix random_band(size_t n, size_t kl, size_t ku, Number shift)
+{
+  Matrix A = random(n, n);
+  BandMatrix B(A, kl, ku);
+  for(size_t i = 0; i < n; ++i)
+    B(i, i) += shift;
+  return B;
+}
+
+void test_band_matrix()
+{
+  size_t n = 9, kl = 2, ku = 3;
+  Matrix A = random(n, n);
+  BandMatrix B(A, kl, ku);
+  assert(B.n() == n && B.kl() == kl && B.ku() == ku);
+  assert(B.band().nr() == n && B.band().nc() == kl + ku + 1);
+  Matrix D = B.dense();
+  for(size_t i = 0; i < n; ++i)
+    for(size_t j = 0; j < n; ++j)
+    {
+      assert(B.in_band(i, j) == (j + kl >= i && j <= i + ku));
+      assert(D(i, j) == (B.in_band(i, j) ? A(i, j) : 0));
+      if(B.in_band(i, j))
+        assert(B(i, j) == A(i, j));
+    }
+
+  // 稠密转置视图
+  BandMatrix Bt(A.t(), ku, kl);
+  for(size_t i = 0; i < n; ++i)
+    for(size_t j = 0; j < n; ++j)
+      if(Bt.in_band(i, j))
+        assert(Bt(i, j) == A(j, i));
+
+  // 与稠密矩阵之积
+  Matrix X = random(n, 4);
+  assert(max_abs(B * X - D * X) < 1e-14);
+  assert(max_abs(B * X.t().copy().t() - D * X) < 1e-14);
+
+  BandMatrix Z(5, 1, 0);
+  assert(max_abs(Z.dense()) == 0);
+  TEST_PASSED;
+}
+
+void test_tridiagonal()
+{
+  for(size_t n : {1, 2, 3, 50})
+  for(size_t m : {1, 5})
+  {
+    BandMatrix T = random_band(n, 1, 1, 3);
+    Matrix B = random(n, m), X = B.copy();
+    solve_tridiagonal(T, X);
+    assert(max_abs(T * X - B) < 1e-13);
+
+    // 右端项为转置视图
+    Matrix Xt = B.t().copy();
+    solve_tridiagonal(T, Xt.t());
+    assert(max_abs(Xt.t() - X) < 1e-15);
+  }
+
+  // 一维 Poisson 方程 -u'' = 1，u(0) = u(1) = 0，差分解在格点上精确
+  size_t n = 999;
+  Number h = 1.0 / (n + 1);
+  BandMatrix T(n, 1, 1);
+  Matrix u(n, 1);
+  for(size_t i = 0; i < n; ++i)
+  {
+    T(i, i) = 2;
+    if(i)
+      T(i, i - 1) = -1;
+    if(i + 1 < n)
+      T(i, i + 1) = -1;
+    u(i, 0) = h * h;
+  }
+  solve_tridiagonal(T, u);
+  for(size_t i = 0; i < n; ++i)
+  {
+    Number x = (i + 1) * h;
+    assert(abs(u(i, 0) - x * (1 - x) / 2) < 1e-12);
+  }
+  TEST_PASSED;
+}
+
+void test_band_lu()
+{
+  for(size_t n : {1, 2, 7, 100})
+  for(auto bw : { make_pair(0, 0), make_pair(1, 1), make_pair(2, 0), make_pair(0, 3),
+                  make_pair(3, 2), make_pair(6, 6) })
+  {
+    // 对角线不加强，需要选主元
+    BandMatrix A = random_band(n, bw.first, bw.second, 0);
+    Matrix B = random(n, 3), X = B.copy();
+    BandLU lu(A);
+    assert(lu.n() == n && lu.invertible());
+    lu.solve(X);
+    Matrix Y = B.copy();
+    LU(A.dense()).solve(Y);
+    assert(max_abs(X - Y) < 1e-8 * max(Number(1), max_abs(Y)));
+    assert(max_abs(A * X - B) < 1e-9 * max(Number(1), max_abs(X)));
+  }
+
+  // 首个主元为零，选主元后照常求解
+  double in[3][3] = {
+    0, 1, 0,
+    2, 1, 1,
+    0, 3, 1,
+  };
+  BandMatrix A(Matrix(3, 3, in), 1, 1);
+  Matrix b(3, 1);
+  b(0, 0) = 1, b(1, 0) = 4, b(2, 0) = 4;
+  BandLU(A).solve(b);
+  assert(abs(b(0, 0) - 1) < 1e-15 && abs(b(1, 0) - 1) < 1e-15 && abs(b(2, 0) - 1) < 1e-15);
+  TEST_PASSED;
+}
+
+void test_band_errors()
+{
+  ASSERT_EXCEPTION(domain_error, BandMatrix(Matrix(3, 4), 1, 1);)
+  ASSERT_EXCEPTION(domain_error, BandMatrix(3, 1, 1) * Matrix(4, 1);)
+  ASSERT_EXCEPTION(invalid_argument, solve_tridiagonal(BandMatrix(3, 2, 1), Matrix(3, 1));)
+  ASSERT_EXCEPTION(domain_error, solve_tridiagonal(BandMatrix(3, 1, 1), Matrix(2, 1));)
+  ASSERT_EXCEPTION(invalid_argument, BandLU(BandMatrix(3, 1, 1)).solve(Matrix(2, 1));)
+  solve_tridiagonal(BandMatrix(0, 1, 1), Matrix(0, 2));
+  BandLU(BandMatrix(0, 2, 2)).solve(Matrix(0, 2));
+
+  // 追赶法不选主元，第 2 行主元为零
+  BandMatrix T = random_band(6, 1, 1, 3);
+  T(2, 1) = T(2, 2) = T(2, 3) = 0;
+  try
+  {
+    solve_tridiagonal(T, random(6, 1));
+    assert(false);
+  }
+  catch(size_t i)
+  {
+    assert(i == 2);
+  }
+
+  // 第 4 列全为零
+  BandMatrix A = random_band(8, 2, 1, 3);
+  for(size_t i = 2; i < 7; ++i)
+    A(i, 4) = 0;
+  BandLU lu(A);
+  assert(!lu.invertible());
+  try
+  {
+    lu.solve(random(8, 1));
+    assert(false);
+  }
+  catch(size_t i)
+  {
+    assert(i == 4);
+  }
+  TEST_PASSED;
+}
+
+// 各方程组的三对角系数按 solve_tridiagonal_batch 的布局存放
+template<class T>
+static void fill_tridiagonal(size_t n, const BasicMatrix<T> &T3, const BasicMatrix<T> &B)
+{
+  uniform_real_distribution<double> urd(-1, 1);
+  for(size_t s = 0; s < T3.nc(); ++s)
+  {
+    for(size_t e = 0; e < 3 * n; ++e)
+      T3(e, s) = urd(engine) + (e % 3 == 1 ? 3 : 0);
+    for(size_t e = 0; e < B.nr(); ++e)
+      B(e, s) = urd(engine);
+  }
+}
+
+// 逐个方程组与 solve_tridiagonal 比较
+static void check_tridiagonal(size_t n, const Matrix &T3, const Matrix &B0, const Matrix &X)
+{
+  size_t m = B0.nr() / n;
+  for(size_t s = 0; s < T3.nc(); ++s)
+  {
+    BandMatrix T(n, 1, 1);
+    Matrix b(n, m);
+    for(size_t i = 0; i < n; ++i)
+    {
+      if(i)
+        T(i, i - 1) = T3(3 * i, s);
+      T(i, i) = T3(3 * i + 1, s);
+      if(i + 1 < n)
+        T(i, i + 1) = T3(3 * i + 2, s);
+      for(size_t c = 0; c < m; ++c)
+        b(i, c) = B0(i * m + c, s);
+    }
+    solve_tridiagonal(T, b);
+    for(size_t i = 0; i < n; ++i)
+      for(size_t c = 0; c < m; ++c)
+        assert(abs(b(i, c) - X(i * m + c, s)) < 1e-13);
+  }
+}
+
+void test_tridiagonal_batch()
+{
+  for(size_t n : {1, 2, 5, 40})
+  for(size_t m : {1, 3})
+  for(size_t count : {1, 7, 17, 2500})
+  {
+    Matrix T3(3 * n, count), B(n * m, count);
+    fill_tridiagonal(n, T3, B);
+    Matrix T0 = T3.copy(), B0 = B.copy();
+    assert(solve_tridiagonal_batch(T3, B) == 0);
+    assert(T3 == T0);
+    check_tridiagonal(n, T3, B0, B);
+
+    BasicMatrix<float> Tf(3 * n, count), Bf(n * m, count);
+    for(size_t e = 0; e < 3 * n; ++e)
+      for(size_t s = 0; s < count; ++s)
+        Tf(e, s) = T3(e, s);
+    for(size_t e = 0; e < n * m; ++e)
+      for(size_t s = 0; s < count; ++s)
+        Bf(e, s) = B0(e, s);
+    assert(solve_tridiagonal_batch(Tf, Bf) == 0);
+    for(size_t e = 0; e < n * m; ++e)
+      for(size_t s = 0; s < count; ++s)
+        assert(abs(Bf(e, s) - B(e, s)) < 1e-4);
+  }
+
+  // 每行一个方程组的布局经转置视图传入
+  size_t n = 6, m = 2, count = 301;
+  Matrix Tt(count, 3 * n), Bt(count, n * m);
+  fill_tridiagonal(n, Tt.t(), Bt.t());
+  Matrix T0 = Tt.t().copy(), B0 = Bt.t().copy();
+  assert(solve_tridiagonal_batch(Tt.t(), Bt.t()) == 0);
+  check_tridiagonal(n, T0, B0, Bt.t());
+
+  // 奇异方程组
+  Matrix T3(3 * n, 20), B(n, 20);
+  fill_tridiagonal(n, T3, B);
+  for(size_t s : {3, 11})
+    T3(3 * 2 + 1, s) = T3(3 * 2, s) = T3(3 * 2 + 2, s) = 0;
+  assert(solve_tridiagonal_batch(T3, B) == 2);
+  for(size_t s = 0; s < 20; ++s)
+    assert(isfinite(B(0, s)) == (s != 3 && s != 11));
+
+  ASSERT_EXCEPTION(domain_error, solve_tridiagonal_batch(Matrix(8, 3), Matrix(3, 3));)
+  ASSERT_EXCEPTION(domain_error, solve_tridiagonal_batch(Matrix(9, 3), Matrix(4, 3));)
+  ASSERT_EXCEPTION(domain_error, solve_tridiagonal_batch(Matrix(9, 3), Matrix(3, 2));)
+  TEST_PASSED;
+}
+
+void test_band_repeat()
+{
+  // 10^6 阶五对角
+  size_t n = 1000000;
+  BandMatrix A(n, 2, 2);
+  uniform_real_distribution<Number> urd(-1, 1);
+  for(size_t i = 0; i < n; ++i)
+    for(size_t j = i > 2 ? i - 2 : 0; j < min(n, i + 3); ++j)
+      A(i, j) = i == j ? 2 + urd(engine) : urd(engine);
+  Matrix b = random(n, 1), x = b.copy();
+  clock_t start = clock();
+  BandLU lu(A);
+  lu.solve(x);
+  double band = (double)(clock() - start) / CLOCKS_PER_SEC;
+  cout << "It took " << band << " s to factorize and solve a " << n
+       << "x" << n << " pentadiagonal system with BandLU." << endl;
+  assert(max_abs(A * x - b) < 1e-8 * max(Number(1), max_abs(x)));
+
+  BandMatrix T(n, 1, 1);
+  for(size_t i = 0; i < n; ++i)
+    for(size_t j = i ? i - 1 : 0; j < min(n, i + 2); ++j)
+      T(i, j) = i == j ? 3 + urd(engine) : urd(engine);
+  x = b.copy();
+  start = clock();
+  solve_tridiagonal(T, x);
+  double thomas = (double)(clock() - start) / CLOCKS_PER_SEC;
+  cout << "It took " << thomas << " s to solve a tridiagonal one with the Thomas algorithm." << endl;
+  assert(max_abs(T * x - b) < 1e-12);
+
+  // 同样规模的稠密 LU 按 n^3 外推
+  size_t nd = 500;
+  BandMatrix Ad(nd, 2, 2);
+  for(size_t i = 0; i < nd; ++i)
+    for(size_t j = i > 2 ? i - 2 : 0; j < min(nd, i + 3); ++j)
+      Ad(i, j) = i == j ? 4 : urd(engine);
+  start = clock();
+  LU dense(Ad.dense());
+  double lu500 = (double)(clock() - start) / CLOCKS_PER_SEC;
+  start = clock();
+  BandLU(Ad).solve(random(nd, 1));
+  double band500 = (double)(clock() - start) / CLOCKS_PER_SEC;
+  cout << "At order " << nd << ", dense LU took " << lu500 << " s and BandLU "
+       << band500 << " s (" << lu500 / band500 << "x)." << endl;
+
+  // 2^16 个 64 阶三对角方程组
+  size_t order = 64, count = 1 << 16;
+  Matrix T3(3 * order, count), B(order, count);
+  fill_tridiagonal(order, T3, B);
+  Matrix B0 = B.copy();
+  start = clock();
+  solve_tridiagonal_batch(T3, B);
+  double batched = (double)(clock() - start) / CLOCKS_PER_SEC;
+  cout << "It took " << batched << " s to solve " << count << " tridiagonal systems of order "
+       << order << " in a batch (" << count / batched / 1e6 << " M/s)." << endl;
+
+  start = clock();
+  BandMatrix Ts(order, 1, 1);
+  Matrix bs(order, 1);
+  for(size_t s = 0; s < count; ++s)
+  {
+    for(size_t i = 0; i < order; ++i)
+    {
+      if(i)
+        Ts(i, i - 1) = T3(3 * i, s);
+      Ts(i, i) = T3(3 * i + 1, s);
+      if(i + 1 < order)
+        Ts(i, i + 1) = T3(3 * i + 2, s);
+      bs(i, 0) = B0(i, s);
+    }
+    solve_tridiagonal(Ts, bs);
+  }
+  double single = (double)(clock() - start) / CLOCKS_PER_SEC;
+  cout << "It took " << single << " s to solve them one by one (" << single / batched << "x)." << endl;
+
+  B = B0;
+  double wall = threaded_seconds(4, [&] { solve_tridiagonal_batch(T3, B); });
+  cout << "It took " << wall << " s with 4 threads." << endl;
+  check_tridiagonal(order, T3.col_slice(0, 100), B0.col_slice(0, 100), B.col_slice(0, 100));
+  TEST_PASSED;
+}
@@ -3,3 +3,11 @@
 #include <cstddef>
 
 #define Number double
+
+// 矩阵元类型为 T 的矩阵，库内显式实例化 float、double、long double 和 std::complex<double>
+template<class T> class BasicMatrix;
+typedef BasicMatrix<Number> Matrix;
+
+// 数量参数不参与模板推导，整数等可隐式转换为矩阵元类型
+template<class T> struct ScalarOf { typedef T type; };
+template<class T> using scalar_t = typename ScalarOf<T>::type;
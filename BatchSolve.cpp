@@ -0,0 +1,240 @@
+#include "BatchSolve.h"
+#include "Matrix.h"
+#include "ThreadPool.h"
+#include "Cpu.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+// 每组并行的方程组数取一个向量寄存器的元素数
+// generic 取 16 字节，不支持向量的目标上由编译器降级为标量代码
+namespace generic {
+
+namespace f64 {
+typedef double E;
+constexpr size_t W = 2;
+#include "BatchSolve.inl"
+}  // namespace f64
+
+namespace f32 {
+typedef float E;
+constexpr size_t W = 4;
+#include "BatchSolve.inl"
+}  // namespace f32
+
+}  // namespace generic
+
+#if defined(__x86_64__)
+
+#pragma GCC push_options
+#pragma GCC target("sse2")
+
+namespace sse2 {
+
+namespace f64 {
+typedef double E;
+constexpr size_t W = 2;
+#include "BatchSolve.inl"
+}  // namespace f64
+
+namespace f32 {
+typedef float E;
+constexpr size_t W = 4;
+#include "BatchSolve.inl"
+}  // namespace f32
+
+}  // namespace sse2
+
+#pragma GCC pop_options
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+
+namespace avx2 {
+
+namespace f64 {
+typedef double E;
+constexpr size_t W = 4;
+#include "BatchSolve.inl"
+}  // namespace f64
+
+namespace f32 {
+typedef float E;
+constexpr size_t W = 8;
+#include "BatchSolve.inl"
+}  // namespace f32
+
+}  // namespace avx2
+
+#pragma GCC pop_options
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+
+namespace avx512 {
+
+namespace f64 {
+typedef double E;
+constexpr size_t W = 8;
+#include "BatchSolve.inl"
+}  // namespace f64
+
+namespace f32 {
+typedef float E;
+constexpr size_t W = 16;
+#include "BatchSolve.inl"
+}  // namespace f32
+
+}  // namespace avx512
+
+#pragma GCC pop_options
+
+#endif  // __x86_64__
+
+namespace {
+
+template<class T>
+using SolveRange = size_t (*)(size_t n, size_t m, const T *A, size_t sa, size_t ca,
+    T *B, size_t sb, size_t cb, size_t count);
+
+template<class T> SolveRange<T> select(Isa);
+
+template<> SolveRange<double> select(Isa isa)
+{
+#if defined(__x86_64__)
+  switch(isa)
+  {
+  case Isa::avx512:
+    return avx512::f64::solve_range;
+  case Isa::avx2:
+    return avx2::f64::solve_range;
+  case Isa::sse2:
+    return sse2::f64::solve_range;
+  default:
+    break;
+  }
+#endif
+  return generic::f64::solve_range;
+}
+
+template<> SolveRange<float> select(Isa isa)
+{
+#if defined(__x86_64__)
+  switch(isa)
+  {
+  case Isa::avx512:
+    return avx512::f32::solve_range;
+  case Isa::avx2:
+    return avx2::f32::solve_range;
+  case Isa::sse2:
+    return sse2::f32::solve_range;
+  default:
+    break;
+  }
+#endif
+  return generic::f32::solve_range;
+}
+
+template<class T>
+using TridiagonalRange = size_t (*)(size_t n, size_t m, const T *dl, const T *d, const T *du,
+    size_t st, size_t ct, T *B, size_t sb, size_t cb, size_t count);
+
+template<class T> TridiagonalRange<T> select_tridiagonal(Isa);
+
+template<> TridiagonalRange<double> select_tridiagonal(Isa isa)
+{
+#if defined(__x86_64__)
+  switch(isa)
+  {
+  case Isa::avx512:
+    return avx512::f64::tridiagonal_range;
+  case Isa::avx2:
+    return avx2::f64::tridiagonal_range;
+  case Isa::sse2:
+    return sse2::f64::tridiagonal_range;
+  default:
+    break;
+  }
+#endif
+  return generic::f64::tridiagonal_range;
+}
+
+template<> TridiagonalRange<float> select_tridiagonal(Isa isa)
+{
+#if defined(__x86_64__)
+  switch(isa)
+  {
+  case Isa::avx512:
+    return avx512::f32::tridiagonal_range;
+  case Isa::avx2:
+    return avx2::f32::tridiagonal_range;
+  case Isa::sse2:
+    return sse2::f32::tridiagonal_range;
+  default:
+    break;
+  }
+#endif
+  return generic::f32::tridiagonal_range;
+}
+
+// 每个并行任务的方程组数，为各指令集每组方程组数的公倍数
+constexpr size_t batch_task = 1024;
+
+}  // namespace
+
+template<class T>
+size_t solve_batch(size_t n, const BasicMatrix<T> &A, const BasicMatrix<T> &B)
+{
+  if(n == 0 || n > batch_max_order)
+    throw std::invalid_argument("batch order out of range");
+  size_t count = A.nc();
+  if(A.nr() != n * n || B.nc() != count || B.nr() % n)
+    throw std::domain_error("inconsistent shapes");
+  size_t m = B.nr() / n;
+  if(!count || !m)
+    return 0;
+
+  static const SolveRange<T> solve_range = select<T>(cpu_isa());
+  size_t tasks = (count + batch_task - 1) / batch_task;
+  if(tasks == 1)
+    return solve_range(n, m, A.ptr(), A.sr(), A.sc(), B.ptr(), B.sr(), B.sc(), count);
+  std::atomic<size_t> singular{0};
+  parallel_for(tasks, [&](size_t t) {
+    size_t s = t * batch_task, cnt = std::min(batch_task, count - s);
+    singular += solve_range(n, m, A.ptr() + s * A.sc(), A.sr(), A.sc(),
+        B.ptr() + s * B.sc(), B.sr(), B.sc(), cnt);
+  });
+  return singular;
+}
+
+template size_t solve_batch(size_t, const BasicMatrix<float> &, const BasicMatrix<float> &);
+template size_t solve_batch(size_t, const BasicMatrix<double> &, const BasicMatrix<double> &);
+
+template<class T>
+size_t solve_tridiagonal_batch(const BasicMatrix<T> &T3, const BasicMatrix<T> &B)
+{
+  size_t n = T3.nr() / 3, count = T3.nc();
+  if(T3.nr() % 3 || B.nc() != count || (n ? B.nr() % n : B.nr()))
+    throw std::domain_error("inconsistent shapes");
+  size_t m = n ? B.nr() / n : 0;
+  if(!count || !m)
+    return 0;
+
+  static const TridiagonalRange<T> tridiagonal_range = select_tridiagonal<T>(cpu_isa());
+  const T *dl = T3.ptr(), *d = dl + T3.sr(), *du = d + T3.sr();
+  size_t st = 3 * T3.sr(), ct = T3.sc();
+  size_t tasks = (count + batch_task - 1) / batch_task;
+  if(tasks == 1)
+    return tridiagonal_range(n, m, dl, d, du, st, ct, B.ptr(), B.sr(), B.sc(), count);
+  std::atomic<size_t> singular{0};
+  parallel_for(tasks, [&](size_t t) {
+    size_t s = t * batch_task, cnt = std::min(batch_task, count - s);
+    singular += tridiagonal_range(n, m, dl + s * ct, d + s * ct, du + s * ct, st, ct,
+        B.ptr() + s * B.sc(), B.sr(), B.sc(), cnt);
+  });
+  return singular;
+}
+
+template size_t solve_tridiagonal_batch(const BasicMatrix<float> &, const BasicMatrix<float> &);
+template size_t solve_tridiagonal_batch(const BasicMatrix<double> &, const BasicMatrix<double> &);
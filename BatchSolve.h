@@ -0,0 +1,30 @@
+#pragma once
+
+#include "Basic.h"
+
+// 批量求解的最大阶数，更大的方程组应逐个使用 LU
+constexpr size_t batch_max_order = 8;
+
+// 批量求解 count 个互相独立的 n 阶线性方程组 A_s X_s = B_s，s 取 [0, count)
+// 采用结构数组布局，每列对应一个方程组，相邻方程组的同一矩阵元在内存中相邻：
+//   A 为 n*n 行 count 列，第 i*n+j 行存放各方程组的 A_s(i, j)
+//   B 为 n*m 行 count 列，第 i*m+k 行存放各方程组的 B_s(i, k)，m 为右端项个数
+// 解写回 B，A 不变；不分配内存
+// 沿方程组方向向量化，各方程组独立选列主元；方程组足够多时分给线程池并行
+// 奇异方程组的解含 inf 或 NaN，退回奇异方程组的个数
+// n 为 0 或超过 batch_max_order 时抛 invalid_argument，A、B 形状不符时抛 domain_error
+// 库内为 float 和 double 显式实例化
+template<class T>
+size_t solve_batch(size_t n, const BasicMatrix<T> &A, const BasicMatrix<T> &B);
+
+// 批量求解 count 个互相独立的 n 阶三对角方程组 T_s X_s = B_s，布局同 solve_batch：
+//   T 为 3n 行 count 列，第 3i、3i+1、3i+2 行依次存放各方程组第 i 行的下、主、上对角元，
+//   T_s(0, -1) 与 T_s(n-1, n) 所在的第 0 行和第 3n-1 行不使用
+//   B 为 n*m 行 count 列，第 i*m+k 行存放各方程组的 B_s(i, k)
+// 解写回 B，T 不变；各方程组以追赶法求解，不选主元，适用于对角占优或对称正定的方程组
+// 沿方程组方向向量化，方程组足够多时分给线程池并行，每个任务分配 O(n) 的工作区
+// 奇异（遇到零主元）方程组的解含 inf 或 NaN，退回奇异方程组的个数
+// T、B 形状不符时抛 domain_error
+// 库内为 float 和 double 显式实例化
+template<class T>
+size_t solve_tridiagonal_batch(const BasicMatrix<T> &T3, const BasicMatrix<T> &B);
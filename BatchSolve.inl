@@ -0,0 +1,215 @@
+// 批量求解的公共实现，由 BatchSolve.cpp 在各指令集的 target 设置下分别包含
+// 包含前须在当前命名空间定义：
+//   E  元素类型
+//   W  每组并行求解的方程组数
+// 每个矩阵元的 W 个车道用一个 GCC 向量扩展类型表示，编译器按当前指令集拆分为向量寄存器
+// 选主元时各车道的比较和行交换均以条件选择实现，没有分支
+
+typedef E Vec __attribute__((vector_size(W * sizeof(E))));
+typedef decltype(Vec{ } < Vec{ }) Mask;
+
+static Vec load_lanes(const E *p, size_t s, size_t cnt, E pad)
+{
+  Vec v;
+  if(s == 1 && cnt == W)
+    memcpy(&v, p, sizeof v);
+  else for(size_t l = 0; l < W; ++l)
+    v[l] = l < cnt ? p[l * s] : pad;
+  return v;
+}
+
+static void store_lanes(E *p, size_t s, size_t cnt, Vec v)
+{
+  if(s == 1 && cnt == W)
+    memcpy(p, &v, sizeof v);
+  else for(size_t l = 0; l < cnt; ++l)
+    p[l * s] = v[l];
+}
+
+// 求解 cnt（不超过 W）个 N 阶方程组
+// A 第 e 行第 l 个元素为方程组 l 按行展开的第 e 个系数，行跳步 sa、列跳步 ca
+// B 第 i*m+c 行为各方程组右端项的 (i, c) 元，结果写回 B
+// 末组不足 W 个方程组时以单位矩阵补齐；退回奇异方程组的个数
+template<size_t N>
+size_t solve_lanes(size_t m, const E *A, size_t sa, size_t ca,
+    E *B, size_t sb, size_t cb, size_t cnt)
+{
+  Vec a[N * N], p[N], x[N];
+  const Vec zero = { };
+  Mask singular = { };
+
+  for(size_t e = 0; e < N * N; ++e)
+    a[e] = load_lanes(A + e * sa, ca, cnt, e % (N + 1) == 0);
+
+#pragma GCC unroll 8
+  for(size_t k = 0; k < N; ++k)
+  {
+    // 各车道独立选取第 k 列绝对值最大者，相等时取靠前的行
+    Vec mx = a[k * N + k] < zero ? -a[k * N + k] : a[k * N + k];
+    p[k] = zero + E(k);
+#pragma GCC unroll 8
+    for(size_t r = k + 1; r < N; ++r)
+    {
+      Vec v = a[r * N + k] < zero ? -a[r * N + k] : a[r * N + k];
+      Mask g = v > mx;
+      mx = g ? v : mx;
+      p[k] = g ? zero + E(r) : p[k];
+    }
+
+    // 整行交换，含已存入的 L 部分
+#pragma GCC unroll 8
+    for(size_t r = k + 1; r < N; ++r)
+    {
+      Mask s = p[k] == E(r);
+#pragma GCC unroll 8
+      for(size_t j = 0; j < N; ++j)
+      {
+        Vec u = a[k * N + j], v = a[r * N + j];
+        a[k * N + j] = s ? v : u;
+        a[r * N + j] = s ? u : v;
+      }
+    }
+
+    singular |= mx == zero;
+    Vec d = 1 / a[k * N + k];
+#pragma GCC unroll 8
+    for(size_t r = k + 1; r < N; ++r)
+    {
+      Vec f = a[r * N + k] * d;
+      a[r * N + k] = f;
+#pragma GCC unroll 8
+      for(size_t j = k + 1; j < N; ++j)
+        a[r * N + j] -= f * a[k * N + j];
+    }
+    a[k * N + k] = d;
+  }
+
+  // 对角线已存为倒数，各右端项依次交换、前代、回代
+  for(size_t c = 0; c < m; ++c)
+  {
+#pragma GCC unroll 8
+    for(size_t i = 0; i < N; ++i)
+      x[i] = load_lanes(B + (i * m + c) * sb, cb, cnt, 0);
+
+    // L 随行交换整行移动，故先完成全部交换再前代
+#pragma GCC unroll 8
+    for(size_t k = 0; k < N; ++k)
+#pragma GCC unroll 8
+      for(size_t r = k + 1; r < N; ++r)
+      {
+        Mask s = p[k] == E(r);
+        Vec u = x[k], v = x[r];
+        x[k] = s ? v : u;
+        x[r] = s ? u : v;
+      }
+#pragma GCC unroll 8
+    for(size_t k = 0; k < N; ++k)
+#pragma GCC unroll 8
+      for(size_t r = k + 1; r < N; ++r)
+        x[r] -= a[r * N + k] * x[k];
+#pragma GCC unroll 8
+    for(size_t q = 0; q < N; ++q)
+    {
+      size_t i = N - 1 - q;
+#pragma GCC unroll 8
+      for(size_t j = i + 1; j < N; ++j)
+        x[i] -= a[i * N + j] * x[j];
+      x[i] *= a[i * N + i];
+    }
+
+#pragma GCC unroll 8
+    for(size_t i = 0; i < N; ++i)
+      store_lanes(B + (i * m + c) * sb, cb, cnt, x[i]);
+  }
+
+  size_t count = 0;
+  for(size_t l = 0; l < cnt; ++l)
+    count += singular[l] != 0;
+  return count;
+}
+
+// 按阶数分派，依次求解 [0, count) 中的各组方程组
+size_t solve_range(size_t n, size_t m, const E *A, size_t sa, size_t ca,
+    E *B, size_t sb, size_t cb, size_t count)
+{
+  size_t singular = 0;
+  for(size_t s = 0; s < count; s += W)
+  {
+    size_t cnt = std::min(W, count - s);
+    const E *a = A + s * ca;
+    E *b = B + s * cb;
+    switch(n)
+    {
+    case 1: singular += solve_lanes<1>(m, a, sa, ca, b, sb, cb, cnt); break;
+    case 2: singular += solve_lanes<2>(m, a, sa, ca, b, sb, cb, cnt); break;
+    case 3: singular += solve_lanes<3>(m, a, sa, ca, b, sb, cb, cnt); break;
+    case 4: singular += solve_lanes<4>(m, a, sa, ca, b, sb, cb, cnt); break;
+    case 5: singular += solve_lanes<5>(m, a, sa, ca, b, sb, cb, cnt); break;
+    case 6: singular += solve_lanes<6>(m, a, sa, ca, b, sb, cb, cnt); break;
+    case 7: singular += solve_lanes<7>(m, a, sa, ca, b, sb, cb, cnt); break;
+    case 8: singular += solve_lanes<8>(m, a, sa, ca, b, sb, cb, cnt); break;
+    }
+  }
+  return singular;
+}
+
+// 追赶法求解 cnt（不超过 W）个 n 阶三对角方程组
+// dl、d、du 第 i 行第 l 个元素为方程组 l 第 i 行的下、主、上对角元，行跳步 st、列跳步 ct
+// dl 第 0 行与 du 第 n-1 行不使用；B 的布局同 solve_lanes
+// 消元后的上对角元与主元的倒数存于 ws（至少 2 n W 个元素），各右端项共用
+// 末组不足 W 个方程组时以单位矩阵补齐；退回奇异方程组的个数
+static size_t tridiagonal_lanes(size_t n, size_t m, const E *dl, const E *d, const E *du,
+    size_t st, size_t ct, E *B, size_t sb, size_t cb, size_t cnt, E *ws)
+{
+  const Vec zero = { };
+  Mask singular = { };
+  Vec c = zero, r;
+  for(size_t i = 0; i < n; ++i)
+  {
+    Vec p = load_lanes(d + i * st, ct, cnt, 1);
+    if(i)
+      p -= load_lanes(dl + i * st, ct, cnt, 0) * c;
+    singular |= p == zero;
+    r = 1 / p;
+    c = i + 1 < n ? load_lanes(du + i * st, ct, cnt, 0) * r : zero;
+    memcpy(ws + 2 * i * W, &c, sizeof c);
+    memcpy(ws + (2 * i + 1) * W, &r, sizeof r);
+  }
+
+  for(size_t k = 0; k < m; ++k)
+  {
+    Vec x = zero;
+    for(size_t i = 0; i < n; ++i)
+    {
+      Vec b = load_lanes(B + (i * m + k) * sb, cb, cnt, 0);
+      if(i)
+        b -= load_lanes(dl + i * st, ct, cnt, 0) * x;
+      memcpy(&r, ws + (2 * i + 1) * W, sizeof r);
+      x = b * r;
+      store_lanes(B + (i * m + k) * sb, cb, cnt, x);
+    }
+    for(size_t i = n - 1; i-- > 0; )
+    {
+      memcpy(&c, ws + 2 * i * W, sizeof c);
+      x = load_lanes(B + (i * m + k) * sb, cb, cnt, 0) - c * x;
+      store_lanes(B + (i * m + k) * sb, cb, cnt, x);
+    }
+  }
+
+  size_t count = 0;
+  for(size_t l = 0; l < cnt; ++l)
+    count += singular[l] != 0;
+  return count;
+}
+
+// 依次求解 [0, count) 中的各组三对角方程组
+size_t tridiagonal_range(size_t n, size_t m, const E *dl, const E *d, const E *du,
+    size_t st, size_t ct, E *B, size_t sb, size_t cb, size_t count)
+{
+  std::vector<E> ws(2 * n * W);
+  size_t singular = 0;
+  for(size_t s = 0; s < count; s += W)
+    singular += tridiagonal_lanes(n, m, dl + s * ct, d + s * ct, du + s * ct, st, ct,
+        B + s * cb, sb, cb, std::min(W, count - s), ws.data());
+  return singular;
+}
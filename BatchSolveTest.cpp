@@ -0,0 +1,195 @@
+#include "TestBasic.h"
+#include "BatchSolve.h"
+#include "SMatrix.h"
+#include "Equation.h"
+#include "ThreadPool.h"
+#include "Cpu.h"
+#include <random>
+#include <ctime>
+#include <chrono>
+#include <cmath>
+
+using namespace std;
+
+void test_solve_batch();
+void test_solve_batch_strided();
+void test_solve_batch_singular();
+void test_solve_batch_repeat();
+
+static default_random_engine engine(time(NULL));
+
+int main()
+{
+  cout << "Detected ISA: " << isa_name(cpu_isa()) << endl;
+  test_solve_batch();
+  test_solve_batch_strided();
+  test_solve_batch_singular();
+  test_solve_batch_repeat();
+}
+
+// 随机系数，按轮换的位置加大各行一个元素，保证良态但需要选主元
+template<class T>
+static void fill_systems(size_t n, const BasicMatrix<T> &A, const BasicMatrix<T> &B)
+{
+  uniform_real_distribution<double> urd(-1, 1);
+  for(size_t s = 0; s < A.nc(); ++s)
+  {
+    for(size_t e = 0; e < A.nr(); ++e)
+      A(e, s) = urd(engine);
+    for(size_t i = 0; i < n; ++i)
+      A(i * n + (i + s) % n, s) += 4;
+    for(size_t e = 0; e < B.nr(); ++e)
+      B(e, s) = urd(engine);
+  }
+}
+
+// 逐个方程组检查残差 A_s X_s - B_s
+template<class T>
+static void check_residual(size_t n, const BasicMatrix<T> &A, const BasicMatrix<T> &B0,
+    const BasicMatrix<T> &X, double eps)
+{
+  size_t m = B0.nr() / n;
+  for(size_t s = 0; s < A.nc(); ++s)
+    for(size_t i = 0; i < n; ++i)
+      for(size_t c = 0; c < m; ++c)
+      {
+        double r = -B0(i * m + c, s);
+        for(size_t j = 0; j < n; ++j)
+          r += (double)A(i * n + j, s) * X(j * m + c, s);
+        assert(fabs(r) < eps);
+      }
+}
+
+void test_solve_batch()
+{
+  for(size_t n = 1; n <= batch_max_order; ++n)
+  for(size_t m : {1, 3})
+  for(size_t count : {1, 7, 8, 17, 33, 2500})
+  {
+    Matrix A(n * n, count), B(n * m, count);
+    fill_systems(n, A, B);
+    Matrix A0 = A.copy(), B0 = B.copy();
+    assert(solve_batch(n, A, B) == 0);
+    assert(A == A0);
+    check_residual(n, A, B0, B, 1e-12);
+
+    BasicMatrix<float> Af(n * n, count), Bf(n * m, count);
+    fill_systems(n, Af, Bf);
+    BasicMatrix<float> Bf0 = Bf.copy();
+    assert(solve_batch(n, Af, Bf) == 0);
+    check_residual(n, Af, Bf0, Bf, 1e-4);
+  }
+
+  // 与 solve_GJ 的结果一致，包括需要换行的情形
+  double in[2][3] = {
+    0, 1, 2,
+    1, 1, 5,
+  };
+  Matrix Ab(2, 3, in), A(4, 1), b(2, 1);
+  for(size_t e = 0; e < 4; ++e)
+    A(e, 0) = in[e / 2][e % 2];
+  b(0, 0) = 2;
+  b(1, 0) = 5;
+  solve_GJ(Ab);
+  solve_batch(2, A, b);
+  assert(b == Ab.col(2));
+
+  ASSERT_EXCEPTION(invalid_argument, solve_batch(0, Matrix(0, 3), Matrix(0, 3));)
+  ASSERT_EXCEPTION(invalid_argument, solve_batch(9, Matrix(81, 3), Matrix(9, 3));)
+  ASSERT_EXCEPTION(domain_error, solve_batch(3, Matrix(9, 3), Matrix(9, 4));)
+  ASSERT_EXCEPTION(domain_error, solve_batch(3, Matrix(8, 3), Matrix(9, 3));)
+  ASSERT_EXCEPTION(domain_error, solve_batch(3, Matrix(9, 3), Matrix(8, 3));)
+  TEST_PASSED;
+}
+
+// 每行一个方程组的布局经转置视图传入
+void test_solve_batch_strided()
+{
+  size_t n = 4, m = 2, count = 301;
+  Matrix At(count, n * n), Bt(count, n * m);
+  fill_systems(n, At.t(), Bt.t());
+  Matrix A0 = At.t().copy(), B0 = Bt.t().copy();
+  assert(solve_batch(n, At.t(), Bt.t()) == 0);
+  check_residual(n, A0, B0, Bt.t(), 1e-12);
+  TEST_PASSED;
+}
+
+void test_solve_batch_singular()
+{
+  size_t n = 3, count = 20;
+  Matrix A(n * n, count), B(n, count);
+  fill_systems(n, A, B);
+  Matrix A0 = A.copy(), B0 = B.copy();
+  for(size_t s : {2, 9, 19})
+    for(size_t i = 0; i < n; ++i)
+      A(i * n + 1, s) = 0;
+  assert(solve_batch(n, A, B) == 3);
+  for(size_t s = 0; s < count; ++s)
+  {
+    bool finite = isfinite(B(0, s)) && isfinite(B(1, s)) && isfinite(B(2, s));
+    assert(finite == (s != 2 && s != 9 && s != 19));
+  }
+  TEST_PASSED;
+}
+
+void test_solve_batch_repeat()
+{
+  size_t n = 3, count = 1 << 20;
+  Matrix A(n * n, count), B(n, count);
+  fill_systems(n, A, B);
+  Matrix B0 = B.copy();
+
+  clock_t start = clock();
+  solve_batch(n, A, B);
+  double batched = (double)(clock() - start) / CLOCKS_PER_SEC;
+  cout << "It took " << batched << " s to solve " << count << " 3x3 equations in a batch ("
+       << count / batched / 1e6 << " M/s)." << endl;
+
+  start = clock();
+  SMatrix<3, 1> x = SMatrix<3, 1>::filled(0);
+  for(size_t s = 0; s < count; ++s)
+  {
+    SMatrix<3, 3> As;
+    SMatrix<3, 1> bs;
+    for(size_t e = 0; e < 9; ++e)
+      As(e / 3, e % 3) = A(e, s);
+    for(size_t i = 0; i < 3; ++i)
+      bs(i, 0) = B0(i, s);
+    x += solve(As, bs);
+  }
+  double fixed = (double)(clock() - start) / CLOCKS_PER_SEC;
+  cout << "It took " << fixed << " s to solve them one by one with SMatrix ("
+       << fixed / batched << "x)." << endl;
+
+  size_t few = count / 64;
+  Matrix Ab(3, 4);
+  start = clock();
+  for(size_t s = 0; s < few; ++s)
+  {
+    for(size_t e = 0; e < 9; ++e)
+      Ab(e / 3, e % 3) = A(e, s);
+    for(size_t i = 0; i < 3; ++i)
+      Ab(i, 3) = B0(i, s);
+    solve_GJ(Ab);
+  }
+  double gj = (double)(clock() - start) / CLOCKS_PER_SEC * count / few;
+  cout << "Solving them with solve_GJ would take " << gj << " s ("
+       << gj / batched << "x)." << endl;
+
+  BasicMatrix<float> Af(n * n, count), Bf(n, count);
+  fill_systems(n, Af, Bf);
+  start = clock();
+  solve_batch(n, Af, Bf);
+  double single = (double)(clock() - start) / CLOCKS_PER_SEC;
+  cout << "It took " << single << " s to solve them in float (" << batched / single << "x)." << endl;
+
+  set_num_threads(4);
+  B = B0;
+  auto wall = chrono::steady_clock::now();
+  solve_batch(n, A, B);
+  chrono::duration<double> d = chrono::steady_clock::now() - wall;
+  cout << "It took " << d.count() << " s with " << num_threads() << " threads." << endl;
+  check_residual(n, A.col_slice(0, 1000), B0.col_slice(0, 1000), B.col_slice(0, 1000), 1e-12);
+  set_num_threads(0);
+  TEST_PASSED;
+}
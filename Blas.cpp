@@ -0,0 +1,267 @@
+#include "Blas.h"
+#include "Matrix.h"
+#include "Gemm.h"
+#include "Kernel.h"
+#include "ThreadPool.h"
+#include <stdexcept>
+#include <algorithm>
+#include <type_traits>
+
+template<class E>
+void gemm(scalar_t<E> alpha, const BasicMatrix<E> &A, const BasicMatrix<E> &B,
+    scalar_t<E> beta, const BasicMatrix<E> &C)
+{
+  if(A.nc() != B.nr() || C.nr() != A.nr() || C.nc() != B.nc())
+    throw std::domain_error("inconsistent shapes");
+  gemm_engine(C.nr(), C.nc(), A.nc(), alpha,
+      A.ptr(), A.sr(), A.sc(), B.ptr(), B.sr(), B.sc(),
+      beta, C.ptr(), C.sr(), C.sc());
+}
+
+template<class E>
+void axpy(scalar_t<E> alpha, const BasicMatrix<E> &X, const BasicMatrix<E> &Y)
+{
+  if(X.nr() != Y.nr() || X.nc() != Y.nc())
+    throw std::domain_error("inconsistent shapes");
+  auto f = element_kernels<E>().axpy;
+  for_each_line(Y, X, [&](size_t n, E *y, size_t sy, const E *x, size_t sx) {
+    f(n, y, sy, x, sx, alpha);
+  });
+}
+
+template<class E>
+void ger(scalar_t<E> alpha, const BasicMatrix<E> &x, const BasicMatrix<E> &y,
+    const BasicMatrix<E> &A)
+{
+  if(x.nc() != 1 || y.nr() != 1 || x.nr() != A.nr() || y.nc() != A.nc())
+    throw std::domain_error("inconsistent shapes");
+  auto f = element_kernels<E>().axpy;
+  for(size_t i = 0; i < A.nr(); ++i)
+    f(A.nc(), &A(i, 0), A.sc(), y.ptr(), y.sc(), alpha * x(i, 0));
+}
+
+static constexpr size_t trsm_block = 32;  // 递归到此规模以下逐行代入
+static constexpr size_t trsm_thin = 4;    // 右端项列数不超过此值时按列求内积
+
+template<class E>
+static void trsm_lower(Diag diag, const BasicMatrix<E> &L, const BasicMatrix<E> &B)
+{
+  size_t n = L.nr();
+  if(n <= trsm_block)
+  {
+    const BasicElementKernels<E> &ek = element_kernels<E>();
+    for(size_t i = 0; i < n; ++i)
+    {
+      if(B.nc() <= trsm_thin)
+        for(size_t c = 0; c < B.nc(); ++c)
+          B(i, c) -= ek.dot(i, &L(i, 0), L.sc(), &B(0, c), B.sr());
+      else for(size_t j = 0; j < i; ++j)
+        ek.axpy(B.nc(), &B(i, 0), B.sc(), &B(j, 0), B.sc(), -L(i, j));
+      if(diag == Diag::non_unit)
+        B.row(i) /= L(i, i);
+    }
+    return;
+  }
+  size_t h = n / 2;
+  trsm_lower(diag, L.slice(0, h), B.row_slice(0, h));
+  gemm(-1, L.slice(h, n, 0, h), B.row_slice(0, h), 1, B.row_slice(h));
+  trsm_lower(diag, L.slice(h), B.row_slice(h));
+}
+
+template<class E>
+static void trsm_upper(Diag diag, const BasicMatrix<E> &U, const BasicMatrix<E> &B)
+{
+  size_t n = U.nr();
+  if(n <= trsm_block)
+  {
+    const BasicElementKernels<E> &ek = element_kernels<E>();
+    for(size_t i = n; i--; )
+    {
+      if(B.nc() <= trsm_thin)
+        for(size_t c = 0; c < B.nc(); ++c)
+          B(i, c) -= ek.dot(n - i - 1, &U(i, i + 1), U.sc(), &B(i + 1, c), B.sr());
+      else for(size_t j = i + 1; j < n; ++j)
+        ek.axpy(B.nc(), &B(i, 0), B.sc(), &B(j, 0), B.sc(), -U(i, j));
+      if(diag == Diag::non_unit)
+        B.row(i) /= U(i, i);
+    }
+    return;
+  }
+  size_t h = n / 2;
+  trsm_upper(diag, U.slice(h), B.row_slice(h));
+  gemm(-1, U.slice(0, h, h, n), B.row_slice(h), 1, B.row_slice(0, h));
+  trsm_upper(diag, U.slice(0, h), B.row_slice(0, h));
+}
+
+template<class E>
+void trsm(Uplo uplo, Diag diag, const BasicMatrix<E> &T, const BasicMatrix<E> &B)
+{
+  if(!T.square())
+    throw std::domain_error("non-square triangular matrix");
+  if(T.nr() != B.nr())
+    throw std::invalid_argument("inconsistent T and B");
+  if(B.empty())
+    return;
+  if(uplo == Uplo::lower)
+    trsm_lower(diag, T, B);
+  else
+    trsm_upper(diag, T, B);
+}
+
+// Strassen-Winograd 递归，按 Boyer 等人的调度计算 C = A * B，
+// 每层只用两块临时区：X 为 m/2 行 max(k/2, n/2) 列，Y 为 k/2 行 n/2 列
+template<class E>
+class Strassen {
+private:
+  const BasicElementKernels<E> &ek = element_kernels<E>();
+  size_t cutoff;
+
+  // Y = X op Z，Y 不与 X、Z 重叠
+  void sum(const BasicMatrix<E> &Y, const BasicMatrix<E> &X, const BasicMatrix<E> &Z) const
+  {
+    for_each_line(Y, X, ek.assign);
+    for_each_line(Y, Z, ek.add);
+  }
+
+  void diff(const BasicMatrix<E> &Y, const BasicMatrix<E> &X, const BasicMatrix<E> &Z) const
+  {
+    for_each_line(Y, X, ek.assign);
+    for_each_line(Y, Z, ek.sub);
+  }
+
+  // Y = X - Y
+  void rsub(const BasicMatrix<E> &Y, const BasicMatrix<E> &X) const
+  {
+    for_each_line(Y, X, ek.sub);
+    for_each_line(Y, Y, ek.negate);
+  }
+
+  static BasicMatrix<E> borrow(E *w, size_t nr, size_t nc)
+  {
+    return BasicMatrix<E>::borrow(w, nr, nc, nc);
+  }
+
+public:
+  explicit Strassen(size_t c) : cutoff(c) {}
+
+  // 递归所需的工作区元素数
+  size_t workspace(size_t m, size_t k, size_t n) const
+  {
+    if(std::min({m, k, n}) <= cutoff)
+      return 0;
+    size_t hm = m / 2, hk = k / 2, hn = n / 2;
+    return hm * std::max(hk, hn) + hk * hn + workspace(hm, hk, hn);
+  }
+
+  // C = A * B，w 指向 workspace() 个元素
+  void multiply(const BasicMatrix<E> &A, const BasicMatrix<E> &B,
+      const BasicMatrix<E> &C, E *w) const
+  {
+    size_t m = C.nr(), k = A.nc(), n = C.nc();
+    if(std::min({m, k, n}) <= cutoff)
+    {
+      gemm(1, A, B, 0, C);
+      return;
+    }
+    size_t hm = m / 2, hk = k / 2, hn = n / 2;
+    size_t m2 = 2 * hm, k2 = 2 * hk, n2 = 2 * hn;
+    BasicMatrix<E> A11 = A.slice(0, hm, 0, hk), A12 = A.slice(0, hm, hk, k2);
+    BasicMatrix<E> A21 = A.slice(hm, m2, 0, hk), A22 = A.slice(hm, m2, hk, k2);
+    BasicMatrix<E> B11 = B.slice(0, hk, 0, hn), B12 = B.slice(0, hk, hn, n2);
+    BasicMatrix<E> B21 = B.slice(hk, k2, 0, hn), B22 = B.slice(hk, k2, hn, n2);
+    BasicMatrix<E> C11 = C.slice(0, hm, 0, hn), C12 = C.slice(0, hm, hn, n2);
+    BasicMatrix<E> C21 = C.slice(hm, m2, 0, hn), C22 = C.slice(hm, m2, hn, n2);
+
+    E *x = w, *y = x + hm * std::max(hk, hn), *next = y + hk * hn;
+    BasicMatrix<E> S = borrow(x, hm, hk), P1 = borrow(x, hm, hn), T = borrow(y, hk, hn);
+
+    diff(S, A11, A21);          // S3
+    diff(T, B22, B12);          // T3
+    multiply(S, T, C21, next);  // P7
+    sum(S, A21, A22);           // S1
+    diff(T, B12, B11);          // T1
+    multiply(S, T, C22, next);  // P5
+    for_each_line(S, A11, ek.sub);  // S2 = S1 - A11
+    rsub(T, B22);                   // T2 = B22 - T1
+    multiply(S, T, C12, next);  // P6
+    rsub(S, A12);               // S4 = A12 - S2
+    multiply(S, B22, C11, next);  // P3
+    multiply(A11, B11, P1, next);  // P1
+    for_each_line(C12, P1, ek.add);   // U2 = P1 + P6
+    for_each_line(C21, C12, ek.add);  // U3 = U2 + P7
+    for_each_line(C12, C22, ek.add);  // U4 = U2 + P5
+    for_each_line(C22, C21, ek.add);  // U7 = U3 + P5
+    for_each_line(C12, C11, ek.add);  // U5 = U4 + P3
+    for_each_line(T, B21, ek.sub);    // T4 = T2 - B21
+    multiply(A22, T, C11, next);  // P4
+    for_each_line(C21, C11, ek.sub);  // U6 = U3 - P4
+    multiply(A12, B21, C11, next);  // P2
+    for_each_line(C11, P1, ek.add);   // U1 = P1 + P2
+
+    // 剥离的奇数行列
+    if(k > k2)
+      gemm(1, A.slice(0, m2, k2, k), B.slice(k2, k, 0, n2), 1, C.slice(0, m2, 0, n2));
+    if(n > n2)
+      gemm(1, A, B.col_slice(n2, n), 0, C.col_slice(n2, n));
+    if(m > m2)
+      gemm(1, A.row_slice(m2, m), B.col_slice(0, n2), 0, C.slice(m2, m, 0, n2));
+  }
+};
+
+template<class E>
+void gemm_strassen(scalar_t<E> alpha, const BasicMatrix<E> &A, const BasicMatrix<E> &B,
+    scalar_t<E> beta, const BasicMatrix<E> &C, size_t cutoff)
+{
+  if(A.nc() != B.nr() || C.nr() != A.nr() || C.nc() != B.nc())
+    throw std::domain_error("inconsistent shapes");
+  Strassen<E> s(std::max<size_t>(cutoff ? cutoff : strassen_cutoff<E>(), 1));
+  size_t m = C.nr(), k = A.nc(), n = C.nc();
+  size_t ws = s.workspace(m, k, n);
+  if(!ws || C.empty())
+  {
+    gemm(alpha, A, B, beta, C);
+    return;
+  }
+  const BasicElementKernels<E> &ek = element_kernels<E>();
+  size_t extra = beta == scalar_t<E>(0) ? 0 : m * n;
+  BasicMatrix<E> W(1, ws + extra);
+  E *w = W.ptr();
+  BasicMatrix<E> P = extra ? BasicMatrix<E>::borrow(w + ws, m, n, n) : C;
+  s.multiply(A, B, P, w);
+  if(extra)
+  {
+    for_each_line(C, beta, ek.mul);
+    for_each_line(C, P, [&](size_t l, E *c, size_t sc, const E *p, size_t sp) {
+      ek.axpy(l, c, sc, p, sp, alpha);
+    });
+  }
+  else if(alpha != scalar_t<E>(1))
+    for_each_line(C, alpha, ek.mul);
+}
+
+// 单线程的交叉点由 StrassenBench 在 AVX-512 单核上测得：递归一层稳定快于 gemm 的阶数
+// float 约 3584，double 约 2304；long double 和复数用标量微内核，gemm 慢得多，约 128 起即快
+// 加减法不并行而 gemm 随线程数加速，省下的八分之一乘法时间与加减法时间相等处
+// 随线程数线性增长，故按 num_threads() 放大
+template<class E>
+size_t strassen_cutoff()
+{
+  size_t single = std::is_same_v<E, float> ? 3584 : std::is_same_v<E, double> ? 2304 : 128;
+  return single * num_threads();
+}
+
+#define BLAS_INSTANTIATE(E) \
+  template void gemm(scalar_t<E>, const BasicMatrix<E> &, const BasicMatrix<E> &, \
+      scalar_t<E>, const BasicMatrix<E> &); \
+  template void axpy(scalar_t<E>, const BasicMatrix<E> &, const BasicMatrix<E> &); \
+  template void ger(scalar_t<E>, const BasicMatrix<E> &, const BasicMatrix<E> &, \
+      const BasicMatrix<E> &); \
+  template void trsm(Uplo, Diag, const BasicMatrix<E> &, const BasicMatrix<E> &); \
+  template void gemm_strassen(scalar_t<E>, const BasicMatrix<E> &, const BasicMatrix<E> &, \
+      scalar_t<E>, const BasicMatrix<E> &, size_t); \
+  template size_t strassen_cutoff<E>();
+
+BLAS_INSTANTIATE(float)
+BLAS_INSTANTIATE(double)
+BLAS_INSTANTIATE(long double)
+BLAS_INSTANTIATE(std::complex<double>)
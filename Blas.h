@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Basic.h"
+
+// 以下函数直接写入目标矩阵视图；除 gemm_strassen 的工作区外不分配内存
+// 形状不一致时抛 domain_error
+// 库内为 float、double、long double 和 std::complex<double> 显式实例化
+
+// C = alpha * A * B + beta * C
+// beta 为 0 时不读取 C 的原值；C 不得与 A 或 B 重叠
+template<class E>
+void gemm(scalar_t<E> alpha, const BasicMatrix<E> &A, const BasicMatrix<E> &B,
+    scalar_t<E> beta, const BasicMatrix<E> &C);
+
+// Y += alpha * X
+template<class E>
+void axpy(scalar_t<E> alpha, const BasicMatrix<E> &X, const BasicMatrix<E> &Y);
+
+// A += alpha * x * y，x 为列向量，y 为行向量
+// 逐行更新，第 i 行更新前读取 x 的第 i 个元素，故 x 可以是 A 的一列
+// y 不得与 A 重叠
+template<class E>
+void ger(scalar_t<E> alpha, const BasicMatrix<E> &x, const BasicMatrix<E> &y,
+    const BasicMatrix<E> &A);
+
+// 三角矩阵的存储部分
+enum class Uplo { lower, upper };
+
+// 三角矩阵的对角线是否视为 1
+enum class Diag { unit, non_unit };
+
+// 求解 T X = B，结果写回 B，T 为三角方阵
+// 只读取 T 中 uplo 所指的三角部分，Diag::unit 时也不读取对角线
+// 分块递归，非对角块的更新由 gemm 完成
+// T 非方阵时抛 domain_error，T 与 B 行数不等时抛 invalid_argument
+template<class E>
+void trsm(Uplo, Diag, const BasicMatrix<E> &T, const BasicMatrix<E> &B);
+
+// 以 Strassen-Winograd 算法计算 C = alpha * A * B + beta * C，须显式调用
+// 每层 7 次子矩阵乘法、15 次加减，子块均为 slice() 视图，不拷贝；
+// 奇数行列剥离后由 gemm 补上，最短边不超过 cutoff 的子乘积直接交给 gemm
+// 误差界比 gemm 大，随递归层数增长，适用于能容忍略低精度的大方阵乘积
+// 各层中间量共用开始时一次分配的工作区；beta 不为 0 时另需一个 C 大小的缓冲区
+// cutoff 为 0 时取 strassen_cutoff<E>()
+// 形状不一致时抛 domain_error；C 不得与 A 或 B 重叠
+template<class E>
+void gemm_strassen(scalar_t<E> alpha, const BasicMatrix<E> &A, const BasicMatrix<E> &B,
+    scalar_t<E> beta, const BasicMatrix<E> &C, size_t cutoff = 0);
+
+// 默认的递归下限：StrassenBench 测得的该元类型单线程交叉点乘以 num_threads()
+template<class E>
+size_t strassen_cutoff();
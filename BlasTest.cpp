@@ -0,0 +1,227 @@
+#include "TestBasic.h"
+#include "Blas.h"
+#include "Matrix.h"
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <limits>
+#include <complex>
+
+using namespace std;
+
+void test_gemm();
+void test_axpy();
+void test_ger();
+void test_trsm();
+void test_gemm_strassen();
+
+int main()
+{
+  srand(time(NULL));
+  test_gemm();
+  test_axpy();
+  test_ger();
+  test_trsm();
+  test_gemm_strassen();
+}
+
+static void fill_random(const Matrix &A)
+{
+  for(size_t i = 0; i < A.nr(); ++i)
+    for(size_t j = 0; j < A.nc(); ++j)
+      A(i, j) = rand() % 17 - 8;
+}
+
+void test_gemm()
+{
+  ASSERT_EXCEPTION(domain_error, gemm(1, Matrix(2, 3), Matrix(2, 3), 0, Matrix(2, 3));)
+  ASSERT_EXCEPTION(domain_error, gemm(1, Matrix(2, 3), Matrix(3, 4), 0, Matrix(2, 3));)
+
+  for(size_t n : {3, 50, 200})
+  {
+    Matrix A(n, n + 1), B(n + 1, n + 2), C(n, n + 2);
+    fill_random(A);
+    fill_random(B);
+    fill_random(C);
+    Matrix C0 = C.copy();
+    gemm(2, A, B, -3, C);
+    assert(C == 2 * (A * B) - 3 * C0);
+
+    // beta 为 0 时忽略 C 中的 NaN
+    C.fill(numeric_limits<Number>::quiet_NaN());
+    gemm(1, A, B, 0, C);
+    assert(C == A * B);
+
+    // 写入转置视图
+    Matrix D(n + 2, n);
+    gemm(1, A, B, 0, D.t());
+    assert(D.t() == A * B);
+  }
+
+  // 窄矩阵乘积
+  for(size_t n : {1, 3, 4})
+  {
+    Matrix A(300, 200), x(200, n), y(n, 300), C(300, n), D(n, 200);
+    fill_random(A);
+    fill_random(x);
+    fill_random(y);
+    fill_random(C);
+    Matrix C0 = C.copy();
+    gemm(1, A, x, 2, C);
+    assert(C == A * x + 2 * C0);
+    gemm(1, y, A, 0, D);
+    assert(D == y * A);
+  }
+  TEST_PASSED;
+}
+
+void test_axpy()
+{
+  ASSERT_EXCEPTION(domain_error, axpy(1, Matrix(2, 3), Matrix(3, 2));)
+  Matrix X(7, 9), Y(9, 7);
+  fill_random(X);
+  fill_random(Y);
+  Matrix Y0 = Y.copy();
+  axpy(-2, X.t(), Y);
+  assert(Y == Y0 - 2 * X.t());
+  Matrix X0 = X.copy();
+  axpy(0.5, Y.slice(1, 3), X.slice(1, 3));
+  assert(X.slice(1, 3) == X0.slice(1, 3) + 0.5 * Y.slice(1, 3));
+  assert(X.row(0) == X0.row(0));
+  TEST_PASSED;
+}
+
+void test_ger()
+{
+  ASSERT_EXCEPTION(domain_error, ger(1, Matrix(2, 1), Matrix(1, 3), Matrix(3, 3));)
+  ASSERT_EXCEPTION(domain_error, ger(1, Matrix(1, 3), Matrix(1, 3), Matrix(3, 3));)
+  Matrix A(6, 5);
+  fill_random(A);
+  Matrix A0 = A.copy();
+
+  // x 取自 A 的首列，y 取自 A 之外
+  Matrix y(1, 5);
+  fill_random(y);
+  ger(-1, A.col(0), y, A);
+  for(size_t i = 0; i < A.nr(); ++i)
+    for(size_t j = 0; j < A.nc(); ++j)
+      assert(A(i, j) == A0(i, j) - A0(i, 0) * y(0, j));
+  TEST_PASSED;
+}
+
+void test_trsm()
+{
+  ASSERT_EXCEPTION(domain_error, trsm(Uplo::lower, Diag::unit, Matrix(2, 3), Matrix(2, 1));)
+  ASSERT_EXCEPTION(invalid_argument, trsm(Uplo::lower, Diag::unit, Matrix(3, 3), Matrix(2, 1));)
+
+  for(size_t n : {1, 5, 40, 150})
+  for(size_t m : {1, 3, 20})
+  for(Uplo uplo : {Uplo::lower, Uplo::upper})
+  for(Diag diag : {Diag::unit, Diag::non_unit})
+  {
+    // 另一三角部分填入 NaN，确认不被读取
+    Matrix T(n, n), X(n, m);
+    fill_random(T);
+    fill_random(X);
+    for(size_t i = 0; i < n; ++i)
+    {
+      for(size_t j = 0; j < n; ++j)
+        if(uplo == Uplo::lower ? j > i : j < i)
+          T(i, j) = numeric_limits<Number>::quiet_NaN();
+        else
+          T(i, j) /= 4 * n;
+      T(i, i) = diag == Diag::unit ? numeric_limits<Number>::quiet_NaN() : 2;
+    }
+    Matrix S(n, n);
+    for(size_t i = 0; i < n; ++i)
+      for(size_t j = 0; j < n; ++j)
+        S(i, j) = i == j ? (diag == Diag::unit ? 1 : 2) :
+                  (uplo == Uplo::lower ? j < i : j > i) ? T(i, j) : 0;
+    Matrix B = S * X;
+    trsm(uplo, diag, T, B);
+    for(size_t i = 0; i < n; ++i)
+      for(size_t j = 0; j < m; ++j)
+        assert(fabs(B(i, j) - X(i, j)) < 1e-9);
+  }
+  TEST_PASSED;
+}
+
+void test_gemm_strassen()
+{
+  ASSERT_EXCEPTION(domain_error, gemm_strassen(1, Matrix(2, 3), Matrix(2, 3), 0, Matrix(2, 3));)
+
+  // 矩阵元为小整数时各步运算无舍入，结果与 gemm 逐位一致
+  // cutoff 取小值以递归多层并经过各种奇偶剥离
+  for(size_t cutoff : {1, 4, 17})
+  for(size_t m : {1, 8, 33, 64})
+  for(size_t k : {2, 31, 64})
+  for(size_t n : {5, 32, 47})
+  {
+    Matrix A(m, k), B(k, n), C(m, n);
+    fill_random(A);
+    fill_random(B);
+    fill_random(C);
+    Matrix C0 = C.copy();
+    gemm_strassen(2, A, B, -3, C, cutoff);
+    assert(C == 2 * (A * B) - 3 * C0);
+
+    C.fill(numeric_limits<Number>::quiet_NaN());
+    gemm_strassen(1, A, B, 0, C, cutoff);
+    assert(C == A * B);
+  }
+
+  // 转置和切片视图
+  Matrix A(100, 90), B(90, 120);
+  fill_random(A);
+  fill_random(B);
+  Matrix At = A.t().copy(), D(120, 100);
+  gemm_strassen(1, At.t(), B, 0, D.t(), 8);
+  assert(D.t() == A * B);
+  Matrix E(80, 70);
+  E.fill(0);
+  gemm_strassen(-1, A.slice(10, 70, 5, 85), B.slice(5, 85, 20, 70), 0, E.slice(20, 80, 10, 60), 8);
+  assert(E.slice(20, 80, 10, 60) == -(A.slice(10, 70, 5, 85) * B.slice(5, 85, 20, 70)));
+  for(size_t j = 0; j < 70; ++j)
+    assert(E(0, j) == 0 && E(19, j) == 0 && ((j >= 10 && j < 60) || E(50, j) == 0));
+
+  // 一般实数矩阵误差与 gemm 同量级
+  size_t n = 300;
+  Matrix F(n, n), G(n, n), P(n, n);
+  for(size_t i = 0; i < n; ++i)
+    for(size_t j = 0; j < n; ++j)
+    {
+      F(i, j) = sin(i * 7.0 + j);
+      G(i, j) = cos(i + j * 3.0);
+    }
+  gemm_strassen(1, F, G, 0, P, 16);
+  Matrix Q = F * G;
+  for(size_t i = 0; i < n; ++i)
+    for(size_t j = 0; j < n; ++j)
+      assert(fabs(P(i, j) - Q(i, j)) < 1e-12 * n);
+
+  // 默认下限按元类型取测得的交叉点，低于下限时即 gemm
+  assert(strassen_cutoff<float>() > strassen_cutoff<Number>() && strassen_cutoff<Number>() > n);
+  Matrix R(n, n);
+  gemm_strassen(1, F, G, 0, R);
+  assert(R == Q);
+
+  // 其他元类型
+  BasicMatrix<float> Af(40, 40), Bf(40, 40), Cf(40, 40);
+  BasicMatrix<complex<double>> Az(30, 30), Bz(30, 30), Cz(30, 30);
+  for(size_t i = 0; i < 40; ++i)
+    for(size_t j = 0; j < 40; ++j)
+    {
+      Af(i, j) = rand() % 5;
+      Bf(i, j) = rand() % 5;
+      if(i < 30 && j < 30)
+      {
+        Az(i, j) = complex<double>(rand() % 5, rand() % 5);
+        Bz(i, j) = complex<double>(rand() % 5, rand() % 5);
+      }
+    }
+  gemm_strassen(1.0f, Af, Bf, 0.0f, Cf, 4);
+  assert(Cf == Af * Bf);
+  gemm_strassen(1.0, Az, Bz, 0.0, Cz, 4);
+  assert(Cz == Az * Bz);
+  TEST_PASSED;
+}
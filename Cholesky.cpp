@@ -0,0 +1,104 @@
+#include "Cholesky.h"
+#include "Kernel.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+// 分解 l 的下三角；ldl 为真时 W 为 n 行 block 列的工作区，存面板的 L D
+// 面板 P = l 的 [k0, k1) 列，Wp 为与 P 同列对应的 L（Cholesky）或 L D（LDL^T）
+// 第 i 行第 c 列：s = P(i, c) - P(i, 0:c) . Wp(k0 + c, 0:c)
+template<bool ldl>
+void factor(const Matrix &l, const Matrix &W, size_t block)
+{
+  const ElementKernels &ek = element_kernels();
+  size_t N = l.nr();
+
+  auto panel_row = [&](const Matrix &P, const Matrix &Wp, size_t k0, size_t i) {
+    size_t ce = std::min(i - k0 + 1, P.nc());
+    for(size_t c = 0; c < ce; ++c)
+    {
+      Number s = P(i, c) - ek.dot(c, &P(i, 0), P.sc(), &Wp(k0 + c, 0), Wp.sc());
+      if(k0 + c == i)
+      {
+        if(ldl ? s == 0 : !(s > 0))
+          throw i;
+        P(i, c) = ldl ? s : std::sqrt(s);
+      }
+      else
+      {
+        if(ldl)
+          Wp(i, c) = s;
+        P(i, c) = s / P(k0 + c, c);
+      }
+    }
+  };
+
+  for(size_t k0 = 0; k0 < N; k0 += block)
+  {
+    size_t k1 = std::min(k0 + block, N), kb = k1 - k0;
+    Matrix P = l.col_slice(k0, k1), Wp = ldl ? W.col_slice(0, kb) : P;
+
+    // 对角块逐行代入，其下各行相互独立
+    for(size_t i = k0; i < k1; ++i)
+      panel_row(P, Wp, k0, i);
+    if(k1 == N)
+      break;
+    size_t rows = (N - k1 + block - 1) / block;
+    parallel_for(rows, [&](size_t t) {
+      size_t i0 = k1 + t * block, i1 = std::min(i0 + block, N);
+      for(size_t i = i0; i < i1; ++i)
+        panel_row(P, Wp, k0, i);
+    });
+
+    // 右下子块的下三角 -= P Wp^T，按列块并行，对角块只更新下三角
+    parallel_for(rows, [&](size_t t) {
+      size_t j0 = k1 + t * block, j1 = std::min(j0 + block, N);
+      for(size_t i = j0; i < j1; ++i)
+        for(size_t j = j0; j <= i; ++j)
+          l(i, j) -= ek.dot(kb, &P(i, 0), P.sc(), &Wp(j, 0), Wp.sc());
+      if(j1 < N)
+        gemm(-1, P.row_slice(j1, N), Wp.row_slice(j0, j1).t(), 1, l.slice(j1, N, j0, j1));
+    });
+  }
+}
+
+Matrix triangle_view(const Matrix &A, Uplo uplo)
+{
+  if(!A.square())
+    throw std::domain_error("factorizing non-square matrix");
+  return uplo == Uplo::lower ? A : A.t();
+}
+
+}  // namespace
+
+Cholesky::Cholesky(const Matrix &A, Uplo uplo) : l(triangle_view(A, uplo))
+{
+  factor<false>(l, l, block);
+}
+
+void Cholesky::solve(const Matrix &B) const
+{
+  if(B.nr() != n())
+    throw std::invalid_argument("inconsistent A and B");
+  trsm(Uplo::lower, Diag::non_unit, l, B);
+  trsm(Uplo::upper, Diag::non_unit, l.t(), B);
+}
+
+LDLT::LDLT(const Matrix &A, Uplo uplo) : l(triangle_view(A, uplo))
+{
+  Matrix W(n(), std::min(block, n()));
+  factor<true>(l, W, block);
+}
+
+void LDLT::solve(const Matrix &B) const
+{
+  if(B.nr() != n())
+    throw std::invalid_argument("inconsistent A and B");
+  trsm(Uplo::lower, Diag::unit, l, B);
+  for(size_t i = 0; i < n(); ++i)
+    B.row(i) /= l(i, i);
+  trsm(Uplo::upper, Diag::unit, l.t(), B);
+}
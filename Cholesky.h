@@ -0,0 +1,59 @@
+#pragma once
+
+#include "Basic.h"
+#include "Matrix.h"
+#include "Blas.h"
+
+// 对称矩阵的分块分解，就地进行且只读写 A 的一个三角部分
+// 右视算法：面板内逐行代入（行内为连续内积），再以 gemm 更新右下子块的下三角，
+// 面板下方各行和右下子块的各列块分别交给线程池并行
+// 传入 A 的副本（A.copy()）可保留原矩阵；uplo 为 upper 时按转置视图访问，较 lower 慢
+
+// Cholesky 分解 A = L L^T，A 须对称正定
+class Cholesky {
+private:
+  Matrix  l;  // 与 A 共享存储，下三角（含对角线）存 L
+
+public:
+  static constexpr size_t block = 64;  // 面板宽度
+
+  // 分解 A，uplo 为 upper 时分解为 A = U^T U，U 存于 A 的上三角
+  // A 非方阵时抛 domain_error
+  // A 非正定时抛 size_t 首个非正主元所在行，此时 A 已被部分改写
+  explicit Cholesky(const Matrix &A, Uplo = Uplo::lower);
+
+  // 方阵阶数
+  size_t n() const { return l.nr(); }
+
+  // L 所在的视图，只有下三角有意义
+  const Matrix &factors() const { return l; }
+
+  // 求解 A X = B，结果写回 B，B 可有任意列
+  // B 行数与 A 不等时抛 invalid_argument
+  void solve(const Matrix &B) const;
+};
+
+// 不选主元的 LDL^T 分解，L 为单位下三角，D 为对角阵
+// 适用于各阶顺序主子式均非零的对称不定矩阵（如拟定矩阵），不作对称换行
+class LDLT {
+private:
+  Matrix  l;  // 与 A 共享存储，严格下三角存 L，对角线存 D
+
+public:
+  static constexpr size_t block = 64;  // 面板宽度
+
+  // 分解 A，uplo 为 upper 时分解为 A = U^T D U
+  // A 非方阵时抛 domain_error
+  // 主元为零时抛 size_t 所在行，此时 A 已被部分改写
+  explicit LDLT(const Matrix &A, Uplo = Uplo::lower);
+
+  // 方阵阶数
+  size_t n() const { return l.nr(); }
+
+  // L 和 D 所在的视图，只有下三角有意义
+  const Matrix &factors() const { return l; }
+
+  // 求解 A X = B，结果写回 B，B 可有任意列
+  // B 行数与 A 不等时抛 invalid_argument
+  void solve(const Matrix &B) const;
+};
@@ -0,0 +1,244 @@
+#include "TestBasic.h"
+#include "TestMatrix.h"
+#include "Cholesky.h"
+#include "LU.h"
+#include <ctime>
+#include <cmath>
+
+using namespace std;
+
+void test_cholesky_factors();
+void test_cholesky_solve();
+void test_ldlt();
+void test_cholesky_errors();
+void test_cholesky_threads();
+void test_cholesky_repeat();
+
+int main()
+{
+  seed_engine();
+  test_cholesky_factors();
+  test_cholesky_solve();
+  test_ldlt();
+  test_cholesky_errors();
+  test_cholesky_threads();
+  test_cholesky_repeat();
+}
+
+// 对称矩阵 M M^T / n + shift I，shift 为正时正定
+static Matrix random_symmetric(size_t n, Number shift)
+{
+  Matrix M = random(n, n);
+  Matrix A = M * M.t();
+  A /= n;
+  for(size_t i = 0; i < n; ++i)
+    A(i, i) += shift;
+  return A;
+}
+
+// 对角元正负相间且占优的对称不定矩阵
+static Matrix random_indefinite(size_t n)
+{
+  Matrix A = random_symmetric(n, 0);
+  for(size_t i = 0; i < n; ++i)
+    A(i, i) += i % 2 ? -2.0 - n / 8.0 : 2.0 + n / 8.0;
+  return A;
+}
+
+// 只保留 A 的一个三角，另一半置为 NaN
+static Matrix one_triangle(const Matrix &A, Uplo uplo)
+{
+  Matrix T = A.copy();
+  for(size_t i = 0; i < T.nr(); ++i)
+    for(size_t j = 0; j < T.nc(); ++j)
+      if(uplo == Uplo::lower ? j > i : j < i)
+        T(i, j) = NAN;
+  return T;
+}
+
+void test_cholesky_factors()
+{
+  for(Uplo uplo : { Uplo::lower, Uplo::upper })
+  for(size_t n : {1, 5, 63, 64, 65, 200})
+  {
+    Matrix A = random_symmetric(n, 1);
+    Matrix F = one_triangle(A, uplo);
+    Cholesky ch(F, uplo);
+
+    // 另一半未被读写，L 的对角线为正
+    Matrix L(n, n);
+    L.fill(0);
+    for(size_t i = 0; i < n; ++i)
+      for(size_t j = 0; j < n; ++j)
+        if(j > i)
+          assert(isnan(uplo == Uplo::lower ? F(i, j) : F(j, i)));
+        else
+          L(i, j) = uplo == Uplo::lower ? F(i, j) : F(j, i);
+    for(size_t i = 0; i < n; ++i)
+      assert(L(i, i) > 0);
+    assert(ch.factors()(n - 1, 0) == L(n - 1, 0));
+    assert(max_abs(L * L.t() - A) < 1e-13 * n);
+  }
+  TEST_PASSED;
+}
+
+void test_cholesky_solve()
+{
+  for(size_t n : {1, 3, 64, 129, 300})
+  for(size_t nrhs : {1, 7})
+  {
+    Matrix A = random_symmetric(n, 0.5);
+    Cholesky ch(one_triangle(A, Uplo::lower));
+    Matrix B = random(n, nrhs), X = B.copy();
+    ch.solve(X);
+    assert(max_abs(A * X - B) < 1e-11);
+
+    // 右端项为转置视图
+    Matrix Xt = B.t().copy();
+    ch.solve(Xt.t());
+    assert(max_abs(A * Xt.t() - B) < 1e-11);
+  }
+  TEST_PASSED;
+}
+
+void test_ldlt()
+{
+  for(Uplo uplo : { Uplo::lower, Uplo::upper })
+  for(size_t n : {1, 2, 64, 65, 201})
+  {
+    Matrix A = random_indefinite(n);
+    Matrix F = one_triangle(A, uplo);
+    LDLT ldl(F, uplo);
+
+    Matrix L(n, n), D(n, n);
+    L.fill(0);
+    D.fill(0);
+    for(size_t i = 0; i < n; ++i)
+    {
+      L(i, i) = 1;
+      D(i, i) = F(i, i);
+      for(size_t j = 0; j < i; ++j)
+      {
+        L(i, j) = uplo == Uplo::lower ? F(i, j) : F(j, i);
+        assert(isnan(uplo == Uplo::lower ? F(j, i) : F(i, j)));
+      }
+    }
+    assert(max_abs(L * D * L.t() - A) < 1e-12 * n);
+
+    // 不定矩阵的对角元有正有负
+    bool pos = false, neg = false;
+    for(size_t i = 0; i < n; ++i)
+    {
+      pos |= D(i, i) > 0;
+      neg |= D(i, i) < 0;
+    }
+    assert(pos && (neg || n == 1));
+
+    Matrix B = random(n, 3), X = B.copy();
+    ldl.solve(X);
+    assert(max_abs(A * X - B) < 1e-11);
+  }
+
+  // 对称正定时与 Cholesky 一致：L_chol = L sqrt(D)
+  Matrix A = random_symmetric(100, 1);
+  Matrix C = A.copy(), E = A.copy();
+  Cholesky(C, Uplo::lower);
+  LDLT(E, Uplo::lower);
+  for(size_t i = 0; i < 100; ++i)
+    for(size_t j = 0; j < i; ++j)
+      assert(abs(C(i, j) - E(i, j) * sqrt(E(j, j))) < 1e-12);
+  TEST_PASSED;
+}
+
+void test_cholesky_errors()
+{
+  ASSERT_EXCEPTION(domain_error, Cholesky(Matrix(2, 3));)
+  ASSERT_EXCEPTION(domain_error, LDLT(Matrix(3, 2));)
+  Matrix A = random_symmetric(10, 1);
+  ASSERT_EXCEPTION(invalid_argument, Cholesky(A.copy()).solve(Matrix(9, 1));)
+  ASSERT_EXCEPTION(invalid_argument, LDLT(A.copy()).solve(Matrix(11, 1));)
+  Cholesky(Matrix(0, 0)).solve(Matrix(0, 3));
+  LDLT(Matrix(0, 0)).solve(Matrix(0, 3));
+
+  // 不定矩阵在首个非正主元处失败；跨面板时同样报告所在行
+  for(size_t k : {3, 70})
+  {
+    Matrix S = random_symmetric(100, 1);
+    S(k, k) = -100;
+    try
+    {
+      Cholesky ch(S);
+      assert(false);
+    }
+    catch(size_t i)
+    {
+      assert(i == k);
+    }
+  }
+
+  // LDL^T 不选主元，首个主元为零即失败
+  double in[2][2] = {
+    0, 1,
+    1, 0,
+  };
+  ASSERT_EXCEPTION(size_t, LDLT(Matrix(2, 2, in));)
+  TEST_PASSED;
+}
+
+// 并行与串行结果一致
+void test_cholesky_threads()
+{
+  size_t n = 700;
+  Matrix A = random_symmetric(n, 1), B = random_indefinite(n);
+  Matrix C1 = A.copy(), D1 = B.copy(), C4 = A.copy(), D4 = B.copy();
+  with_threads(1, [&] {
+    Cholesky(C1, Uplo::lower);
+    LDLT(D1, Uplo::lower);
+  });
+  with_threads(4, [&] {
+    Cholesky(C4, Uplo::lower);
+    LDLT(D4, Uplo::lower);
+  });
+  for(size_t i = 0; i < n; ++i)
+    for(size_t j = 0; j <= i; ++j)
+    {
+      assert(abs(C1(i, j) - C4(i, j)) < 1e-12);
+      assert(abs(D1(i, j) - D4(i, j)) < 1e-10);
+    }
+  TEST_PASSED;
+}
+
+void test_cholesky_repeat()
+{
+  size_t n = 2000;
+  Matrix A = random_symmetric(n, 1);
+  Matrix F = A.copy();
+  clock_t start = clock();
+  Cholesky ch(F);
+  double chol = (double)(clock() - start) / CLOCKS_PER_SEC;
+  cout << "It took " << chol << " s to Cholesky factorize a " << n << "x" << n << " matrix ("
+       << n / 1e3 * n / 1e3 * n / 3 / chol << " MFLOPS)." << endl;
+
+  Matrix G = A.copy();
+  start = clock();
+  LDLT ldl(G);
+  double ldlt = (double)(clock() - start) / CLOCKS_PER_SEC;
+  cout << "It took " << ldlt << " s to LDLT factorize it." << endl;
+
+  start = clock();
+  LU lu(A);
+  double plu = (double)(clock() - start) / CLOCKS_PER_SEC;
+  cout << "It took " << plu << " s to LU factorize it (" << plu / chol << "x)." << endl;
+
+  Matrix B = random(n, 10), X = B.copy();
+  start = clock();
+  ch.solve(X);
+  cout << "It took " << (double)(clock() - start) / CLOCKS_PER_SEC
+       << " s to solve 10 right-hand sides." << endl;
+  assert(max_abs(A * X - B) < 1e-10);
+
+  G = A;
+  double wall = threaded_seconds(4, [&] { Cholesky(G, Uplo::lower); });
+  cout << "It took " << wall << " s with 4 threads." << endl;
+  TEST_PASSED;
+}
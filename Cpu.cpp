@@ -0,0 +1,52 @@
+#include "Cpu.h"
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+
+static Isa detect_isa()
+{
+  Isa isa = Isa::generic;
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("sse2"))
+    isa = Isa::sse2;
+  if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+    isa = Isa::avx2;
+  if(__builtin_cpu_supports("avx512f") && isa == Isa::avx2)
+    isa = Isa::avx512;
+#endif
+
+  const char *env = getenv("MATRIX_ISA");
+  if(env) for(Isa cap : {Isa::generic, Isa::sse2, Isa::avx2, Isa::avx512})
+  {
+    if(strcmp(env, isa_name(cap)) == 0)
+    {
+      if(cap < isa)
+        isa = cap;
+      break;
+    }
+  }
+  return isa;
+}
+
+Isa cpu_isa()
+{
+  static const Isa isa = detect_isa();
+  return isa;
+}
+
+const char *isa_name(Isa isa)
+{
+  switch(isa)
+  {
+  case Isa::generic:
+    return "generic";
+  case Isa::sse2:
+    return "sse2";
+  case Isa::avx2:
+    return "avx2";
+  case Isa::avx512:
+    return "avx512";
+  }
+  return "unknown";
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+// 指令集扩展等级，按能力递增排列
+enum class Isa {
+  generic,  // 纯标量代码
+  sse2,     // 128 位向量
+  avx2,     // 256 位向量与 FMA
+  avx512,   // 512 位向量
+};
+
+// 通过 CPUID 检测处理器支持的最高等级，结果缓存
+// 环境变量 MATRIX_ISA（generic/sse2/avx2/avx512）只能将等级调低
+Isa cpu_isa();
+
+// 等级名称
+const char *isa_name(Isa);
@@ -0,0 +1,727 @@
+#include "Eigen.h"
+#include "Band.h"
+#include "Blas.h"
+#include "Kernel.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr size_t block = SymmetricEigen::block, leaf = SymmetricEigen::leaf;
+constexpr size_t chunk = 256;       // 对称矩阵与向量之积按行分段的行数
+constexpr size_t wide = 4 * block;  // 回代时合并的反射个数
+constexpr size_t roots = 32;        // 每个并行任务求解的久期方程根数
+const Number eps = std::numeric_limits<Number>::epsilon();
+
+// y = S v，S 为 A 的 [c0, n) 行列，只读其下三角，v 与 y 的长度为 n - c0
+// 每段行逐行累加行内积与转置部分，该行此时仍在缓存中；part 至少为段数行 n 列
+void symv_lower(const Matrix &A, size_t c0, const Number *v, Number *y, const Matrix &part)
+{
+  size_t m = A.nr() - c0, segs = (m + chunk - 1) / chunk;
+  const ElementKernels &ek = element_kernels();
+  parallel_for(segs, [&](size_t s) {
+    size_t r0 = s * chunk, r1 = std::min(r0 + chunk, m);
+    Number *p = &part(s, 0);
+    std::fill(p, p + r1, 0);
+    for(size_t r = r0; r < r1; ++r)
+    {
+      const Number *a = &A(c0 + r, c0);
+      ek.axpy(r, p, 1, a, 1, v[r]);
+      p[r] += ek.dot(r, a, 1, v, 1) + a[r] * v[r];
+    }
+  });
+  std::fill(y, y + m, 0);
+  for(size_t s = 0; s < segs; ++s)
+  {
+    const Number *p = &part(s, 0);
+    for(size_t c = 0, r1 = std::min((s + 1) * chunk, m); c < r1; ++c)
+      y[c] += p[c];
+  }
+}
+
+// 化为三对角矩阵，d 为对角线，e[c] 为 (c + 1, c) 元
+// 第 c 个反射 H_c = I - tau_c v v^T 作用于第 c + 1 行起，v 存于 A 的第 c 行 c + 1 列起（首元为 1）
+void tridiagonalize(const Matrix &A, std::vector<Number> &d, std::vector<Number> &e,
+    std::vector<Number> &taus)
+{
+  size_t n = A.nr();
+  d.assign(n, 0);
+  e.assign(n, 0);
+  taus.assign(n, 0);
+  if(n == 0)
+    return;
+  Matrix Vp(n, block), Wp(n, block), part((n + chunk - 1) / chunk, n);
+  std::vector<Number> x(n), v(n), y(n), t1(block), t2(block);
+
+  for(size_t k = 0; k + 1 < n; k += block)
+  {
+    // 面板的 V 与 W 以第 k + 1 行为第 0 行
+    size_t kb = std::min(block, n - 1 - k), m = n - k - 1;
+    Matrix V = Vp.slice(0, m, 0, kb), W = Wp.slice(0, m, 0, kb);
+    V.fill(0);
+    W.fill(0);
+
+    for(size_t i = 0; i < kb; ++i)
+    {
+      // 取第 c 列，补上面板内先前反射的更新 A -= V W^T + W V^T
+      size_t c = k + i, len = n - c;
+      for(size_t r = 0; r < len; ++r)
+        x[r] = A(c + r, c);
+      if(i)
+        for(size_t r = 0; r < len; ++r)
+        {
+          const Number *vr = &V(i - 1 + r, 0), *wr = &W(i - 1 + r, 0);
+          const Number *vc = &V(i - 1, 0), *wc = &W(i - 1, 0);
+          Number s = 0;
+          for(size_t q = 0; q < i; ++q)
+            s += vr[q] * wc[q] + wr[q] * vc[q];
+          x[r] -= s;
+        }
+      d[c] = x[0];
+
+      // 消去 x[2:]
+      Number alpha = x[1], sigma = 0, beta = alpha, tau = 0, scale = 0;
+      for(size_t r = 2; r < len; ++r)
+        sigma += x[r] * x[r];
+      if(sigma != 0)
+      {
+        beta = -std::copysign(std::sqrt(alpha * alpha + sigma), alpha);
+        tau = (beta - alpha) / beta;
+        scale = 1 / (alpha - beta);
+      }
+      e[c] = beta;
+      taus[c] = tau;
+      v[0] = 1;
+      for(size_t r = 2; r < len; ++r)
+        v[r - 1] = x[r] * scale;
+      for(size_t r = 0; r + 1 < len; ++r)
+      {
+        V(i + r, i) = v[r];
+        A(c, c + 1 + r) = v[r];
+      }
+      if(tau == 0)
+        continue;
+
+      // w = tau (S v - V W^T v - W V^T v)，再 w -= tau / 2 (w^T v) v
+      size_t mv = len - 1;
+      symv_lower(A, c + 1, v.data(), y.data(), part);
+      std::fill(t1.begin(), t1.begin() + i, 0);
+      std::fill(t2.begin(), t2.begin() + i, 0);
+      for(size_t r = 0; r < mv; ++r)
+        for(size_t q = 0; q < i; ++q)
+        {
+          t1[q] += W(i + r, q) * v[r];
+          t2[q] += V(i + r, q) * v[r];
+        }
+      Number wv = 0;
+      for(size_t r = 0; r < mv; ++r)
+      {
+        Number s = 0;
+        for(size_t q = 0; q < i; ++q)
+          s += V(i + r, q) * t1[q] + W(i + r, q) * t2[q];
+        y[r] = tau * (y[r] - s);
+        wv += y[r] * v[r];
+      }
+      Number a = -tau / 2 * wv;
+      for(size_t r = 0; r < mv; ++r)
+        W(i + r, i) = y[r] + a * v[r];
+    }
+
+    // 右下子块的下三角 -= V W^T + W V^T，按列块并行
+    // 对角块的上三角一并更新，这些位置稍后存放反射向量
+    size_t j0 = k + kb;
+    if(j0 < n)
+    {
+      Matrix V2 = V.row_slice(kb - 1), W2 = W.row_slice(kb - 1);
+      size_t cols = (n - j0 + wide - 1) / wide;
+      parallel_for(cols, [&](size_t t) {
+        size_t b0 = t * wide, b1 = std::min(b0 + wide, n - j0);
+        Matrix C = A.slice(j0 + b0, n, j0 + b0, j0 + b1);
+        gemm(-1, V2.row_slice(b0), W2.row_slice(b0, b1).t(), 1, C);
+        gemm(-1, W2.row_slice(b0), V2.row_slice(b0, b1).t(), 1, C);
+      });
+    }
+  }
+  d[n - 1] = A(n - 1, n - 1);
+}
+
+// Z = Q Z，Q = H_0 H_1 ... H_{n-2}，Z 为 n 行
+// 每 wide 个反射合为 I - V T V^T，T 由 G = V^T V 按列递推
+void back_transform(const Matrix &A, const std::vector<Number> &taus, const Matrix &Z)
+{
+  size_t n = A.nr();
+  if(n < 2 || Z.empty())
+    return;
+  size_t panels = (n - 2) / wide + 1;
+  for(size_t p = panels; p-- > 0; )
+  {
+    size_t k = p * wide, kb = std::min(wide, n - 1 - k), m = n - k - 1;
+    Matrix V(m, kb), G(kb, kb), T(kb, kb);
+    V.fill(0);
+    for(size_t i = 0; i < kb; ++i)
+      for(size_t r = i; r < m; ++r)
+        V(r, i) = A(k + i, k + 1 + r);
+    gemm(1, V.t(), V, 0, G);
+    for(size_t i = 0; i < kb; ++i)
+    {
+      Number tau = taus[k + i];
+      for(size_t r = 0; r < i; ++r)
+      {
+        Number s = 0;
+        for(size_t q = r; q < i; ++q)
+          s += T(r, q) * G(q, i);
+        T(r, i) = -tau * s;
+      }
+      T(i, i) = tau;
+      for(size_t r = i + 1; r < kb; ++r)
+        T(r, i) = 0;
+    }
+
+    Matrix C = Z.row_slice(k + 1), W(kb, Z.nc()), W2(kb, Z.nc());
+    gemm(1, V.t(), C, 0, W);
+    gemm(1, T, W, 0, W2);
+    gemm(-1, V, W2, 1, C);
+  }
+}
+
+// 隐式 QL 求三对角矩阵的特征值，e[i] 为 (i + 1, i) 元，e[n-1] 不使用
+// Z 非空时对其各列作同样的旋转，初值为单位阵即得特征向量；结果未排序
+void tql(size_t n, Number *d, Number *e, const Matrix *Z)
+{
+  if(n == 0)
+    return;
+  e[n - 1] = 0;
+  // 相邻对角元接近 0 时纯相对的判据无法满足，以三对角矩阵的范数为绝对下限
+  Number tnorm = 0;
+  for(size_t i = 0; i < n; ++i)
+    tnorm = std::max(tnorm, std::abs(d[i]) + std::abs(e[i]));
+  for(size_t l = 0; l < n; ++l)
+  {
+    for(size_t iter = 0; ; ++iter)
+    {
+      size_t m = l;
+      for(; m + 1 < n; ++m)
+        if(std::abs(e[m]) <= eps * std::max(std::abs(d[m]) + std::abs(d[m + 1]), tnorm))
+          break;
+      if(m == l)
+        break;
+      if(iter == 60)
+        throw std::runtime_error("QL iteration did not converge");
+
+      Number g = (d[l + 1] - d[l]) / (2 * e[l]), r = std::hypot(g, Number(1));
+      g = d[m] - d[l] + e[l] / (g + std::copysign(r, g));
+      Number s = 1, c = 1, p = 0;
+      bool underflow = false;
+      for(size_t i = m; i-- > l; )
+      {
+        Number f = s * e[i], b = c * e[i];
+        e[i + 1] = r = std::hypot(f, g);
+        if(r == 0)
+        {
+          d[i + 1] -= p;
+          e[m] = 0;
+          underflow = true;
+          break;
+        }
+        s = f / r;
+        c = g / r;
+        g = d[i + 1] - p;
+        r = (d[i] - g) * s + 2 * c * b;
+        d[i + 1] = g + (p = s * r);
+        g = c * r - b;
+        if(Z)
+          for(size_t k = 0; k < Z->nr(); ++k)
+          {
+            Number &zi = (*Z)(k, i), &zj = (*Z)(k, i + 1);
+            f = zj;
+            zj = s * zi + c * f;
+            zi = c * zi - s * f;
+          }
+      }
+      if(underflow)
+        continue;
+      d[l] -= p;
+      e[l] = g;
+      e[m] = 0;
+    }
+  }
+}
+
+// 久期方程 1 + rho sum z_j^2 / (p_j - lambda) = 0 的第 i 个根，p 严格递增，rho > 0
+// 以较近的极点为原点求根，使 delta[j] = p_j - lambda 在根靠近极点时仍有相对精度
+// 迭代用两极点的有理模型（i 为最后一个根时为一个极点），出界时二分
+Number secular_root(size_t k, size_t i, const Number *p, const Number *z, Number rho,
+    Number *delta)
+{
+  size_t o = i;
+  Number lo = 0, hi;
+  if(i + 1 < k)
+  {
+    Number mid = (p[i + 1] - p[i]) / 2, f = 1;
+    for(size_t j = 0; j < k; ++j)
+      f += rho * z[j] * z[j] / ((p[j] - p[i]) - mid);
+    hi = mid;
+    if(f < 0)
+      o = i + 1, lo = -mid, hi = 0;
+  }
+  else
+  {
+    Number zz = 0;
+    for(size_t j = 0; j < k; ++j)
+      zz += z[j] * z[j];
+    hi = rho * zz;
+  }
+
+  for(size_t j = 0; j < k; ++j)
+    delta[j] = p[j] - p[o];
+  Number tau = (lo + hi) / 2;
+  for(size_t iter = 0; iter < 200; ++iter)
+  {
+    Number psi = 0, dpsi = 0, phi = 0, dphi = 0;
+    for(size_t j = 0; j <= i; ++j)
+    {
+      Number t = z[j] / (delta[j] - tau);
+      psi += z[j] * t;
+      dpsi += t * t;
+    }
+    for(size_t j = i + 1; j < k; ++j)
+    {
+      Number t = z[j] / (delta[j] - tau);
+      phi += z[j] * t;
+      dphi += t * t;
+    }
+    Number f = 1 + rho * (psi + phi);
+    if(f == 0)
+      break;
+    (f < 0 ? lo : hi) = tau;
+    dpsi *= rho;
+    dphi *= rho;
+
+    // 以 c + s / (Di - eta) + S / (Dj - eta) 逼近 f，取落在区间内的根
+    Number Di = delta[i] - tau, eta = NAN;
+    if(i + 1 < k)
+    {
+      Number Dj = delta[i + 1] - tau;
+      Number c = f - Di * dpsi - Dj * dphi, s = Di * Di * dpsi, S = Dj * Dj * dphi;
+      Number a = c * Di * Dj + s * Dj + S * Di, b = c * (Di + Dj) + s + S;
+      if(c == 0)
+        eta = a / b;
+      else
+      {
+        Number q = (b + std::copysign(std::sqrt(std::max(b * b - 4 * a * c, Number(0))), b)) / 2;
+        Number e1 = q / c, e2 = a / q;
+        bool in1 = tau + e1 > lo && tau + e1 < hi, in2 = tau + e2 > lo && tau + e2 < hi;
+        eta = in1 && (!in2 || std::abs(e1) < std::abs(e2)) ? e1 : e2;
+      }
+    }
+    else
+    {
+      Number c = f - Di * dpsi;
+      eta = Di + Di * Di * dpsi / c;
+    }
+    Number next = tau + eta;
+    if(!(next > lo && next < hi))
+      next = (lo + hi) / 2;
+    bool done = std::abs(next - tau) <= 2 * eps * std::max(std::abs(tau), std::abs(next))
+        || hi - lo <= 2 * eps * std::max(std::abs(lo), std::abs(hi));
+    tau = next;
+    if(done)
+      break;
+  }
+  for(size_t j = 0; j < k; ++j)
+    delta[j] -= tau;
+  return p[o] + tau;
+}
+
+// 按特征值升序重排 d 与 Z 的列
+void sort_columns(Number *d, const Matrix &Z)
+{
+  size_t n = Z.nc();
+  for(size_t i = 0; i < n; ++i)
+  {
+    size_t j = std::min_element(d + i, d + n) - d;
+    if(j == i)
+      continue;
+    std::swap(d[i], d[j]);
+    for(size_t r = 0; r < Z.nr(); ++r)
+      std::swap(Z(r, i), Z(r, j));
+  }
+}
+
+// 合并两个子问题：Q 为分块对角 [Q1, 0; 0, Q2]，Q1 为 m 阶，d 为两者的特征值
+// 原矩阵为 diag(d) + rho z z^T 经 Q 变换，z 由 Q1 的末行与 Q2 的首行组成
+// 收缩后解久期方程，以 Gu-Eisenstat 方法重算 z 使特征向量正交
+// Q 的列分为只在上半、稠密、只在下半三类，各类连续排列后上下两半各做一次 gemm
+void merge(Number *d, const Matrix &Q, size_t m, Number beta)
+{
+  size_t n = Q.nr();
+  Number rho = 2 * std::abs(beta), sign = beta < 0 ? -1 : 1;
+  std::vector<Number> z(n);
+  std::vector<int> type(n);
+  for(size_t j = 0; j < n; ++j)
+  {
+    z[j] = (j < m ? Q(m - 1, j) : sign * Q(m, j)) / std::sqrt(Number(2));
+    type[j] = j < m ? 0 : 2;
+  }
+  std::vector<size_t> perm(n);
+  std::iota(perm.begin(), perm.end(), 0);
+  std::sort(perm.begin(), perm.end(), [&](size_t a, size_t b) { return d[a] < d[b]; });
+  Number dmax = 0, zmax = 0;
+  for(size_t j = 0; j < n; ++j)
+  {
+    dmax = std::max(dmax, std::abs(d[j]));
+    zmax = std::max(zmax, std::abs(z[j]));
+  }
+  Number tol = 8 * eps * std::max(dmax, zmax);
+
+  // z 分量可忽略时直接收缩；相邻两极点足够近时以旋转消去其中一个 z 分量
+  std::vector<size_t> kept, defl;
+  size_t prev = n;
+  for(size_t j : perm)
+  {
+    if(rho * std::abs(z[j]) <= tol)
+    {
+      defl.push_back(j);
+      continue;
+    }
+    if(prev == n)
+    {
+      prev = j;
+      continue;
+    }
+    Number s = z[prev], c = z[j], tau = std::hypot(c, s), t = d[j] - d[prev];
+    c /= tau;
+    s = -s / tau;
+    if(std::abs(t * c * s) > tol)
+    {
+      kept.push_back(prev);
+      prev = j;
+      continue;
+    }
+    z[j] = tau;
+    z[prev] = 0;
+    for(size_t r = 0; r < n; ++r)
+    {
+      Number x = Q(r, prev), y = Q(r, j);
+      Q(r, prev) = c * x + s * y;
+      Q(r, j) = c * y - s * x;
+    }
+    if(type[prev] != type[j])
+      type[prev] = type[j] = 1;
+    Number dp = d[prev] * c * c + d[j] * s * s;
+    d[j] = d[prev] * s * s + d[j] * c * c;
+    d[prev] = dp;
+    defl.push_back(prev);
+    prev = j;
+  }
+  if(prev != n)
+    kept.push_back(prev);
+
+  size_t k = kept.size();
+  std::vector<Number> p(k), zk(k), lam(k), zhat(k, 1);
+  for(size_t j = 0; j < k; ++j)
+  {
+    p[j] = d[kept[j]];
+    zk[j] = z[kept[j]];
+  }
+  Matrix D2(std::max<size_t>(k, 1), std::max<size_t>(k, 1));
+  parallel_for((k + roots - 1) / roots, [&](size_t t) {
+    for(size_t i = t * roots; i < std::min(k, (t + 1) * roots); ++i)
+      lam[i] = secular_root(k, i, p.data(), zk.data(), rho, &D2(i, 0));
+  });
+
+  // zhat_j^2 = -prod_i (p_j - lambda_i) / prod_{i != j} (p_j - p_i)
+  for(size_t i = 0; i < k; ++i)
+    for(size_t j = 0; j < k; ++j)
+      zhat[j] *= i == j ? D2(i, j) : D2(i, j) / (p[j] - p[i]);
+  for(size_t j = 0; j < k; ++j)
+    zhat[j] = std::copysign(std::sqrt(std::max(-zhat[j], Number(0))), zk[j]);
+
+  // 按列的类别排序，Ut 的第 i 行为第 i 个根的特征向量在 Q 的各列上的系数
+  std::vector<size_t> order(k), pos(k);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+      [&](size_t a, size_t b) { return type[kept[a]] < type[kept[b]]; });
+  size_t c0 = 0, c2 = 0;
+  for(size_t g = 0; g < k; ++g)
+  {
+    pos[order[g]] = g;
+    c0 += type[kept[order[g]]] == 0;
+    c2 += type[kept[order[g]]] == 2;
+  }
+  Matrix Ut(std::max<size_t>(k, 1), std::max<size_t>(k, 1));
+  parallel_for((k + roots - 1) / roots, [&](size_t t) {
+    for(size_t i = t * roots; i < std::min(k, (t + 1) * roots); ++i)
+    {
+      Number norm = 0;
+      for(size_t j = 0; j < k; ++j)
+      {
+        Number u = zhat[j] / D2(i, j);
+        Ut(i, pos[j]) = u;
+        norm += u * u;
+      }
+      norm = 1 / std::sqrt(norm);
+      for(size_t g = 0; g < k; ++g)
+        Ut(i, g) *= norm;
+    }
+  });
+
+  // 新的特征向量写入 S 的前 k 列，收缩的特征向量原样放在其后
+  Matrix S(n, n);
+  size_t top = k - c2, bottom = k - c0;
+  if(k)
+  {
+    Matrix Qt(m, std::max<size_t>(top, 1)), Qb(n - m, std::max<size_t>(bottom, 1));
+    for(size_t r = 0; r < m; ++r)
+      for(size_t g = 0; g < top; ++g)
+        Qt(r, g) = Q(r, kept[order[g]]);
+    for(size_t r = m; r < n; ++r)
+      for(size_t g = c0; g < k; ++g)
+        Qb(r - m, g - c0) = Q(r, kept[order[g]]);
+    Matrix U = Ut.slice(0, k, 0, k).t();
+    if(top)
+      gemm(1, Qt.col_slice(0, top), U.row_slice(0, top), 0, S.slice(0, m, 0, k));
+    else
+      S.slice(0, m, 0, k).fill(0);
+    if(bottom)
+      gemm(1, Qb.col_slice(0, bottom), U.row_slice(c0), 0, S.slice(m, n, 0, k));
+    else
+      S.slice(m, n, 0, k).fill(0);
+  }
+  std::vector<std::pair<Number, size_t>> all(n);
+  for(size_t i = 0; i < k; ++i)
+    all[i] = { lam[i], i };
+  for(size_t t = 0; t < defl.size(); ++t)
+  {
+    all[k + t] = { d[defl[t]], k + t };
+    for(size_t r = 0; r < n; ++r)
+      S(r, k + t) = Q(r, defl[t]);
+  }
+  std::sort(all.begin(), all.end());
+  for(size_t c = 0; c < n; ++c)
+    d[c] = all[c].first;
+  for(size_t r = 0; r < n; ++r)
+    for(size_t c = 0; c < n; ++c)
+      Q(r, c) = S(r, all[c].second);
+}
+
+// 分治法求三对角矩阵的全部特征对，Q 为 n 阶方阵视图，结果按升序排列
+void divide(Number *d, Number *e, const Matrix &Q)
+{
+  size_t n = Q.nr();
+  if(n <= leaf)
+  {
+    Q.fill(0);
+    for(size_t i = 0; i < n; ++i)
+      Q(i, i) = 1;
+    std::vector<Number> f(e, e + n);
+    tql(n, d, f.data(), &Q);
+    sort_columns(d, Q);
+    return;
+  }
+  // T = diag(T1, T2) + |beta| u u^T，u 在第 m - 1 与 m 个分量上为 1 与 sign(beta)
+  size_t m = n / 2;
+  Number beta = e[m - 1];
+  d[m - 1] -= std::abs(beta);
+  d[m] -= std::abs(beta);
+  Q.slice(0, m, m, n).fill(0);
+  Q.slice(m, n, 0, m).fill(0);
+  divide(d, e, Q.slice(0, m, 0, m));
+  divide(d + m, e + m, Q.slice(m, n, m, n));
+  merge(d, Q, m, beta);
+}
+
+// T 中小于 x 的特征值个数（Sturm 序列），e2[i] 为 e[i] 的平方
+size_t sturm_count(size_t n, const Number *d, const Number *e2, Number x, Number pivmin)
+{
+  size_t count = 0;
+  Number q = 1;
+  for(size_t i = 0; i < n; ++i)
+  {
+    q = d[i] - x - (i ? e2[i - 1] / q : 0);
+    if(std::abs(q) < pivmin)
+      q = -pivmin;
+    count += q < 0;
+  }
+  return count;
+}
+
+// 二分法求第 [il, iu) 个特征值
+void bisect(size_t n, const Number *d, const Number *e, size_t il, size_t iu, Number *w)
+{
+  std::vector<Number> e2(n);
+  Number lo = 0, hi = 0, emax = 1;
+  for(size_t i = 0; i < n; ++i)
+  {
+    Number r = (i ? std::abs(e[i - 1]) : 0) + (i + 1 < n ? std::abs(e[i]) : 0);
+    lo = i ? std::min(lo, d[i] - r) : d[i] - r;
+    hi = i ? std::max(hi, d[i] + r) : d[i] + r;
+    e2[i] = i + 1 < n ? e[i] * e[i] : 0;
+    emax = std::max(emax, e2[i]);
+  }
+  Number pad = 2 * eps * std::max(std::abs(lo), std::abs(hi)) + std::numeric_limits<Number>::min();
+  lo -= pad;
+  hi += pad;
+  Number pivmin = std::numeric_limits<Number>::min() * emax;
+
+  parallel_for((iu - il + roots - 1) / roots, [&](size_t t) {
+    for(size_t j = il + t * roots; j < std::min(iu, il + (t + 1) * roots); ++j)
+    {
+      Number a = lo, b = hi;
+      for(size_t iter = 0; iter < 200; ++iter)
+      {
+        Number mid = a + (b - a) / 2;
+        if(b - a <= 2 * eps * std::max(std::abs(a), std::abs(b)) || mid == a || mid == b)
+          break;
+        (sturm_count(n, d, e2.data(), mid, pivmin) <= j ? a : b) = mid;
+      }
+      w[j - il] = a + (b - a) / 2;
+    }
+  });
+}
+
+// T - x I 的带状 LU 分解，恰好奇异时 x 增加 shift
+BandLU shifted_lu(size_t n, const Number *d, const Number *e, Number &x, Number shift)
+{
+  BandMatrix T(n, 1, 1);
+  for(;;)
+  {
+    for(size_t i = 0; i < n; ++i)
+    {
+      T(i, i) = d[i] - x;
+      if(i)
+        T(i, i - 1) = T(i - 1, i) = e[i - 1];
+    }
+    BandLU lu(T);
+    if(lu.invertible())
+      return lu;
+    x += shift;
+  }
+}
+
+// 逆迭代求 w 中各特征值的特征向量，写入 V 的各行
+// 间距小于 1e-3 |T| 的特征值为一簇，簇内后求的向量与先求的正交，重复的特征值略加扰动
+void inverse_iteration(size_t n, const Number *d, const Number *e, const std::vector<Number> &w,
+    const Matrix &V)
+{
+  size_t k = w.size();
+  Number norm = 0;
+  for(size_t i = 0; i < n; ++i)
+    norm = std::max(norm, std::abs(d[i]) + (i ? std::abs(e[i - 1]) : 0)
+        + (i + 1 < n ? std::abs(e[i]) : 0));
+  Number gap = 1e-3 * norm, shift = 10 * eps * std::max(norm, Number(1));
+  std::vector<size_t> first = { 0 };
+  for(size_t j = 1; j < k; ++j)
+    if(w[j] - w[j - 1] > gap)
+      first.push_back(j);
+  first.push_back(k);
+
+  parallel_for(first.size() - 1, [&](size_t c) {
+    Number prev = 0;
+    for(size_t j = first[c]; j < first[c + 1]; ++j)
+    {
+      Number x = j > first[c] && w[j] - prev < shift ? prev + shift : w[j];
+      Matrix y(n, 1);
+      // 确定的伪随机初值
+      size_t seed = 2 * j + 1;
+      for(size_t i = 0; i < n; ++i)
+      {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        y(i, 0) = Number(seed >> 11) / Number(1ULL << 53) - 0.5;
+      }
+      BandLU lu = shifted_lu(n, d, e, x, shift);
+      prev = x;
+      for(size_t iter = 0; iter < 3; ++iter)
+      {
+        lu.solve(y);
+        for(size_t q = first[c]; q < j; ++q)
+        {
+          Number s = 0;
+          for(size_t i = 0; i < n; ++i)
+            s += V(q, i) * y(i, 0);
+          for(size_t i = 0; i < n; ++i)
+            y(i, 0) -= s * V(q, i);
+        }
+        Number s = 0;
+        for(size_t i = 0; i < n; ++i)
+          s += y(i, 0) * y(i, 0);
+        s = 1 / std::sqrt(s);
+        for(size_t i = 0; i < n; ++i)
+          y(i, 0) *= s;
+      }
+      for(size_t i = 0; i < n; ++i)
+        V(j, i) = y(i, 0);
+    }
+  });
+}
+
+}  // namespace
+
+SymmetricEigen::SymmetricEigen(const Matrix &A, bool vectors)
+  : z(compute(A, 0, A.nr(), vectors, w))
+{
+}
+
+SymmetricEigen::SymmetricEigen(const Matrix &A, size_t il, size_t iu, bool vectors)
+  : z(compute(A, il, iu, vectors, w))
+{
+}
+
+Matrix SymmetricEigen::compute(const Matrix &A, size_t il, size_t iu, bool vectors,
+    std::vector<Number> &w)
+{
+  if(!A.square())
+    throw std::domain_error("eigenvalues of non-square matrix");
+  size_t n = A.nr();
+  if(il > iu || iu > n)
+    throw std::invalid_argument("eigenvalue index range out of bounds");
+  // 按行扫描需要行内连续，否则在副本上进行
+  Matrix a = A.sc() == 1 ? A : A.copy();
+  std::vector<Number> d, e, taus;
+  tridiagonalize(a, d, e, taus);
+
+  if(il == 0 && iu == n)
+  {
+    if(!vectors)
+    {
+      tql(n, d.data(), e.data(), nullptr);
+      std::sort(d.begin(), d.end());
+      w = d;
+      return Matrix(n, 0);
+    }
+    // 按最大元缩放，避免久期方程中的上溢和下溢
+    Number scale = 0;
+    for(size_t i = 0; i < n; ++i)
+      scale = std::max({ scale, std::abs(d[i]), std::abs(e[i]) });
+    if(scale == 0)
+      scale = 1;
+    for(size_t i = 0; i < n; ++i)
+    {
+      d[i] /= scale;
+      e[i] /= scale;
+    }
+    Matrix z(n, n);
+    divide(d.data(), e.data(), z);
+    for(Number &x : d)
+      x *= scale;
+    w = d;
+    back_transform(a, taus, z);
+    return z;
+  }
+
+  w.resize(iu - il);
+  bisect(n, d.data(), e.data(), il, iu, w.data());
+  if(!vectors)
+    return Matrix(n, 0);
+  Matrix V(w.size(), n);
+  inverse_iteration(n, d.data(), e.data(), w, V);
+  Matrix z = V.t().copy();
+  back_transform(a, taus, z);
+  return z;
+}
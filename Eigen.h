@@ -0,0 +1,47 @@
+#pragma once
+
+#include "Basic.h"
+#include "Matrix.h"
+#include <vector>
+
+// 实对称矩阵的特征分解 A = Z diag(w) Z^T，特征值按升序排列
+// 分三步：
+//   1. 分块 Householder 变换化为三对角矩阵 T = Q^T A Q
+//      每 block 列为一个面板，逐列生成反射，对称矩阵与向量之积按行分段并行；
+//      右下子块的秩 2 block 更新按列块并行，由 gemm 完成
+//   2. 求 T 的特征对
+//      全部特征向量用分治法，合并时解久期方程，新的特征向量由 gemm 得到；
+//      只求特征值时用隐式 QL；只求第 [il, iu) 个时用二分法，特征向量由逆迭代求得，
+//      相近的特征值归为一簇，簇内正交化，各簇并行
+//   3. 以紧凑 WY 形式的 gemm 将特征向量变换回 A 的坐标 Z = Q Z_T
+// 就地进行，只读 A 的下三角；完成后 A 的内容不再有意义，传入 A.copy() 可保留原矩阵
+class SymmetricEigen {
+private:
+  std::vector<Number>  w;  // 特征值
+  Matrix               z;  // n 行 k 列，各列为对应的特征向量；只求特征值时为空
+
+  // 求特征值写入 w，退回特征向量
+  static Matrix compute(const Matrix &A, size_t il, size_t iu, bool vectors,
+      std::vector<Number> &w);
+
+public:
+  static constexpr size_t block = 32;  // 三对角化的面板宽度
+  static constexpr size_t leaf = 32;   // 分治法递归到此阶数以下用隐式 QL
+
+  // 全部特征值，vectors 为真时同时求特征向量
+  // A 非方阵时抛 domain_error，隐式 QL 不收敛时抛 runtime_error
+  explicit SymmetricEigen(const Matrix &A, bool vectors = true);
+
+  // 按升序从 0 计的第 [il, iu) 个特征值
+  // il > iu 或 iu 超过阶数时抛 invalid_argument
+  SymmetricEigen(const Matrix &A, size_t il, size_t iu, bool vectors = true);
+
+  // 求得的特征值个数
+  size_t size() const { return w.size(); }
+
+  Number value(size_t i) const { return w[i]; }
+  const std::vector<Number> &values() const { return w; }
+
+  // 第 i 列为 value(i) 的单位特征向量
+  const Matrix &vectors() const { return z; }
+};
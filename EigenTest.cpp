@@ -0,0 +1,301 @@
+#include "TestBasic.h"
+#include "TestMatrix.h"
+#include "Eigen.h"
+#include "QR.h"
+#include <ctime>
+#include <cmath>
+
+using namespace std;
+
+void test_eigen_full();
+void test_eigen_known();
+void test_eigen_degenerate();
+void test_eigen_range();
+void test_eigen_rank_deficient();
+void test_eigen_errors();
+void test_eigen_threads();
+void test_eigen_repeat();
+
+int main()
+{
+  seed_engine();
+  test_eigen_full();
+  test_eigen_known();
+  test_eigen_degenerate();
+  test_eigen_range();
+  test_eigen_rank_deficient();
+  test_eigen_errors();
+  test_eigen_threads();
+  test_eigen_repeat();
+}
+
+static Matrix random_symmetric(size_t n)
+{
+  Matrix M = random(n, n);
+  Matrix A = M + M.t();
+  return A;
+}
+
+// Q diag(w) Q^T，Q 为随机正交矩阵
+static Matrix with_spectrum(const vector<Number> &w)
+{
+  size_t n = w.size();
+  Matrix Q = identity(n);
+  QR(random(n, n)).apply_q(Q);
+  Matrix QD = Q.copy();
+  for(size_t i = 0; i < n; ++i)
+    for(size_t j = 0; j < n; ++j)
+      QD(i, j) *= w[j];
+  Matrix A = QD * Q.t();
+  return A;
+}
+
+// 检查 A Z = Z diag(w)、Z^T Z = I 且 w 升序，tol 相对于 A 的最大元
+static void check_pairs(const Matrix &A, const SymmetricEigen &es, Number tol)
+{
+  const Matrix &Z = es.vectors();
+  size_t n = A.nr(), k = es.size();
+  assert(Z.nr() == n && Z.nc() == k);
+  Matrix R = A * Z;
+  for(size_t i = 0; i < n; ++i)
+    for(size_t j = 0; j < k; ++j)
+      R(i, j) -= Z(i, j) * es.value(j);
+  Number a = max(max_abs(A), Number(1));
+  assert(max_abs(R) < tol * a);
+  assert(max_abs(Z.t() * Z - identity(k)) < tol);
+  for(size_t j = 1; j < k; ++j)
+    assert(es.value(j - 1) <= es.value(j));
+}
+
+void test_eigen_full()
+{
+  for(size_t n : {1, 2, 5, 31, 32, 33, 65, 200, 301})
+  {
+    Matrix A = random_symmetric(n);
+    // 只读下三角
+    Matrix F = A.copy();
+    for(size_t i = 0; i < n; ++i)
+      for(size_t j = i + 1; j < n; ++j)
+        F(i, j) = NAN;
+    SymmetricEigen es(F);
+    assert(es.size() == n);
+    check_pairs(A, es, 1e-12 * n);
+
+    SymmetricEigen ev(A.copy(), false);
+    assert(ev.size() == n && ev.vectors().empty());
+    for(size_t i = 0; i < n; ++i)
+      assert(abs(ev.value(i) - es.value(i)) < 1e-12 * n);
+
+    // 迹与 Frobenius 范数
+    Number tr = 0, sum = 0, fro = 0, sq = 0;
+    for(size_t i = 0; i < n; ++i)
+    {
+      tr += A(i, i);
+      sum += es.value(i);
+      sq += es.value(i) * es.value(i);
+      for(size_t j = 0; j < n; ++j)
+        fro += A(i, j) * A(i, j);
+    }
+    assert(abs(tr - sum) < 1e-11 * n && abs(fro - sq) < 1e-11 * fro);
+  }
+
+  // 转置视图
+  Matrix A = random_symmetric(50);
+  Matrix At = A.copy();
+  SymmetricEigen et(At.t());
+  check_pairs(A, et, 1e-11);
+  TEST_PASSED;
+}
+
+// 一维 Laplace 算子的特征值 2 - 2 cos(k pi / (n + 1))
+void test_eigen_known()
+{
+  size_t n = 400;
+  Matrix L(n, n);
+  L.fill(0);
+  for(size_t i = 0; i < n; ++i)
+  {
+    L(i, i) = 2;
+    if(i)
+      L(i, i - 1) = L(i - 1, i) = -1;
+  }
+  SymmetricEigen es(L.copy());
+  check_pairs(L, es, 1e-11);
+  for(size_t k = 0; k < n; ++k)
+    assert(abs(es.value(k) - (2 - 2 * cos((k + 1) * M_PI / (n + 1)))) < 1e-13);
+
+  // 已是对角阵
+  SymmetricEigen ed(identity(70));
+  for(size_t k = 0; k < 70; ++k)
+    assert(ed.value(k) == 1);
+  check_pairs(identity(70), ed, 1e-14);
+
+  // 全零
+  Matrix Z(3, 3);
+  Z.fill(0);
+  SymmetricEigen ez(Z);
+  assert(ez.value(0) == 0 && ez.value(2) == 0);
+  TEST_PASSED;
+}
+
+// 大量重复和极其接近的特征值，分治法靠收缩保持正交
+void test_eigen_degenerate()
+{
+  size_t n = 300;
+  vector<Number> w(n);
+  for(size_t i = 0; i < n; ++i)
+    w[i] = i % 3 == 0 ? 1 : i % 3 == 1 ? -2 : 5 + 1e-12 * i;
+  Matrix A = with_spectrum(w);
+  SymmetricEigen es(A.copy());
+  check_pairs(A, es, 1e-12 * n);
+  sort(w.begin(), w.end());
+  for(size_t i = 0; i < n; ++i)
+    assert(abs(es.value(i) - w[i]) < 1e-12 * n);
+
+  // 跨越多个数量级
+  for(size_t i = 0; i < n; ++i)
+    w[i] = pow(10.0, -8 + 16.0 * i / n) * (i % 2 ? 1 : -1);
+  Matrix B = with_spectrum(w);
+  SymmetricEigen eb(B.copy());
+  check_pairs(B, eb, 1e-12 * n);
+  TEST_PASSED;
+}
+
+void test_eigen_range()
+{
+  size_t n = 250;
+  Matrix A = random_symmetric(n);
+  SymmetricEigen all(A.copy(), false);
+  for(auto r : { make_pair(0, 1), make_pair(0, 10), make_pair(100, 130), make_pair(240, 250),
+                 make_pair(0, 250), make_pair(7, 7) })
+  {
+    size_t il = r.first, iu = r.second;
+    SymmetricEigen ev(A.copy(), il, iu, false);
+    assert(ev.size() == iu - il && ev.vectors().empty());
+    for(size_t i = il; i < iu; ++i)
+      assert(abs(ev.value(i - il) - all.value(i)) < 1e-12 * n);
+
+    SymmetricEigen es(A.copy(), il, iu);
+    assert(es.size() == iu - il);
+    check_pairs(A, es, 1e-11 * n);
+  }
+
+  // 成簇的特征值
+  vector<Number> w(n);
+  for(size_t i = 0; i < n; ++i)
+    w[i] = i < 20 ? 1 + 1e-10 * i : i < 40 ? 3 : i;
+  Matrix B = with_spectrum(w);
+  SymmetricEigen es(B.copy(), 0, 45);
+  check_pairs(B, es, 1e-10);
+  TEST_PASSED;
+}
+
+// 秩亏和大量重复的特征值，阶数大于 leaf，三种方式都须收敛
+void test_eigen_rank_deficient()
+{
+  for(size_t n : {33, 129, 200, 257, 512})
+  {
+    // 全 1 矩阵：特征值 n 和 n - 1 重 0
+    Matrix J(n, n);
+    J.fill(1);
+    vector<Number> w(n, 0);
+    w[n - 1] = n;
+
+    // 秩 2，特征值 -3、5 和 n - 2 重 0
+    vector<Number> w2(n, 0);
+    w2[0] = -3;
+    w2[n - 1] = 5;
+    Matrix R = with_spectrum(w2);
+
+    // 只有两个不同的特征值
+    vector<Number> w3(n);
+    for(size_t i = 0; i < n; ++i)
+      w3[i] = i < n / 2 ? -1 : 2;
+    Matrix P = with_spectrum(w3);
+
+    for(auto c : { make_pair(&J, &w), make_pair(&R, &w2), make_pair(&P, &w3) })
+    {
+      const Matrix &A = *c.first;
+      const vector<Number> &v = *c.second;
+      Number tol = 1e-12 * n * max(max_abs(A), Number(1));
+      SymmetricEigen es(A.copy());
+      check_pairs(A, es, 1e-12 * n);
+      SymmetricEigen ev(A.copy(), false);
+      size_t il = n / 3, iu = n - 1;
+      SymmetricEigen er(A.copy(), il, iu);
+      check_pairs(A, er, 1e-11 * n);
+      for(size_t i = 0; i < n; ++i)
+        assert(abs(es.value(i) - v[i]) < tol && abs(ev.value(i) - v[i]) < tol);
+      for(size_t i = il; i < iu; ++i)
+        assert(abs(er.value(i - il) - v[i]) < tol);
+    }
+  }
+  TEST_PASSED;
+}
+
+void test_eigen_errors()
+{
+  ASSERT_EXCEPTION(domain_error, SymmetricEigen(Matrix(3, 4));)
+  ASSERT_EXCEPTION(invalid_argument, SymmetricEigen(identity(5), 3, 2);)
+  ASSERT_EXCEPTION(invalid_argument, SymmetricEigen(identity(5), 0, 6);)
+  SymmetricEigen e0(Matrix(0, 0));
+  assert(e0.size() == 0);
+  SymmetricEigen e1(identity(4), 2, 2);
+  assert(e1.size() == 0 && e1.vectors().nc() == 0);
+  TEST_PASSED;
+}
+
+// 分段固定，特征值与线程数无关
+void test_eigen_threads()
+{
+  size_t n = 600;
+  Matrix A = random_symmetric(n);
+  SymmetricEigen e1 = with_threads(1, [&] { return SymmetricEigen(A.copy()); });
+  SymmetricEigen e4 = with_threads(4, [&] { return SymmetricEigen(A.copy()); });
+  SymmetricEigen r4 = with_threads(4, [&] { return SymmetricEigen(A.copy(), 10, 60); });
+  for(size_t i = 0; i < n; ++i)
+    assert(abs(e1.value(i) - e4.value(i)) < 1e-12 * n);
+  check_pairs(A, e4, 1e-12 * n);
+  check_pairs(A, r4, 1e-11 * n);
+  TEST_PASSED;
+}
+
+void test_eigen_repeat()
+{
+  size_t n = 2000;
+  Matrix A = random_symmetric(n);
+  Matrix F = A.copy();
+  clock_t start = clock();
+  SymmetricEigen es(F);
+  double full = (double)(clock() - start) / CLOCKS_PER_SEC;
+  cout << "It took " << full << " s to compute all eigenpairs of a " << n << "x" << n
+       << " matrix." << endl;
+
+  F = A;
+  start = clock();
+  SymmetricEigen ev(F, false);
+  double values = (double)(clock() - start) / CLOCKS_PER_SEC;
+  cout << "It took " << values << " s to compute the eigenvalues only." << endl;
+
+  F = A;
+  start = clock();
+  SymmetricEigen er(F, 0, n / 20);
+  double range = (double)(clock() - start) / CLOCKS_PER_SEC;
+  cout << "It took " << range << " s to compute the lowest " << n / 20 << " eigenpairs." << endl;
+
+  Matrix Z = es.vectors().col_slice(0, 100);
+  Matrix R = A * Z;
+  for(size_t i = 0; i < n; ++i)
+    for(size_t j = 0; j < 100; ++j)
+      R(i, j) -= Z(i, j) * es.value(j);
+  assert(max_abs(R) < 1e-11 * n);
+  for(size_t i = 0; i < n; ++i)
+    assert(abs(es.value(i) - ev.value(i)) < 1e-12 * n);
+  for(size_t i = 0; i < n / 20; ++i)
+    assert(abs(es.value(i) - er.value(i)) < 1e-12 * n);
+
+  F = A;
+  double wall = threaded_seconds(4, [&] { SymmetricEigen e4(F); });
+  cout << "It took " << wall << " s with 4 threads." << endl;
+  TEST_PASSED;
+}
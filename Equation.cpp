@@ -1,20 +1,22 @@
 #include "Equation.h"
 #include "Matrix.h"
+#include "Blas.h"
 #include <stdexcept>
 #include <cmath>
 
 using std::abs;
 
-size_t select_pivot(const Matrix &A)
+template<class T>
+size_t select_pivot(const BasicMatrix<T> &A)
 {
   if(A.empty())
     throw std::domain_error("selecting pivot for empty matrix");
   size_t pivot_r = 0;
-  StepIterator iter = A.col_begin(0);
-  Number pivot = abs(*iter++);
+  BasicStepIterator<T> iter = A.col_begin(0);
+  auto pivot = abs(*iter++);
   for(size_t i = 1; i < A.nr(); ++i)
   {
-    Number value = abs(*iter++);
+    auto value = abs(*iter++);
     if(value > pivot)
     {
       pivot = value;
@@ -26,25 +28,26 @@ size_t select_pivot(const Matrix &A)
   return pivot_r;
 }
 
-size_t transform_UUT(const Matrix &_A)
+template<class T>
+size_t transform_UUT(const BasicMatrix<T> &_A)
 {
-  Matrix A(_A);
+  BasicMatrix<T> A(_A);
   size_t cnt = 0;
   while(!A.empty())
   {
     select_pivot(A);
-    if(A[0][0] == 0)
+    if(A[0][0] == T(0))
       break;
     A.row(0) /= A[0][0];
-    for(size_t i = 1; i < A.nr(); ++i)
-      A.row(i) -= A[i][0] * A.row(0);
+    ger(-1, A.col(0).row_slice(1), A.row(0), A.row_slice(1));
     ++cnt;
     A.reset(A.slice(1));
   }
   return cnt;
 }
 
-void solve_UUT(const Matrix &A, const Matrix &b)
+template<class T>
+void solve_UUT(const BasicMatrix<T> &A, const BasicMatrix<T> &b)
 {
   if(!A.square())
     throw std::domain_error("solving non-square equation");
@@ -52,21 +55,33 @@ void solve_UUT(const Matrix &A, const Matrix &b)
     throw std::invalid_argument("inconsistent A and b");
   for(size_t i = 1; i < A.nr(); ++i)
   {
-    Matrix As = A.slice(A.nr() - i - 1, A.nr() - i, A.nc() - i, A.nc());
-    Matrix bs = b.row_slice(b.nr() - i, b.nr());
-    b.row(b.nr() - i - 1) -= As * bs;
+    BasicMatrix<T> As = A.slice(A.nr() - i - 1, A.nr() - i, A.nc() - i, A.nc());
+    BasicMatrix<T> bs = b.row_slice(b.nr() - i, b.nr());
+    gemm(-1, As, bs, 1, b.row(b.nr() - i - 1));
     As.fill(0);
   }
 }
 
-void solve_GJ(const Matrix &Ab)
+template<class T>
+void solve_GJ(const BasicMatrix<T> &Ab)
 {
   if(Ab.nr() > Ab.nc())
     throw std::domain_error("invalid argumented matrix");
   size_t r = transform_UUT(Ab);
   if(r != Ab.nr())
     throw r;
-  Matrix A = Ab.col_slice(0, Ab.nr());
-  Matrix b = Ab.col_slice(Ab.nr());
+  BasicMatrix<T> A = Ab.col_slice(0, Ab.nr());
+  BasicMatrix<T> b = Ab.col_slice(Ab.nr());
   solve_UUT(A, b);
 }
+
+#define EQUATION_INSTANTIATE(T) \
+  template size_t select_pivot(const BasicMatrix<T> &); \
+  template size_t transform_UUT(const BasicMatrix<T> &); \
+  template void solve_UUT(const BasicMatrix<T> &, const BasicMatrix<T> &); \
+  template void solve_GJ(const BasicMatrix<T> &);
+
+EQUATION_INSTANTIATE(float)
+EQUATION_INSTANTIATE(double)
+EQUATION_INSTANTIATE(long double)
+EQUATION_INSTANTIATE(std::complex<double>)
@@ -2,6 +2,7 @@
 #include "Equation.h"
 #include "Matrix.h"
 #include <random>
+#include <complex>
 #include <ctime>
 #include <iomanip>
 
@@ -12,6 +13,7 @@ void test_transform_UUT();
 void test_solve_UUT();
 void test_solve_GJ();
 void test_solve_GJ_repeat();
+void test_solve_GJ_types();
 
 int main()
 {
@@ -20,6 +22,7 @@ int main()
   test_solve_UUT();
   test_solve_GJ();
   test_solve_GJ_repeat();
+  test_solve_GJ_types();
 }
 
 void test_select_pivot()
@@ -194,3 +197,41 @@ void test_solve_GJ_repeat()
 
   TEST_PASSED;
 }
+
+// 以 x = (1, 2, ..., n) 构造右端项，解出后与 x 比较
+template<class T>
+static void check_solve_GJ(double eps)
+{
+  size_t n = 6;
+  BasicMatrix<T> Ab(n, n + 1);
+  for(size_t i = 0; i < n; ++i)
+  {
+    T b = 0;
+    for(size_t j = 0; j < n; ++j)
+    {
+      if constexpr(is_same_v<T, complex<double>>)
+        Ab(i, j) = T((i * 7 + j * 3) % 11 + (i == j) * 20, (i + 2 * j) % 5);
+      else
+        Ab(i, j) = (i * 7 + j * 3) % 11 + (i == j) * 20;
+      b += Ab(i, j) * T(j + 1);
+    }
+    Ab(i, n) = b;
+  }
+  solve_GJ(Ab);
+  for(size_t i = 0; i < n; ++i)
+    assert(abs(Ab(i, n) - T(i + 1)) <= eps);
+
+  BasicMatrix<T> S(2, 3);
+  S.fill(1);
+  assert(transform_UUT(S) == 1);
+  ASSERT_EXCEPTION(size_t, solve_GJ(S);)
+}
+
+void test_solve_GJ_types()
+{
+  check_solve_GJ<float>(1e-5);
+  check_solve_GJ<double>(1e-13);
+  check_solve_GJ<long double>(1e-16);
+  check_solve_GJ<complex<double>>(1e-13);
+  TEST_PASSED;
+}
@@ -0,0 +1,422 @@
+#pragma once
+
+// 本文件由 Matrix.h 包含，实现矩阵加减和数量乘除的惰性求值
+// 表达式在赋值给 Matrix 时单趟融合计算，不产生中间矩阵
+
+#include "Matrix.h"
+#include <type_traits>
+#include <stdexcept>
+#include <utility>
+
+// 标记所有表达式类型
+struct MatrixExprBase { };
+
+template<class T>
+constexpr bool is_matrix_expr_v = std::is_base_of_v<MatrixExprBase, T>;
+
+template<class T>
+struct is_basic_matrix : std::false_type { };
+
+template<class T>
+struct is_basic_matrix<BasicMatrix<T>> : std::true_type { };
+
+template<class T>
+constexpr bool is_basic_matrix_v = is_basic_matrix<T>::value;
+
+// 可参与表达式运算的类型：BasicMatrix 或表达式，二者均以 value_type 给出矩阵元类型
+template<class T>
+constexpr bool is_matrix_operand_v = is_basic_matrix_v<T> || is_matrix_expr_v<T>;
+
+template<class E>
+class MatrixExpr : public MatrixExprBase {
+public:
+  const E &self() const { return static_cast<const E &>(*this); }
+  size_t nr() const { return self().nr(); }
+  size_t nc() const { return self().nc(); }
+  auto operator()(size_t i, size_t j) const { return self().template at<false>(i, j); }
+
+  // 单趟计算 dst = Op(dst, *this)，形状不一致时抛 domain_error
+  // dst 与操作数部分重叠时先求值到临时矩阵
+  template<class Op, class T>
+    void apply_to(const BasicMatrix<T> &dst) const;
+
+  // dst = *this
+  template<class T>
+    void assign_to(const BasicMatrix<T> &dst) const;
+};
+
+// 表达式中的矩阵操作数，持有引用以保证数据区存活
+template<class T>
+class MatrixLeaf : public MatrixExpr<MatrixLeaf<T>> {
+private:
+  BasicMatrix<T>  m;
+
+public:
+  typedef T value_type;
+
+  MatrixLeaf(const BasicMatrix<T> &matrix) : m(matrix) { }
+
+  size_t nr() const { return m.nr(); }
+  size_t nc() const { return m.nc(); }
+
+  // 所有矩阵操作数的列跳步均为 1
+  bool unit() const { return m.sc() == 1; }
+
+  // 与 dst 的数据区部分重叠（完全重合的视图逐元素对应，不算重叠）
+  bool aliases(const BasicMatrix<T> &dst) const;
+
+  template<bool Unit>
+    T at(size_t i, size_t j) const
+    {
+      return m.ptr()[i * m.sr() + (Unit ? j : j * m.sc())];
+    }
+};
+
+template<class T>
+using expr_operand_t =
+  std::conditional_t<is_basic_matrix_v<T>, MatrixLeaf<typename T::value_type>, T>;
+
+struct ExprAssign {
+  template<class T>
+    static T apply(T, T b) { return b; }
+};
+
+struct ExprAdd {
+  template<class T>
+    static T apply(T a, T b) { return a + b; }
+};
+
+struct ExprSub {
+  template<class T>
+    static T apply(T a, T b) { return a - b; }
+};
+
+// 结果写回右操作数时的减法
+struct ExprRsub {
+  template<class T>
+    static T apply(T a, T b) { return b - a; }
+};
+
+struct ExprMul {
+  template<class T>
+    static T apply(T a, T b) { return a * b; }
+};
+
+struct ExprDiv {
+  template<class T>
+    static T apply(T a, T b) { return a / b; }
+};
+
+struct ExprNeg {
+  template<class T>
+    static T apply(T a, T) { return -a; }
+};
+
+// 逐元素二元运算
+template<class L, class R, class Op>
+class BinaryExpr : public MatrixExpr<BinaryExpr<L, R, Op>> {
+private:
+  expr_operand_t<L>  l;
+  expr_operand_t<R>  r;
+
+public:
+  typedef typename expr_operand_t<L>::value_type value_type;
+  static_assert(std::is_same_v<value_type, typename expr_operand_t<R>::value_type>,
+      "operands must have the same element type");
+
+  // 形状不一致时抛 domain_error
+  BinaryExpr(const L &lhs, const R &rhs) : l(lhs), r(rhs)
+  {
+    if(l.nr() != r.nr() || l.nc() != r.nc())
+      throw std::domain_error("inconsistent shapes");
+  }
+
+  size_t nr() const { return l.nr(); }
+  size_t nc() const { return l.nc(); }
+  bool unit() const { return l.unit() && r.unit(); }
+
+  template<class T>
+    bool aliases(const BasicMatrix<T> &dst) const { return l.aliases(dst) || r.aliases(dst); }
+
+  template<bool Unit>
+    value_type at(size_t i, size_t j) const
+    {
+      return Op::apply(l.template at<Unit>(i, j), r.template at<Unit>(i, j));
+    }
+};
+
+// 逐元素与数量运算
+template<class E, class Op>
+class ScalarExpr : public MatrixExpr<ScalarExpr<E, Op>> {
+public:
+  typedef typename expr_operand_t<E>::value_type value_type;
+
+private:
+  expr_operand_t<E>  e;
+  value_type         k;
+
+public:
+  ScalarExpr(const E &expr, value_type scalar) : e(expr), k(scalar) { }
+
+  size_t nr() const { return e.nr(); }
+  size_t nc() const { return e.nc(); }
+  bool unit() const { return e.unit(); }
+
+  template<class T>
+    bool aliases(const BasicMatrix<T> &dst) const { return e.aliases(dst); }
+
+  template<bool Unit>
+    value_type at(size_t i, size_t j) const
+    {
+      return Op::apply(e.template at<Unit>(i, j), k);
+    }
+};
+
+template<class T>
+inline bool MatrixLeaf<T>::aliases(const BasicMatrix<T> &dst) const
+{
+  if(!m.ref(dst) || m.empty() || dst.empty())
+    return false;
+  if(m.ptr() == dst.ptr() && m.sr() == dst.sr() && m.sc() == dst.sc())
+    return false;
+  const T *m_end = &m(m.nr() - 1, m.nc() - 1);
+  const T *d_end = &dst(dst.nr() - 1, dst.nc() - 1);
+  return !(m_end < dst.ptr() || d_end < m.ptr());
+}
+
+template<class E>
+template<class Op, class T>
+void MatrixExpr<E>::apply_to(const BasicMatrix<T> &dst) const
+{
+  static_assert(std::is_same_v<typename E::value_type, T>,
+      "expression and destination must have the same element type");
+  const E &e = self();
+  if(dst.nr() != e.nr() || dst.nc() != e.nc())
+    throw std::domain_error("inconsistent shapes");
+  if(e.aliases(dst))
+  {
+    BasicMatrix<T> tmp(e.nr(), e.nc());
+    apply_to<ExprAssign>(tmp);
+    MatrixLeaf<T>(tmp).template apply_to<Op>(dst);
+    return;
+  }
+  size_t sr = dst.sr(), sc = dst.sc();
+  if(sc == 1 && e.unit())
+    for(size_t i = 0; i < e.nr(); ++i)
+    {
+      T *d = dst.ptr() + i * sr;
+      for(size_t j = 0; j < e.nc(); ++j)
+        d[j] = Op::apply(d[j], e.template at<true>(i, j));
+    }
+  else
+    for(size_t i = 0; i < e.nr(); ++i)
+    {
+      T *d = dst.ptr() + i * sr;
+      for(size_t j = 0; j < e.nc(); ++j)
+        d[j * sc] = Op::apply(d[j * sc], e.template at<false>(i, j));
+    }
+}
+
+template<class E>
+template<class T>
+void MatrixExpr<E>::assign_to(const BasicMatrix<T> &dst) const
+{
+  apply_to<ExprAssign>(dst);
+}
+
+template<class T>
+template<class E>
+BasicMatrix<T>::BasicMatrix(const MatrixExpr<E> &e) : BasicMatrix(e.nr(), e.nc())
+{
+  e.assign_to(*this);
+}
+
+template<class T>
+template<class E>
+const BasicMatrix<T> &BasicMatrix<T>::operator+=(const MatrixExpr<E> &e) const
+{
+  e.template apply_to<ExprAdd>(*this);
+  return *this;
+}
+
+template<class T>
+template<class E>
+BasicMatrix<T> &BasicMatrix<T>::operator+=(const MatrixExpr<E> &e)
+{
+  return (BasicMatrix &)(*(const BasicMatrix *)this += e);
+}
+
+template<class T>
+template<class E>
+const BasicMatrix<T> &BasicMatrix<T>::operator-=(const MatrixExpr<E> &e) const
+{
+  e.template apply_to<ExprSub>(*this);
+  return *this;
+}
+
+template<class T>
+template<class E>
+BasicMatrix<T> &BasicMatrix<T>::operator-=(const MatrixExpr<E> &e)
+{
+  return (BasicMatrix &)(*(const BasicMatrix *)this -= e);
+}
+
+// 矩阵加法
+template<class L, class R,
+  class = std::enable_if_t<is_matrix_operand_v<L> && is_matrix_operand_v<R>>>
+BinaryExpr<L, R, ExprAdd> operator+(const L &A, const R &B)
+{
+  return BinaryExpr<L, R, ExprAdd>(A, B);
+}
+
+template<class L, class R,
+  class = std::enable_if_t<is_matrix_operand_v<L> && is_matrix_operand_v<R>>>
+BinaryExpr<L, R, ExprSub> operator-(const L &A, const R &B)
+{
+  return BinaryExpr<L, R, ExprSub>(A, B);
+}
+
+// 矩阵数量乘法
+template<class E, class = std::enable_if_t<is_matrix_operand_v<E>>>
+ScalarExpr<E, ExprMul> operator*(const E &A, typename E::value_type k)
+{
+  return ScalarExpr<E, ExprMul>(A, k);
+}
+
+template<class E, class = std::enable_if_t<is_matrix_operand_v<E>>>
+ScalarExpr<E, ExprMul> operator*(typename E::value_type k, const E &A)
+{
+  return ScalarExpr<E, ExprMul>(A, k);
+}
+
+template<class E, class = std::enable_if_t<is_matrix_operand_v<E>>>
+ScalarExpr<E, ExprDiv> operator/(const E &A, typename E::value_type k)
+{
+  return ScalarExpr<E, ExprDiv>(A, k);
+}
+
+// 表达式参与矩阵乘法和比较时先求值，矩阵元类型由表达式给出
+template<class E>
+using expr_matrix_t = BasicMatrix<typename E::value_type>;
+
+template<class L, class R, class = std::enable_if_t<is_matrix_operand_v<L> &&
+  is_matrix_operand_v<R> && (is_matrix_expr_v<L> || is_matrix_expr_v<R>)>>
+auto operator*(const L &A, const R &B)
+{
+  return expr_matrix_t<L>(A) * expr_matrix_t<R>(B);
+}
+
+template<class L, class R, class = std::enable_if_t<is_matrix_operand_v<L> &&
+  is_matrix_operand_v<R> && (is_matrix_expr_v<L> || is_matrix_expr_v<R>)>>
+bool operator==(const L &A, const R &B)
+{
+  return expr_matrix_t<L>(A) == expr_matrix_t<R>(B);
+}
+
+template<class L, class R, class = std::enable_if_t<is_matrix_operand_v<L> &&
+  is_matrix_operand_v<R> && (is_matrix_expr_v<L> || is_matrix_expr_v<R>)>>
+bool operator!=(const L &A, const R &B)
+{
+  return !(A == B);
+}
+
+// 表达式取负（矩阵取负见 Matrix::operator-）
+template<class E>
+ScalarExpr<E, ExprNeg> operator-(const MatrixExpr<E> &A)
+{
+  return ScalarExpr<E, ExprNeg>(A.self(), 0);
+}
+
+template<class E>
+E operator+(const MatrixExpr<E> &A)
+{
+  return A.self();
+}
+
+// 右值矩阵操作数的数据区不与其他对象共享时，就地计算并移交其数据区
+// 否则按表达式求值到新矩阵；形状不一致时均抛 domain_error
+
+template<class T, class R>
+void check_shape(const BasicMatrix<T> &A, const R &B)
+{
+  if(A.nr() != B.nr() || A.nc() != B.nc())
+    throw std::domain_error("inconsistent shapes");
+}
+
+template<class T, class R, class = std::enable_if_t<is_matrix_operand_v<R>>>
+BasicMatrix<T> operator+(BasicMatrix<T> &&A, const R &B)
+{
+  if(A.ref() != 1)
+    return A + B;
+  check_shape(A, B);
+  A += B;
+  return std::move(A);
+}
+
+template<class T, class L, class = std::enable_if_t<is_matrix_operand_v<L>>>
+BasicMatrix<T> operator+(const L &A, BasicMatrix<T> &&B)
+{
+  if(B.ref() != 1)
+    return A + B;
+  check_shape(B, A);
+  B += A;
+  return std::move(B);
+}
+
+template<class T>
+BasicMatrix<T> operator+(BasicMatrix<T> &&A, BasicMatrix<T> &&B)
+{
+  return A.ref() == 1 ? std::move(A) + B : A + std::move(B);
+}
+
+template<class T, class R, class = std::enable_if_t<is_matrix_operand_v<R>>>
+BasicMatrix<T> operator-(BasicMatrix<T> &&A, const R &B)
+{
+  if(A.ref() != 1)
+    return A - B;
+  check_shape(A, B);
+  A -= B;
+  return std::move(A);
+}
+
+template<class T, class L, class = std::enable_if_t<is_matrix_operand_v<L>>>
+BasicMatrix<T> operator-(const L &A, BasicMatrix<T> &&B)
+{
+  if(B.ref() != 1)
+    return A - B;
+  if constexpr(is_matrix_expr_v<L>)
+    A.template apply_to<ExprRsub>(B);
+  else
+    MatrixLeaf<T>(A).template apply_to<ExprRsub>(B);
+  return std::move(B);
+}
+
+template<class T>
+BasicMatrix<T> operator-(BasicMatrix<T> &&A, BasicMatrix<T> &&B)
+{
+  return A.ref() == 1 ? std::move(A) - B : A - std::move(B);
+}
+
+template<class T>
+BasicMatrix<T> operator*(BasicMatrix<T> &&A, typename BasicMatrix<T>::value_type k)
+{
+  if(A.ref() != 1)
+    return A * k;
+  A *= k;
+  return std::move(A);
+}
+
+template<class T>
+BasicMatrix<T> operator*(typename BasicMatrix<T>::value_type k, BasicMatrix<T> &&A)
+{
+  return std::move(A) * k;
+}
+
+template<class T>
+BasicMatrix<T> operator/(BasicMatrix<T> &&A, typename BasicMatrix<T>::value_type k)
+{
+  if(A.ref() != 1)
+    return A / k;
+  A /= k;
+  return std::move(A);
+}
@@ -0,0 +1,499 @@
+#include "Gemm.h"
+#include "Cpu.h"
+#include "ThreadPool.h"
+#include "Kernel.h"
+#include <cstdlib>
+#include <algorithm>
+#include <complex>
+#include <type_traits>
+#include <new>
+#include <unistd.h>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// 微内核：ab = a * b
+// a 为打包后的 mr 行 k 列面板（列优先），b 为打包后的 k 行 nr 列面板（行优先）
+// ab 为 mr 行 nr 列结果（列优先）
+template<class T>
+using MicroKernel = void (*)(size_t k, const T *a, const T *b, T *ab);
+
+constexpr size_t tile_max = 32 * 12;  // 最大微内核尺寸（元素数）
+
+template<class T>
+void kernel_generic(size_t k, const T *a, const T *b, T *ab)
+{
+  T c[4][4] = { };
+  for(; k; --k)
+  {
+    for(size_t j = 0; j < 4; ++j)
+      for(size_t i = 0; i < 4; ++i)
+        c[j][i] += a[i] * b[j];
+    a += 4;
+    b += 4;
+  }
+  for(size_t j = 0; j < 4; ++j)
+    for(size_t i = 0; i < 4; ++i)
+      ab[j * 4 + i] = c[j][i];
+}
+
+#if defined(__x86_64__)
+
+// 累加器须为具名变量，数组形式会被编译器逐次写回栈上
+#define GEMM_FMA_COLUMN(V, FMA, SET1, x, j) \
+  { V bj = SET1(b[j]); c0##x = FMA(a0, bj, c0##x); c1##x = FMA(a1, bj, c1##x); }
+#define GEMM_STORE_COLUMN(STORE, mr, w, x, j) \
+  { STORE(ab + j * mr, c0##x); STORE(ab + j * mr + w, c1##x); }
+
+__attribute__((target("avx2,fma")))
+void kernel_avx2(size_t k, const double *a, const double *b, double *ab)
+{
+  __m256d c00, c01, c02, c03, c04, c05;
+  __m256d c10, c11, c12, c13, c14, c15;
+  c00 = c01 = c02 = c03 = c04 = c05 = _mm256_setzero_pd();
+  c10 = c11 = c12 = c13 = c14 = c15 = _mm256_setzero_pd();
+  for(; k; --k)
+  {
+    __m256d a0 = _mm256_loadu_pd(a);
+    __m256d a1 = _mm256_loadu_pd(a + 4);
+#define FMA(j) GEMM_FMA_COLUMN(__m256d, _mm256_fmadd_pd, _mm256_set1_pd, j, j)
+    FMA(0) FMA(1) FMA(2) FMA(3) FMA(4) FMA(5)
+#undef FMA
+    a += 8;
+    b += 6;
+  }
+#define STORE(j) GEMM_STORE_COLUMN(_mm256_storeu_pd, 8, 4, j, j)
+  STORE(0) STORE(1) STORE(2) STORE(3) STORE(4) STORE(5)
+#undef STORE
+}
+
+__attribute__((target("avx512f")))
+void kernel_avx512(size_t k, const double *a, const double *b, double *ab)
+{
+  __m512d c00, c01, c02, c03, c04, c05, c06, c07, c08, c09, c0a, c0b;
+  __m512d c10, c11, c12, c13, c14, c15, c16, c17, c18, c19, c1a, c1b;
+  c00 = c01 = c02 = c03 = c04 = c05 = _mm512_setzero_pd();
+  c06 = c07 = c08 = c09 = c0a = c0b = _mm512_setzero_pd();
+  c10 = c11 = c12 = c13 = c14 = c15 = _mm512_setzero_pd();
+  c16 = c17 = c18 = c19 = c1a = c1b = _mm512_setzero_pd();
+  for(; k; --k)
+  {
+    __m512d a0 = _mm512_loadu_pd(a);
+    __m512d a1 = _mm512_loadu_pd(a + 8);
+#define FMA(x, j) GEMM_FMA_COLUMN(__m512d, _mm512_fmadd_pd, _mm512_set1_pd, x, j)
+    FMA(0, 0) FMA(1, 1) FMA(2, 2) FMA(3, 3) FMA(4, 4) FMA(5, 5)
+    FMA(6, 6) FMA(7, 7) FMA(8, 8) FMA(9, 9) FMA(a, 10) FMA(b, 11)
+#undef FMA
+    a += 16;
+    b += 12;
+  }
+#define STORE(x, j) GEMM_STORE_COLUMN(_mm512_storeu_pd, 16, 8, x, j)
+  STORE(0, 0) STORE(1, 1) STORE(2, 2) STORE(3, 3) STORE(4, 4) STORE(5, 5)
+  STORE(6, 6) STORE(7, 7) STORE(8, 8) STORE(9, 9) STORE(a, 10) STORE(b, 11)
+#undef STORE
+}
+
+// float 微内核，向量宽度加倍，mr 随之加倍
+__attribute__((target("avx2,fma")))
+void kernel_avx2(size_t k, const float *a, const float *b, float *ab)
+{
+  __m256 c00, c01, c02, c03, c04, c05;
+  __m256 c10, c11, c12, c13, c14, c15;
+  c00 = c01 = c02 = c03 = c04 = c05 = _mm256_setzero_ps();
+  c10 = c11 = c12 = c13 = c14 = c15 = _mm256_setzero_ps();
+  for(; k; --k)
+  {
+    __m256 a0 = _mm256_loadu_ps(a);
+    __m256 a1 = _mm256_loadu_ps(a + 8);
+#define FMA(j) GEMM_FMA_COLUMN(__m256, _mm256_fmadd_ps, _mm256_set1_ps, j, j)
+    FMA(0) FMA(1) FMA(2) FMA(3) FMA(4) FMA(5)
+#undef FMA
+    a += 16;
+    b += 6;
+  }
+#define STORE(j) GEMM_STORE_COLUMN(_mm256_storeu_ps, 16, 8, j, j)
+  STORE(0) STORE(1) STORE(2) STORE(3) STORE(4) STORE(5)
+#undef STORE
+}
+
+__attribute__((target("avx512f")))
+void kernel_avx512(size_t k, const float *a, const float *b, float *ab)
+{
+  __m512 c00, c01, c02, c03, c04, c05, c06, c07, c08, c09, c0a, c0b;
+  __m512 c10, c11, c12, c13, c14, c15, c16, c17, c18, c19, c1a, c1b;
+  c00 = c01 = c02 = c03 = c04 = c05 = _mm512_setzero_ps();
+  c06 = c07 = c08 = c09 = c0a = c0b = _mm512_setzero_ps();
+  c10 = c11 = c12 = c13 = c14 = c15 = _mm512_setzero_ps();
+  c16 = c17 = c18 = c19 = c1a = c1b = _mm512_setzero_ps();
+  for(; k; --k)
+  {
+    __m512 a0 = _mm512_loadu_ps(a);
+    __m512 a1 = _mm512_loadu_ps(a + 16);
+#define FMA(x, j) GEMM_FMA_COLUMN(__m512, _mm512_fmadd_ps, _mm512_set1_ps, x, j)
+    FMA(0, 0) FMA(1, 1) FMA(2, 2) FMA(3, 3) FMA(4, 4) FMA(5, 5)
+    FMA(6, 6) FMA(7, 7) FMA(8, 8) FMA(9, 9) FMA(a, 10) FMA(b, 11)
+#undef FMA
+    a += 32;
+    b += 12;
+  }
+#define STORE(x, j) GEMM_STORE_COLUMN(_mm512_storeu_ps, 32, 16, x, j)
+  STORE(0, 0) STORE(1, 1) STORE(2, 2) STORE(3, 3) STORE(4, 4) STORE(5, 5)
+  STORE(6, 6) STORE(7, 7) STORE(8, 8) STORE(9, 9) STORE(a, 10) STORE(b, 11)
+#undef STORE
+}
+
+#endif  // __x86_64__
+
+size_t cache_size(int name, size_t fallback)
+{
+  long size = sysconf(name);
+  return size > 0 ? (size_t)size : fallback;
+}
+
+// 向下取整到 m 的倍数，且不小于 m
+size_t round_block(size_t n, size_t m)
+{
+  return std::max(n / m, (size_t)1) * m;
+}
+
+template<class T>
+struct Engine {
+  GemmBlocking blk;
+  MicroKernel<T> kernel;
+
+  Engine();
+};
+
+template<class T>
+Engine<T>::Engine()
+{
+  blk.mr = 4;
+  blk.nr = 4;
+  kernel = kernel_generic<T>;
+#if defined(__x86_64__)
+  if constexpr(std::is_same_v<T, double> || std::is_same_v<T, float>)
+  {
+    // 微内核的行数为两个向量的宽度
+    constexpr size_t lanes = 8 / sizeof(T);
+    Isa isa = cpu_isa();
+    if(isa >= Isa::avx512)
+    {
+      blk.mr = 16 * lanes;
+      blk.nr = 12;
+      kernel = kernel_avx512;
+    }
+    else if(isa >= Isa::avx2)
+    {
+      blk.mr = 8 * lanes;
+      blk.nr = 6;
+      kernel = kernel_avx2;
+    }
+  }
+#endif
+
+  // B 的微面板（kc x nr）占 L1 的一半
+  // A 的块（mc x kc）占 L2 的一半
+  // B 的块（kc x nc）占 L3 的一半
+  size_t l1 = cache_size(_SC_LEVEL1_DCACHE_SIZE, 32 << 10);
+  size_t l2 = cache_size(_SC_LEVEL2_CACHE_SIZE, 256 << 10);
+  size_t l3 = cache_size(_SC_LEVEL3_CACHE_SIZE, 8 << 20);
+  blk.kc = std::clamp(l1 / 2 / (blk.nr * sizeof(T)), (size_t)64, (size_t)512);
+  blk.kc = round_block(blk.kc, 8);
+  blk.mc = std::clamp(l2 / 2 / (blk.kc * sizeof(T)), (size_t)blk.mr, (size_t)1024);
+  blk.mc = round_block(blk.mc, blk.mr);
+  blk.nc = std::clamp(l3 / 2 / (blk.kc * sizeof(T)), (size_t)blk.nr, (size_t)4096);
+  blk.nc = round_block(blk.nc, blk.nr);
+}
+
+template<class T>
+const Engine<T> &engine()
+{
+  static const Engine<T> eng;
+  return eng;
+}
+
+// 线程私有的 64 字节对齐打包缓冲区，只增不减
+class PackBuffer {
+private:
+  void    *data = nullptr;
+  size_t  size = 0;   // 字节数
+
+public:
+  PackBuffer() = default;
+  ~PackBuffer() { free(data); }
+  PackBuffer(const PackBuffer &) = delete;
+  PackBuffer &operator=(const PackBuffer &) = delete;
+
+  template<class T>
+    T *get(size_t n)
+    {
+      size_t bytes = (n * sizeof(T) + 63) / 64 * 64;
+      if(bytes > size)
+      {
+        void *p = aligned_alloc(64, bytes);
+        if(!p)
+          throw std::bad_alloc();
+        free(data);
+        data = p;
+        size = bytes;
+      }
+      return (T *)data;
+    }
+};
+
+thread_local PackBuffer a_buffer;
+thread_local PackBuffer b_buffer;
+
+// 将 A 的 mb x kb 块打包为 mr 行一组的面板，不足处补零
+template<class T>
+void pack_A(size_t mb, size_t kb, const T *A, size_t sar, size_t sac,
+    size_t mr, T *Ap)
+{
+  for(size_t ir = 0; ir < mb; ir += mr, Ap += mr * kb, A += mr * sar)
+  {
+    size_t ib = std::min(mr, mb - ir);
+    if(sac == 1)
+    {
+      for(size_t i = 0; i < ib; ++i)
+      {
+        const T *a = A + i * sar;
+        for(size_t p = 0; p < kb; ++p)
+          Ap[p * mr + i] = a[p];
+      }
+    }
+    else for(size_t p = 0; p < kb; ++p)
+    {
+      const T *a = A + p * sac;
+      for(size_t i = 0; i < ib; ++i)
+        Ap[p * mr + i] = a[i * sar];
+    }
+    if(ib < mr) for(size_t p = 0; p < kb; ++p)
+      std::fill(Ap + p * mr + ib, Ap + p * mr + mr, 0);
+  }
+}
+
+// 将 B 的 kb x nb 块打包为 nr 列一组的面板，不足处补零
+template<class T>
+void pack_B(size_t kb, size_t nb, const T *B, size_t sbr, size_t sbc,
+    size_t nr, T *Bp)
+{
+  for(size_t jr = 0; jr < nb; jr += nr, Bp += nr * kb, B += nr * sbc)
+  {
+    size_t jb = std::min(nr, nb - jr);
+    if(sbr == 1)
+    {
+      for(size_t j = 0; j < jb; ++j)
+      {
+        const T *b = B + j * sbc;
+        for(size_t p = 0; p < kb; ++p)
+          Bp[p * nr + j] = b[p];
+      }
+    }
+    else for(size_t p = 0; p < kb; ++p)
+    {
+      const T *b = B + p * sbr;
+      for(size_t j = 0; j < jb; ++j)
+        Bp[p * nr + j] = b[j * sbc];
+    }
+    if(jb < nr) for(size_t p = 0; p < kb; ++p)
+      std::fill(Bp + p * nr + jb, Bp + p * nr + nr, 0);
+  }
+}
+
+// C = alpha * ab + beta * C，只写回有效的 mb x nb 部分
+template<class T>
+void store_tile(size_t mr, size_t mb, size_t nb, T alpha, const T *ab,
+    T beta, T *C, size_t scr, size_t scc)
+{
+  for(size_t j = 0; j < nb; ++j)
+  {
+    T *c = C + j * scc;
+    const T *t = ab + j * mr;
+    if(beta == T(0))
+      for(size_t i = 0; i < mb; ++i)
+        c[i * scr] = alpha * t[i];
+    else
+      for(size_t i = 0; i < mb; ++i)
+        c[i * scr] = alpha * t[i] + beta * c[i * scr];
+  }
+}
+
+// 对打包好的 A 块和 B 块遍历全部微块
+template<class T>
+void macro_kernel(const Engine<T> &eng, size_t mb, size_t nb, size_t kb,
+    T alpha, const T *Ap, const T *Bp,
+    T beta, T *C, size_t scr, size_t scc)
+{
+  size_t mr = eng.blk.mr, nr = eng.blk.nr;
+  alignas(64) T ab[tile_max];
+  for(size_t jr = 0; jr < nb; jr += nr)
+  {
+    size_t jb = std::min(nr, nb - jr);
+    for(size_t ir = 0; ir < mb; ir += mr)
+    {
+      size_t ib = std::min(mr, mb - ir);
+      eng.kernel(kb, Ap + ir * kb, Bp + jr * kb, ab);
+      store_tile(mr, ib, jb, alpha, ab, beta, C + ir * scr + jr * scc, scr, scc);
+    }
+  }
+}
+
+// C = beta * C
+template<class T>
+void scale_C(size_t m, size_t n, T beta, T *C, size_t scr, size_t scc)
+{
+  for(size_t i = 0; i < m; ++i)
+    for(size_t j = 0; j < n; ++j)
+    {
+      T &c = C[i * scr + j * scc];
+      c = beta == T(0) ? 0 : beta * c;
+    }
+}
+
+// 小矩阵直接求内积，避免打包开销
+template<class T>
+void gemm_small(size_t m, size_t n, size_t k, T alpha,
+    const T *A, size_t sar, size_t sac,
+    const T *B, size_t sbr, size_t sbc,
+    T beta, T *C, size_t scr, size_t scc)
+{
+  for(size_t i = 0; i < m; ++i)
+    for(size_t j = 0; j < n; ++j)
+    {
+      T c = 0;
+      for(size_t p = 0; p < k; ++p)
+        c += A[i * sar + p * sac] * B[p * sbr + j * sbc];
+      T &cij = C[i * scr + j * scc];
+      cij = beta == T(0) ? alpha * c : alpha * c + beta * cij;
+    }
+}
+
+// 窄矩阵乘积（矩阵乘向量等）逐个求内积或逐行累加，避免打包时补零的浪费
+template<class T>
+void gemm_thin(size_t m, size_t n, size_t k, T alpha,
+    const T *A, size_t sar, size_t sac,
+    const T *B, size_t sbr, size_t sbc,
+    T beta, T *C, size_t scr, size_t scc)
+{
+  const BasicElementKernels<T> &ek = element_kernels<T>();
+  if(n <= m)
+  {
+    for(size_t j = 0; j < n; ++j)
+      for(size_t i = 0; i < m; ++i)
+      {
+        T c = ek.dot(k, A + i * sar, sac, B + j * sbc, sbr);
+        T &cij = C[i * scr + j * scc];
+        cij = beta == T(0) ? alpha * c : alpha * c + beta * cij;
+      }
+  }
+  else for(size_t i = 0; i < m; ++i)
+  {
+    T *c = C + i * scr;
+    if(beta == T(0))
+      ek.fill(n, c, scc, 0);
+    else if(beta != T(1))
+      ek.mul(n, c, scc, beta);
+    for(size_t p = 0; p < k; ++p)
+      ek.axpy(n, c, scc, B + p * sbr, sbc, alpha * A[i * sar + p * sac]);
+  }
+}
+
+constexpr size_t thin_max = 4;                   // 窄矩阵乘积的最大行数或列数
+constexpr size_t small_max = 32 * 32 * 32;       // 直接求内积的最大乘加次数
+constexpr size_t parallel_min = 128 * 128 * 128;  // 多线程计算的最小乘加次数
+
+// 以 mc x nc 为宏块计算 C 的一个子块，打包缓冲区属于当前线程
+template<class T>
+void gemm_blocked(const Engine<T> &eng, size_t mc, size_t nc,
+    size_t m, size_t n, size_t k, T alpha,
+    const T *A, size_t sar, size_t sac,
+    const T *B, size_t sbr, size_t sbc,
+    T beta, T *C, size_t scr, size_t scc)
+{
+  const GemmBlocking &blk = eng.blk;
+  T *Ap = a_buffer.get<T>(mc * blk.kc);
+  T *Bp = b_buffer.get<T>(blk.kc * round_block(std::min(n, nc) + blk.nr - 1, blk.nr));
+
+  for(size_t jc = 0; jc < n; jc += nc)
+  {
+    size_t nb = std::min(nc, n - jc);
+    for(size_t pc = 0; pc < k; pc += blk.kc)
+    {
+      size_t kb = std::min(blk.kc, k - pc);
+      pack_B(kb, nb, B + pc * sbr + jc * sbc, sbr, sbc, blk.nr, Bp);
+      T beta_pc = pc ? 1 : beta;
+      for(size_t ic = 0; ic < m; ic += mc)
+      {
+        size_t mb = std::min(mc, m - ic);
+        pack_A(mb, kb, A + ic * sar + pc * sac, sar, sac, blk.mr, Ap);
+        macro_kernel(eng, mb, nb, kb, alpha, Ap, Bp, beta_pc,
+            C + ic * scr + jc * scc, scr, scc);
+      }
+    }
+  }
+}
+
+}  // namespace
+
+template<class T>
+const GemmBlocking &gemm_blocking()
+{
+  return engine<T>().blk;
+}
+
+template<class T>
+void gemm_engine(size_t m, size_t n, size_t k, scalar_t<T> alpha,
+    const T *A, size_t sar, size_t sac,
+    const T *B, size_t sbr, size_t sbc,
+    scalar_t<T> beta, T *C, size_t scr, size_t scc)
+{
+  if(!m || !n)
+    return;
+  if(!k || alpha == T(0))
+    return scale_C(m, n, beta, C, scr, scc);
+  if(m * n * k <= small_max)
+    return gemm_small(m, n, k, alpha, A, sar, sac, B, sbr, sbc, beta, C, scr, scc);
+  if(std::min(m, n) <= thin_max)
+    return gemm_thin(m, n, k, alpha, A, sar, sac, B, sbr, sbc, beta, C, scr, scc);
+
+  const Engine<T> &eng = engine<T>();
+  const GemmBlocking &blk = eng.blk;
+  size_t nt = num_threads();
+  if(nt == 1 || m * n * k < parallel_min)
+    return gemm_blocked(eng, blk.mc, blk.nc, m, n, k, alpha,
+        A, sar, sac, B, sbr, sbc, beta, C, scr, scc);
+
+  // 将 C 划分为互不相交的宏块，块数不少于线程数的 4 倍，以便窃取时负载均衡
+  // 每个宏块由执行它的线程独立打包，缓冲区由该线程首次写入，
+  // 按首次访问策略分配在该线程所在的 NUMA 节点上
+  size_t mc = blk.mc, nc = blk.nc;
+  auto tiles = [&] { return ((m + mc - 1) / mc) * ((n + nc - 1) / nc); };
+  while(tiles() < 4 * nt)
+  {
+    if(nc > 4 * blk.nr && nc >= mc)
+      nc = round_block(nc / 2, blk.nr);
+    else if(mc > 4 * blk.mr)
+      mc = round_block(mc / 2, blk.mr);
+    else
+      break;
+  }
+  size_t ntile = (n + nc - 1) / nc;
+  parallel_for(tiles(), [&](size_t t) {
+    size_t ic = t / ntile * mc, jc = t % ntile * nc;
+    gemm_blocked(eng, mc, nc, std::min(mc, m - ic), std::min(nc, n - jc), k, alpha,
+        A + ic * sar, sar, sac, B + jc * sbc, sbr, sbc,
+        beta, C + ic * scr + jc * scc, scr, scc);
+  });
+}
+
+#define GEMM_INSTANTIATE(T) \
+  template const GemmBlocking &gemm_blocking<T>(); \
+  template void gemm_engine<T>(size_t, size_t, size_t, T, const T *, size_t, size_t, \
+      const T *, size_t, size_t, T, T *, size_t, size_t);
+
+GEMM_INSTANTIATE(float)
+GEMM_INSTANTIATE(double)
+GEMM_INSTANTIATE(long double)
+GEMM_INSTANTIATE(std::complex<double>)
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Basic.h"
+
+// 分块矩阵乘法引擎：C = alpha * A * B + beta * C
+// A 为 m 行 k 列，B 为 k 行 n 列，C 为 m 行 n 列
+// 各矩阵以首元素地址、行跳步和列跳步描述，可为任意转置或切片视图
+// beta 为 0 时不读取 C 的原值；C 不得与 A 或 B 重叠
+// 规模足够大时将 C 分块交给线程池并行计算，线程数见 num_threads()
+// double 和 float 有各指令集的微内核，long double 和复数使用标量微内核
+// 打包缓冲区分配失败时抛 bad_alloc
+template<class T>
+void gemm_engine(size_t m, size_t n, size_t k, scalar_t<T> alpha,
+    const T *A, size_t sar, size_t sac,
+    const T *B, size_t sbr, size_t sbc,
+    scalar_t<T> beta, T *C, size_t scr, size_t scc);
+
+// 分块参数
+struct GemmBlocking {
+  size_t mr, nr;  // 寄存器分块（微内核尺寸）
+  size_t mc;      // A 块行数，按 L2 缓存确定
+  size_t kc;      // 打包深度，按 L1 缓存确定
+  size_t nc;      // B 块列数，按 L3 缓存确定
+};
+
+// 根据当前指令集和缓存大小选定的分块参数
+template<class T = Number>
+const GemmBlocking &gemm_blocking();
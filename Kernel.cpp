@@ -0,0 +1,359 @@
+#include "Kernel.h"
+#include <algorithm>
+#include <utility>
+#include <complex>
+#include <type_traits>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace generic {
+
+template<class Elem>
+struct Scalar {
+  typedef Elem E;
+  typedef Elem T;
+  static constexpr size_t width = 1;
+  static constexpr bool gather = false;
+  static T load(const E *p) { return *p; }
+  static void store(E *p, T v) { *p = v; }
+  static T load_strided(const E *p, size_t) { return *p; }
+  static T set1(E k) { return k; }
+  static T add(T a, T b) { return a + b; }
+  static T sub(T a, T b) { return a - b; }
+  static T mul(T a, T b) { return a * b; }
+  static T div(T a, T b) { return a / b; }
+  static T neg(T a) { return -a; }
+  static E sum(T a) { return a; }
+};
+
+namespace f32 {
+typedef Scalar<float> V;
+#include "Kernel.inl"
+}  // namespace f32
+
+namespace f64 {
+typedef Scalar<double> V;
+#include "Kernel.inl"
+}  // namespace f64
+
+namespace f80 {
+typedef Scalar<long double> V;
+#include "Kernel.inl"
+}  // namespace f80
+
+namespace c128 {
+typedef Scalar<std::complex<double>> V;
+#include "Kernel.inl"
+}  // namespace c128
+
+}  // namespace generic
+
+#if defined(__x86_64__)
+
+#pragma GCC push_options
+#pragma GCC target("sse2")
+
+namespace sse2 {
+
+namespace f64 {
+
+struct V {
+  typedef double E;
+  typedef __m128d T;
+  static constexpr size_t width = 2;
+  static constexpr bool gather = false;
+  static T load(const E *p) { return _mm_loadu_pd(p); }
+  static void store(E *p, T v) { _mm_storeu_pd(p, v); }
+  static T load_strided(const E *p, size_t s) { return _mm_set_pd(p[s], p[0]); }
+  static T set1(E k) { return _mm_set1_pd(k); }
+  static T add(T a, T b) { return _mm_add_pd(a, b); }
+  static T sub(T a, T b) { return _mm_sub_pd(a, b); }
+  static T mul(T a, T b) { return _mm_mul_pd(a, b); }
+  static T div(T a, T b) { return _mm_div_pd(a, b); }
+  static T neg(T a) { return _mm_xor_pd(a, _mm_set1_pd(-0.0)); }
+  static E sum(T a) { return _mm_cvtsd_f64(_mm_add_sd(a, _mm_unpackhi_pd(a, a))); }
+};
+
+#include "Kernel.inl"
+
+}  // namespace f64
+
+namespace f32 {
+
+struct V {
+  typedef float E;
+  typedef __m128 T;
+  static constexpr size_t width = 4;
+  static constexpr bool gather = false;
+  static T load(const E *p) { return _mm_loadu_ps(p); }
+  static void store(E *p, T v) { _mm_storeu_ps(p, v); }
+  static T load_strided(const E *p, size_t s)
+  {
+    return _mm_set_ps(p[3 * s], p[2 * s], p[s], p[0]);
+  }
+  static T set1(E k) { return _mm_set1_ps(k); }
+  static T add(T a, T b) { return _mm_add_ps(a, b); }
+  static T sub(T a, T b) { return _mm_sub_ps(a, b); }
+  static T mul(T a, T b) { return _mm_mul_ps(a, b); }
+  static T div(T a, T b) { return _mm_div_ps(a, b); }
+  static T neg(T a) { return _mm_xor_ps(a, _mm_set1_ps(-0.0f)); }
+  static E sum(T a)
+  {
+    __m128 h = _mm_add_ps(a, _mm_movehl_ps(a, a));
+    return _mm_cvtss_f32(_mm_add_ss(h, _mm_shuffle_ps(h, h, 1)));
+  }
+};
+
+#include "Kernel.inl"
+
+}  // namespace f32
+
+}  // namespace sse2
+
+#pragma GCC pop_options
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+
+namespace avx2 {
+
+namespace f64 {
+
+struct V {
+  typedef double E;
+  typedef __m256d T;
+  static constexpr size_t width = 4;
+  static constexpr bool gather = true;
+  static T load(const E *p) { return _mm256_loadu_pd(p); }
+  static void store(E *p, T v) { _mm256_storeu_pd(p, v); }
+  static T load_strided(const E *p, size_t s)
+  {
+    __m256i idx = _mm256_set_epi64x(3 * s, 2 * s, s, 0);
+    return _mm256_i64gather_pd(p, idx, sizeof(E));
+  }
+  static T set1(E k) { return _mm256_set1_pd(k); }
+  static T add(T a, T b) { return _mm256_add_pd(a, b); }
+  static T sub(T a, T b) { return _mm256_sub_pd(a, b); }
+  static T mul(T a, T b) { return _mm256_mul_pd(a, b); }
+  static T div(T a, T b) { return _mm256_div_pd(a, b); }
+  static T neg(T a) { return _mm256_xor_pd(a, _mm256_set1_pd(-0.0)); }
+  static E sum(T a)
+  {
+    __m128d h = _mm_add_pd(_mm256_castpd256_pd128(a), _mm256_extractf128_pd(a, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(h, _mm_unpackhi_pd(h, h)));
+  }
+};
+
+#include "Kernel.inl"
+
+}  // namespace f64
+
+namespace f32 {
+
+struct V {
+  typedef float E;
+  typedef __m256 T;
+  static constexpr size_t width = 8;
+  static constexpr bool gather = true;
+  static T load(const E *p) { return _mm256_loadu_ps(p); }
+  static void store(E *p, T v) { _mm256_storeu_ps(p, v); }
+  // 64 位下标，跳步不受 32 位下标范围限制
+  static T load_strided(const E *p, size_t s)
+  {
+    __m256i idx = _mm256_set_epi64x(3 * s, 2 * s, s, 0);
+    __m128 lo = _mm256_i64gather_ps(p, idx, sizeof(E));
+    __m128 hi = _mm256_i64gather_ps(p + 4 * s, idx, sizeof(E));
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+  }
+  static T set1(E k) { return _mm256_set1_ps(k); }
+  static T add(T a, T b) { return _mm256_add_ps(a, b); }
+  static T sub(T a, T b) { return _mm256_sub_ps(a, b); }
+  static T mul(T a, T b) { return _mm256_mul_ps(a, b); }
+  static T div(T a, T b) { return _mm256_div_ps(a, b); }
+  static T neg(T a) { return _mm256_xor_ps(a, _mm256_set1_ps(-0.0f)); }
+  static E sum(T a)
+  {
+    __m128 h = _mm_add_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+    h = _mm_add_ps(h, _mm_movehl_ps(h, h));
+    return _mm_cvtss_f32(_mm_add_ss(h, _mm_shuffle_ps(h, h, 1)));
+  }
+};
+
+#include "Kernel.inl"
+
+}  // namespace f32
+
+}  // namespace avx2
+
+#pragma GCC pop_options
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+
+namespace avx512 {
+
+namespace f64 {
+
+struct V {
+  typedef double E;
+  typedef __m512d T;
+  static constexpr size_t width = 8;
+  static constexpr bool gather = true;
+  static T load(const E *p) { return _mm512_loadu_pd(p); }
+  static void store(E *p, T v) { _mm512_storeu_pd(p, v); }
+  static T load_strided(const E *p, size_t s)
+  {
+    __m512i idx = _mm512_set_epi64(7 * s, 6 * s, 5 * s, 4 * s, 3 * s, 2 * s, s, 0);
+    return _mm512_mask_i64gather_pd(_mm512_setzero_pd(), 0xff, idx, p, sizeof(E));
+  }
+  static T set1(E k) { return _mm512_set1_pd(k); }
+  static T add(T a, T b) { return _mm512_add_pd(a, b); }
+  static T sub(T a, T b) { return _mm512_sub_pd(a, b); }
+  static T mul(T a, T b) { return _mm512_mul_pd(a, b); }
+  static T div(T a, T b) { return _mm512_div_pd(a, b); }
+  static T neg(T a)
+  {
+    __m512i sign = _mm512_castpd_si512(_mm512_set1_pd(-0.0));
+    return _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(a), sign));
+  }
+  static E sum(T a)
+  {
+    alignas(64) E t[width];
+    _mm512_store_pd(t, a);
+    return ((t[0] + t[4]) + (t[1] + t[5])) + ((t[2] + t[6]) + (t[3] + t[7]));
+  }
+};
+
+#include "Kernel.inl"
+
+}  // namespace f64
+
+namespace f32 {
+
+struct V {
+  typedef float E;
+  typedef __m512 T;
+  static constexpr size_t width = 16;
+  static constexpr bool gather = true;
+  static T load(const E *p) { return _mm512_loadu_ps(p); }
+  static void store(E *p, T v) { _mm512_storeu_ps(p, v); }
+  static T load_strided(const E *p, size_t s)
+  {
+    __m512i idx = _mm512_set_epi64(7 * s, 6 * s, 5 * s, 4 * s, 3 * s, 2 * s, s, 0);
+    __m256 lo = _mm512_mask_i64gather_ps(_mm256_setzero_ps(), 0xff, idx, p, sizeof(E));
+    __m256 hi = _mm512_mask_i64gather_ps(_mm256_setzero_ps(), 0xff, idx, p + 8 * s, sizeof(E));
+    // 两半经由内存拼接，GCC 12 的插入指令封装会误报未初始化
+    alignas(64) E t[width];
+    _mm256_store_ps(t, lo);
+    _mm256_store_ps(t + 8, hi);
+    return _mm512_load_ps(t);
+  }
+  static T set1(E k) { return _mm512_set1_ps(k); }
+  static T add(T a, T b) { return _mm512_add_ps(a, b); }
+  static T sub(T a, T b) { return _mm512_sub_ps(a, b); }
+  static T mul(T a, T b) { return _mm512_mul_ps(a, b); }
+  static T div(T a, T b) { return _mm512_div_ps(a, b); }
+  static T neg(T a)
+  {
+    __m512i sign = _mm512_castps_si512(_mm512_set1_ps(-0.0f));
+    return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(a), sign));
+  }
+  static E sum(T a)
+  {
+    alignas(64) E t[width];
+    _mm512_store_ps(t, a);
+    E s[4];
+    for(size_t i = 0; i < 4; ++i)
+      s[i] = (t[i] + t[i + 8]) + (t[i + 4] + t[i + 12]);
+    return (s[0] + s[2]) + (s[1] + s[3]);
+  }
+};
+
+#include "Kernel.inl"
+
+}  // namespace f32
+
+}  // namespace avx512
+
+#pragma GCC pop_options
+
+#endif  // __x86_64__
+
+namespace {
+
+// 各元素类型的内核表，向量实现按指令集选取
+template<class T> struct Tables;
+
+template<> struct Tables<double> {
+  static const BasicElementKernels<double> &get(Isa isa)
+  {
+#if defined(__x86_64__)
+    switch(isa)
+    {
+    case Isa::avx512:
+      return avx512::f64::table;
+    case Isa::avx2:
+      return avx2::f64::table;
+    case Isa::sse2:
+      return sse2::f64::table;
+    default:
+      break;
+    }
+#endif
+    return generic::f64::table;
+  }
+};
+
+template<> struct Tables<float> {
+  static const BasicElementKernels<float> &get(Isa isa)
+  {
+#if defined(__x86_64__)
+    switch(isa)
+    {
+    case Isa::avx512:
+      return avx512::f32::table;
+    case Isa::avx2:
+      return avx2::f32::table;
+    case Isa::sse2:
+      return sse2::f32::table;
+    default:
+      break;
+    }
+#endif
+    return generic::f32::table;
+  }
+};
+
+template<> struct Tables<long double> {
+  static const BasicElementKernels<long double> &get(Isa) { return generic::f80::table; }
+};
+
+template<> struct Tables<std::complex<double>> {
+  static const BasicElementKernels<std::complex<double>> &get(Isa)
+  {
+    return generic::c128::table;
+  }
+};
+
+}  // namespace
+
+template<class T>
+const BasicElementKernels<T> &element_kernels(Isa isa)
+{
+  return Tables<T>::get(std::min(isa, cpu_isa()));
+}
+
+template<class T>
+const BasicElementKernels<T> &element_kernels()
+{
+  static const BasicElementKernels<T> &table = element_kernels<T>(cpu_isa());
+  return table;
+}
+
+template const BasicElementKernels<float> &element_kernels<float>(Isa);
+template const BasicElementKernels<double> &element_kernels<double>(Isa);
+template const BasicElementKernels<long double> &element_kernels<long double>(Isa);
+template const BasicElementKernels<std::complex<double>> &element_kernels<std::complex<double>>(Isa);
+template const BasicElementKernels<float> &element_kernels<float>();
+template const BasicElementKernels<double> &element_kernels<double>();
+template const BasicElementKernels<long double> &element_kernels<long double>();
+template const BasicElementKernels<std::complex<double>> &element_kernels<std::complex<double>>();
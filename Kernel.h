@@ -0,0 +1,79 @@
+#pragma once
+
+#include "Basic.h"
+#include "Cpu.h"
+
+// 逐元素运算内核，n 为元素个数，sy 和 sx 为以元素计的跳步
+// 跳步为 1 时走向量路径，否则走 gather 或标量路径
+// double 和 float 有各指令集的向量实现，long double 和复数只有标量实现
+template<class T>
+struct BasicElementKernels {
+  // y = x
+  void (*assign)(size_t n, T *y, size_t sy, const T *x, size_t sx);
+  // y = -x
+  void (*negate)(size_t n, T *y, size_t sy, const T *x, size_t sx);
+  // y += x
+  void (*add)(size_t n, T *y, size_t sy, const T *x, size_t sx);
+  // y -= x
+  void (*sub)(size_t n, T *y, size_t sy, const T *x, size_t sx);
+  // y = k
+  void (*fill)(size_t n, T *y, size_t sy, T k);
+  // y *= k
+  void (*mul)(size_t n, T *y, size_t sy, T k);
+  // y /= k
+  void (*div)(size_t n, T *y, size_t sy, T k);
+  // y += a * x
+  void (*axpy)(size_t n, T *y, size_t sy, const T *x, size_t sx, T a);
+  // x 与 y 的内积（复数不取共轭），累加顺序与逐项相加不同
+  T (*dot)(size_t n, const T *x, size_t sx, const T *y, size_t sy);
+};
+
+typedef BasicElementKernels<Number> ElementKernels;
+
+// 按 cpu_isa() 选定的内核表
+template<class T = Number>
+const BasicElementKernels<T> &element_kernels();
+
+// 指定指令集的内核表，处理器不支持时退回较低等级
+template<class T = Number>
+const BasicElementKernels<T> &element_kernels(Isa);
+
+// 矩阵元在内存中整块连续
+template<class M>
+bool contiguous(const M &A)
+{
+  return A.sc() == 1 && (A.sr() == A.nc() || A.nr() <= 1);
+}
+
+// 沿 Y 的内存连续方向逐线调用 f(n, y, sy, x, sx)，X 与 Y 同形
+// 两者均整块连续时合并为一线
+template<class M, class F>
+void for_each_line(const M &Y, const M &X, F f)
+{
+  if(Y.empty())
+    return;
+  if(contiguous(Y) && contiguous(X))
+    f(Y.nr() * Y.nc(), Y.ptr(), 1, X.ptr(), 1);
+  else if(Y.sc() == 1 || Y.sr() != 1)
+    for(size_t i = 0; i < Y.nr(); ++i)
+      f(Y.nc(), Y.ptr() + i * Y.sr(), Y.sc(), X.ptr() + i * X.sr(), X.sc());
+  else
+    for(size_t j = 0; j < Y.nc(); ++j)
+      f(Y.nr(), Y.ptr() + j * Y.sc(), Y.sr(), X.ptr() + j * X.sc(), X.sr());
+}
+
+// 沿 Y 的内存连续方向逐线调用 f(n, y, sy, k)
+template<class M, class F>
+void for_each_line(const M &Y, typename M::value_type k, F f)
+{
+  if(Y.empty())
+    return;
+  if(contiguous(Y))
+    f(Y.nr() * Y.nc(), Y.ptr(), 1, k);
+  else if(Y.sc() == 1 || Y.sr() != 1)
+    for(size_t i = 0; i < Y.nr(); ++i)
+      f(Y.nc(), Y.ptr() + i * Y.sr(), Y.sc(), k);
+  else
+    for(size_t j = 0; j < Y.nc(); ++j)
+      f(Y.nr(), Y.ptr() + j * Y.sc(), Y.sr(), k);
+}
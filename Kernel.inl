@@ -0,0 +1,169 @@
+// 逐元素内核的公共实现，由 Kernel.cpp 在各指令集的 target 设置下分别包含
+// 包含前须在当前命名空间定义向量包装 V：
+//   E             元素类型
+//   T             向量类型
+//   width         每个向量的元素数
+//   gather        是否支持跳步读取
+//   load/store    非对齐读写
+//   load_strided  跳步读取（gather 为假时不被使用）
+//   set1/add/sub/mul/div/neg
+//   sum           各分量之和
+
+typedef V::E E;
+typedef V::T T;
+
+struct Assign {
+  static T vec(T, T x) { return x; }
+  static E one(E, E x) { return x; }
+};
+
+struct Negate {
+  static T vec(T, T x) { return V::neg(x); }
+  static E one(E, E x) { return -x; }
+};
+
+struct Add {
+  static T vec(T y, T x) { return V::add(y, x); }
+  static E one(E y, E x) { return y + x; }
+};
+
+struct Sub {
+  static T vec(T y, T x) { return V::sub(y, x); }
+  static E one(E y, E x) { return y - x; }
+};
+
+struct Fill {
+  static T vec(T, T k) { return k; }
+  static E one(E, E k) { return k; }
+};
+
+struct Mul {
+  static T vec(T y, T k) { return V::mul(y, k); }
+  static E one(E y, E k) { return y * k; }
+};
+
+struct Div {
+  static T vec(T y, T k) { return V::div(y, k); }
+  static E one(E y, E k) { return y / k; }
+};
+
+// y = Op(y, x)
+template<class Op>
+void binary(size_t n, E *y, size_t sy, const E *x, size_t sx)
+{
+  constexpr size_t w = V::width;
+  size_t i = 0;
+  if(sy == 1 && sx == 1)
+  {
+    for(; i + 2 * w <= n; i += 2 * w)
+    {
+      T y0 = Op::vec(V::load(y + i), V::load(x + i));
+      T y1 = Op::vec(V::load(y + i + w), V::load(x + i + w));
+      V::store(y + i, y0);
+      V::store(y + i + w, y1);
+    }
+    for(; i + w <= n; i += w)
+      V::store(y + i, Op::vec(V::load(y + i), V::load(x + i)));
+  }
+  else if(sy == 1)
+  {
+    if(V::gather)
+      for(; i + w <= n; i += w)
+        V::store(y + i, Op::vec(V::load(y + i), V::load_strided(x + i * sx, sx)));
+  }
+  for(; i < n; ++i)
+    y[i * sy] = Op::one(y[i * sy], x[i * sx]);
+}
+
+// y = Op(y, k)
+template<class Op>
+void scalar(size_t n, E *y, size_t sy, E k)
+{
+  constexpr size_t w = V::width;
+  size_t i = 0;
+  if(sy == 1)
+  {
+    T kv = V::set1(k);
+    for(; i + 2 * w <= n; i += 2 * w)
+    {
+      T y0 = Op::vec(V::load(y + i), kv);
+      T y1 = Op::vec(V::load(y + i + w), kv);
+      V::store(y + i, y0);
+      V::store(y + i + w, y1);
+    }
+    for(; i + w <= n; i += w)
+      V::store(y + i, Op::vec(V::load(y + i), kv));
+  }
+  for(; i < n; ++i)
+    y[i * sy] = Op::one(y[i * sy], k);
+}
+
+// y += a * x
+void axpy(size_t n, E *y, size_t sy, const E *x, size_t sx, E a)
+{
+  constexpr size_t w = V::width;
+  size_t i = 0;
+  T av = V::set1(a);
+  if(sy == 1 && sx == 1)
+  {
+    for(; i + 2 * w <= n; i += 2 * w)
+    {
+      T y0 = V::add(V::load(y + i), V::mul(av, V::load(x + i)));
+      T y1 = V::add(V::load(y + i + w), V::mul(av, V::load(x + i + w)));
+      V::store(y + i, y0);
+      V::store(y + i + w, y1);
+    }
+    for(; i + w <= n; i += w)
+      V::store(y + i, V::add(V::load(y + i), V::mul(av, V::load(x + i))));
+  }
+  else if(sy == 1)
+  {
+    if(V::gather)
+      for(; i + w <= n; i += w)
+        V::store(y + i, V::add(V::load(y + i), V::mul(av, V::load_strided(x + i * sx, sx))));
+  }
+  for(; i < n; ++i)
+    y[i * sy] += a * x[i * sx];
+}
+
+// x 与 y 的内积
+E dot(size_t n, const E *x, size_t sx, const E *y, size_t sy)
+{
+  constexpr size_t w = V::width;
+  size_t i = 0;
+  T s0 = V::set1(0), s1 = V::set1(0);
+  if(sx == 1 && sy == 1)
+  {
+    for(; i + 2 * w <= n; i += 2 * w)
+    {
+      s0 = V::add(s0, V::mul(V::load(x + i), V::load(y + i)));
+      s1 = V::add(s1, V::mul(V::load(x + i + w), V::load(y + i + w)));
+    }
+  }
+  else if(V::gather && (sx == 1 || sy == 1))
+  {
+    if(sy == 1)
+    {
+      std::swap(x, y);
+      std::swap(sx, sy);
+    }
+    for(; i + w <= n; i += w)
+      s0 = V::add(s0, V::mul(V::load(x + i), V::load_strided(y + i * sy, sy)));
+  }
+  E s = V::sum(V::add(s0, s1));
+  for(; i < n; ++i)
+    s += x[i * sx] * y[i * sy];
+  return s;
+}
+
+const BasicElementKernels<E> table = {
+  binary<Assign>,
+  binary<Negate>,
+  binary<Add>,
+  binary<Sub>,
+  scalar<Fill>,
+  scalar<Mul>,
+  scalar<Div>,
+  axpy,
+  dot,
+};
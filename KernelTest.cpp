@@ -0,0 +1,142 @@
+#include "TestBasic.h"
+#include "Kernel.h"
+#include <vector>
+#include <cstdlib>
+#include <ctime>
+#include <complex>
+
+using namespace std;
+
+void test_cpu_isa();
+template<class T>
+void test_kernels(Isa);
+void test_kernels_repeat();
+
+int main()
+{
+  test_cpu_isa();
+  for(Isa isa : {Isa::generic, Isa::sse2, Isa::avx2, Isa::avx512})
+  {
+    test_kernels<double>(isa);
+    test_kernels<float>(isa);
+  }
+  test_kernels<long double>(Isa::generic);
+  test_kernels<complex<double>>(Isa::generic);
+  test_kernels_repeat();
+}
+
+void test_cpu_isa()
+{
+  cout << "Detected ISA: " << isa_name(cpu_isa()) << endl;
+  assert(&element_kernels() == &element_kernels(cpu_isa()));
+  TEST_PASSED;
+}
+
+template<class T>
+static const char *type_name()
+{
+  if constexpr(is_same_v<T, float>)
+    return "float";
+  else if constexpr(is_same_v<T, double>)
+    return "double";
+  else if constexpr(is_same_v<T, long double>)
+    return "long double";
+  else
+    return "complex<double>";
+}
+
+// 取整数值，复数的虚部取另一个整数，使各运算结果精确
+template<class T>
+static T sample(int range, int offset)
+{
+  if constexpr(is_same_v<T, complex<double>>)
+    return T(rand() % range + offset, rand() % range + offset);
+  else
+    return T(rand() % range + offset);
+}
+
+// 逐一比较内核与标量定义
+// float 的取值范围较小，保证内积的部分和可精确表示
+template<class T>
+void test_kernels(Isa isa)
+{
+  const BasicElementKernels<T> &k = element_kernels<T>(isa);
+  int range = sizeof(T) < 8 ? 100 : 1000;
+  srand(time(NULL));
+  for(size_t n : {0, 1, 2, 3, 7, 8, 9, 15, 16, 17, 31, 64, 100})
+  for(size_t sy : {1, 2, 5})
+  for(size_t sx : {1, 3})
+  {
+    vector<T> y(n * sy + 1), x(n * sx + 1), y0;
+    for(T &v : y)
+      v = sample<T>(range, -range / 2);
+    for(T &v : x)
+      v = sample<T>(range, 1);
+    y0 = y;
+
+    k.add(n, y.data(), sy, x.data(), sx);
+    for(size_t i = 0; i < n; ++i)
+      assert(y[i * sy] == y0[i * sy] + x[i * sx]);
+    k.sub(n, y.data(), sy, x.data(), sx);
+    assert(y == y0);
+
+    k.mul(n, y.data(), sy, 4);
+    for(size_t i = 0; i < n; ++i)
+      assert(y[i * sy] == y0[i * sy] * T(4));
+    k.div(n, y.data(), sy, 4);
+    assert(y == y0);
+
+    k.negate(n, y.data(), sy, x.data(), sx);
+    for(size_t i = 0; i < n; ++i)
+      assert(y[i * sy] == -x[i * sx]);
+    k.assign(n, y.data(), sy, x.data(), sx);
+    for(size_t i = 0; i < n; ++i)
+      assert(y[i * sy] == x[i * sx]);
+
+    k.axpy(n, y.data(), sy, x.data(), sx, -2);
+    for(size_t i = 0; i < n; ++i)
+      assert(y[i * sy] == x[i * sx] + T(-2) * x[i * sx]);
+
+    T d = 0;
+    for(size_t i = 0; i < n; ++i)
+      d += x[i * sx] * y0[i * sy];
+    assert(k.dot(n, x.data(), sx, y0.data(), sy) == d);
+    assert(k.dot(n, y0.data(), sy, x.data(), sx) == d);
+
+    k.fill(n, y.data(), sy, 7);
+    for(size_t i = 0; i < n * sy; ++i)
+      assert(y[i] == (i % sy ? y0[i] : T(7)));
+    assert(y.back() == y0.back());
+  }
+  cout << "Passed: " << __func__ << " (" << isa_name(isa) << ", " << type_name<T>() << ")" << endl;
+}
+
+void test_kernels_repeat()
+{
+  size_t n = 1 << 22;
+  vector<Number> y(n, 1), x(n, 2);
+  vector<float> yf(n, 1), xf(n, 2);
+  for(Isa isa : {Isa::generic, Isa::sse2, Isa::avx2, Isa::avx512})
+  {
+    const ElementKernels &k = element_kernels(isa);
+    clock_t start = clock();
+    for(int t = 0; t < 20; ++t)
+      k.add(n, y.data(), 1, x.data(), 1);
+    clock_t diff = clock() - start;
+    double seconds = (double)diff / CLOCKS_PER_SEC;
+    cout << "It took " << seconds << " s to add " << n
+         << " numbers 20 times with " << isa_name(isa) << " ("
+         << 20 * 3 * n * sizeof(Number) / seconds / 1e9 << " GB/s)." << endl;
+
+    const BasicElementKernels<float> &kf = element_kernels<float>(isa);
+    start = clock();
+    for(int t = 0; t < 20; ++t)
+      kf.add(n, yf.data(), 1, xf.data(), 1);
+    diff = clock() - start;
+    seconds = (double)diff / CLOCKS_PER_SEC;
+    cout << "It took " << seconds << " s to add " << n
+         << " floats 20 times with " << isa_name(isa) << " ("
+         << 20 * 3 * n * sizeof(float) / seconds / 1e9 << " GB/s)." << endl;
+  }
+  TEST_PASSED;
+}
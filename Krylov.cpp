@@ -0,0 +1,454 @@
+#include "Krylov.h"
+#include "Blas.h"
+#include "Kernel.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+
+LinearOperator::LinearOperator(const Matrix &A)
+  : n(A.nr()), f([A](const Matrix &x, const Matrix &y) { gemm(1, A, x, 0, y); })
+{
+  if(!A.square())
+    throw std::domain_error("non-square operator");
+}
+
+LinearOperator::LinearOperator(const SparseMatrix &A) : n(A.nr())
+{
+  if(!A.square())
+    throw std::domain_error("non-square operator");
+  if(A.layout() == SparseLayout::csr)
+    f = [&A](const Matrix &x, const Matrix &y) { spmm(1, A, x, 0, y); };
+  else
+  {
+    auto B = std::make_shared<const SparseMatrix>(A.to(SparseLayout::csr));
+    f = [B](const Matrix &x, const Matrix &y) { spmm(1, *B, x, 0, y); };
+  }
+}
+
+void Preconditioner::apply(const Matrix &r, const Matrix &z) const
+{
+  element_kernels().assign(r.nr(), z.ptr(), z.sr(), r.ptr(), r.sr());
+}
+
+namespace {
+
+// 按行压缩的副本，非方阵时抛 domain_error
+SparseMatrix square_csr(const SparseMatrix &A)
+{
+  if(!A.square())
+    throw std::domain_error("non-square preconditioner");
+  return A.to(SparseLayout::csr);
+}
+
+// 各行对角元在 csr 数组中的位置；对角元不在非零结构中或为零时抛 size_t 行号
+std::vector<size_t> find_diag(const SparseMatrix &A)
+{
+  std::vector<size_t> diag(A.nr());
+  const std::vector<size_t> &p = A.ptr(), &ix = A.idx();
+  for(size_t i = 0; i < A.nr(); ++i)
+  {
+    auto it = std::lower_bound(ix.begin() + p[i], ix.begin() + p[i + 1], i);
+    if(it == ix.begin() + p[i + 1] || *it != i || A.val()[it - ix.begin()] == 0)
+      throw i;
+    diag[i] = it - ix.begin();
+  }
+  return diag;
+}
+
+}  // namespace
+
+Jacobi::Jacobi(const SparseMatrix &A) : inv(A.nr())
+{
+  SparseMatrix S = square_csr(A);
+  std::vector<size_t> diag = find_diag(S);
+  for(size_t i = 0; i < inv.size(); ++i)
+    inv[i] = 1 / S.val()[diag[i]];
+}
+
+Jacobi::Jacobi(const Matrix &A) : inv(A.nr())
+{
+  if(!A.square())
+    throw std::domain_error("non-square preconditioner");
+  for(size_t i = 0; i < inv.size(); ++i)
+  {
+    if(A(i, i) == 0)
+      throw i;
+    inv[i] = 1 / A(i, i);
+  }
+}
+
+void Jacobi::apply(const Matrix &r, const Matrix &z) const
+{
+  const Number *x = r.ptr();
+  Number *y = z.ptr();
+  size_t sx = r.sr(), sy = z.sr();
+  for(size_t i = 0; i < inv.size(); ++i)
+    y[i * sy] = inv[i] * x[i * sx];
+}
+
+// 逐行消元（IKJ 次序），只更新 A 的非零结构中已有的位置
+ILU0::ILU0(const SparseMatrix &A) : lu(square_csr(A)), diag(find_diag(lu))
+{
+  size_t n = lu.nr();
+  const std::vector<size_t> &p = lu.ptr(), &ix = lu.idx();
+  std::vector<Number> &v = lu.val();
+  std::vector<size_t> pos(n, SIZE_MAX);  // 当前行各列在数组中的位置
+  for(size_t i = 0; i < n; ++i)
+  {
+    for(size_t k = p[i]; k < p[i + 1]; ++k)
+      pos[ix[k]] = k;
+    for(size_t k = p[i]; k < diag[i]; ++k)
+    {
+      size_t r = ix[k];
+      Number f = v[k] /= v[diag[r]];
+      for(size_t t = diag[r] + 1; t < p[r + 1]; ++t)
+        if(pos[ix[t]] != SIZE_MAX)
+          v[pos[ix[t]]] -= f * v[t];
+    }
+    for(size_t k = p[i]; k < p[i + 1]; ++k)
+      pos[ix[k]] = SIZE_MAX;
+    if(v[diag[i]] == 0)
+      throw i;
+  }
+}
+
+ILU0::ILU0(const Matrix &A) : ILU0(SparseMatrix(A))
+{
+}
+
+void ILU0::apply(const Matrix &r, const Matrix &z) const
+{
+  const size_t *p = lu.ptr().data(), *ix = lu.idx().data();
+  const Number *v = lu.val().data(), *x = r.ptr();
+  Number *y = z.ptr();
+  size_t n = lu.nr(), sx = r.sr(), sy = z.sr();
+  for(size_t i = 0; i < n; ++i)
+  {
+    Number s = x[i * sx];
+    for(size_t k = p[i]; k < diag[i]; ++k)
+      s -= v[k] * y[ix[k] * sy];
+    y[i * sy] = s;
+  }
+  for(size_t q = 0; q < n; ++q)
+  {
+    size_t i = n - 1 - q;
+    Number s = y[i * sy];
+    for(size_t k = diag[i] + 1; k < p[i + 1]; ++k)
+      s -= v[k] * y[ix[k] * sy];
+    y[i * sy] = s / v[diag[i]];
+  }
+}
+
+SSOR::SSOR(const SparseMatrix &A, Number w) : a(square_csr(A)), diag(find_diag(a)), omega(w)
+{
+  if(!(w > 0 && w < 2))
+    throw std::invalid_argument("SSOR omega out of (0, 2)");
+}
+
+SSOR::SSOR(const Matrix &A, Number w) : SSOR(SparseMatrix(A), w)
+{
+}
+
+// 前代 (D / omega + L) y = r，再回代 (D / omega + U) z = (D / omega) y，
+// 即 z_i = y_i - omega / d_i * sum(a_ik z_k, k > i)，最后乘以 (2 - omega) / omega
+void SSOR::apply(const Matrix &r, const Matrix &z) const
+{
+  const size_t *p = a.ptr().data(), *ix = a.idx().data();
+  const Number *v = a.val().data(), *x = r.ptr();
+  Number *y = z.ptr();
+  size_t n = a.nr(), sx = r.sr(), sy = z.sr();
+  for(size_t i = 0; i < n; ++i)
+  {
+    Number s = x[i * sx];
+    for(size_t k = p[i]; k < diag[i]; ++k)
+      s -= v[k] * y[ix[k] * sy];
+    y[i * sy] = s * omega / v[diag[i]];
+  }
+  for(size_t q = 0; q < n; ++q)
+  {
+    size_t i = n - 1 - q;
+    Number s = 0;
+    for(size_t k = diag[i] + 1; k < p[i + 1]; ++k)
+      s += v[k] * y[ix[k] * sy];
+    y[i * sy] -= s * omega / v[diag[i]];
+  }
+  element_kernels().mul(n, y, sy, (2 - omega) / omega);
+}
+
+namespace {
+
+// n 行 1 列向量的运算，直接调用逐元素内核
+struct Vectors {
+  const ElementKernels &ek = element_kernels();
+  size_t n;
+
+  explicit Vectors(size_t order) : n(order) { }
+
+  Number dot(const Matrix &x, const Matrix &y) const
+  {
+    return ek.dot(n, x.ptr(), x.sr(), y.ptr(), y.sr());
+  }
+  Number norm(const Matrix &x) const
+  {
+    return std::sqrt(dot(x, x));
+  }
+  // y = x
+  void assign(const Matrix &y, const Matrix &x) const
+  {
+    ek.assign(n, y.ptr(), y.sr(), x.ptr(), x.sr());
+  }
+  // y += a * x
+  void axpy(const Matrix &y, Number a, const Matrix &x) const
+  {
+    ek.axpy(n, y.ptr(), y.sr(), x.ptr(), x.sr(), a);
+  }
+  // y *= a
+  void scale(const Matrix &y, Number a) const
+  {
+    ek.mul(n, y.ptr(), y.sr(), a);
+  }
+  // y = x + a * y
+  void xpay(const Matrix &y, Number a, const Matrix &x) const
+  {
+    ek.mul(n, y.ptr(), y.sr(), a);
+    ek.add(n, y.ptr(), y.sr(), x.ptr(), x.sr());
+  }
+  void fill(const Matrix &y, Number k) const
+  {
+    ek.fill(n, y.ptr(), y.sr(), k);
+  }
+};
+
+// 工作向量：k 行 n 列矩阵的各行转置为连续的列向量
+struct Workspace {
+  Matrix W;
+
+  Workspace(size_t k, size_t n) : W(k, n) { }
+  Matrix operator[](size_t t) const { return W.row(t).t(); }
+};
+
+void check_shapes(const LinearOperator &A, const Matrix &b, const Matrix &x)
+{
+  if(b.nc() != 1 || x.nc() != 1 || b.nr() != A.size() || x.nr() != A.size())
+    throw std::domain_error("inconsistent shapes");
+}
+
+// 记录一次迭代，退回是否应当停止
+bool report(const KrylovOptions &opt, KrylovResult &res, Number residual)
+{
+  ++res.iterations;
+  res.residual = residual;
+  res.converged = residual <= opt.tol;
+  if(opt.callback && !opt.callback(res.iterations, residual))
+    return true;
+  return res.converged;
+}
+
+// b 为零时解为零，无需迭代
+bool zero_rhs(const Vectors &vec, const Matrix &x, Number nb, KrylovResult &res)
+{
+  if(nb != 0)
+    return false;
+  vec.fill(x, 0);
+  res = { 0, 0, true };
+  return true;
+}
+
+}  // namespace
+
+KrylovResult cg(const LinearOperator &A, const Matrix &b, const Matrix &x,
+    const Preconditioner &M, const KrylovOptions &opt)
+{
+  check_shapes(A, b, x);
+  Vectors vec(A.size());
+  KrylovResult res = { 0, 0, false };
+  Number nb = vec.norm(b);
+  if(zero_rhs(vec, x, nb, res))
+    return res;
+
+  Workspace ws(4, A.size());
+  Matrix r = ws[0], z = ws[1], p = ws[2], q = ws[3];
+  A(x, r);
+  vec.xpay(r, -1, b);
+  res.residual = vec.norm(r) / nb;
+  if((res.converged = res.residual <= opt.tol))
+    return res;
+  M.apply(r, z);
+  vec.assign(p, z);
+  Number rz = vec.dot(r, z);
+  if(rz == 0)
+    return res;
+
+  while(res.iterations < opt.max_iter)
+  {
+    A(p, q);
+    Number pq = vec.dot(p, q);
+    if(pq == 0)
+      break;
+    Number alpha = rz / pq;
+    vec.axpy(x, alpha, p);
+    vec.axpy(r, -alpha, q);
+    if(report(opt, res, vec.norm(r) / nb))
+      break;
+    M.apply(r, z);
+    Number rz1 = vec.dot(r, z);
+    vec.xpay(p, rz1 / rz, z);
+    rz = rz1;
+  }
+  return res;
+}
+
+KrylovResult bicgstab(const LinearOperator &A, const Matrix &b, const Matrix &x,
+    const Preconditioner &M, const KrylovOptions &opt)
+{
+  check_shapes(A, b, x);
+  Vectors vec(A.size());
+  KrylovResult res = { 0, 0, false };
+  Number nb = vec.norm(b);
+  if(zero_rhs(vec, x, nb, res))
+    return res;
+
+  Workspace ws(7, A.size());
+  Matrix r = ws[0], rh = ws[1], p = ws[2], v = ws[3], y = ws[4], z = ws[5], t = ws[6];
+  A(x, r);
+  vec.xpay(r, -1, b);
+  res.residual = vec.norm(r) / nb;
+  if((res.converged = res.residual <= opt.tol))
+    return res;
+  vec.assign(rh, r);
+  vec.fill(p, 0);
+  vec.fill(v, 0);
+  Number rho = 1, alpha = 1, omega = 1;
+
+  while(res.iterations < opt.max_iter)
+  {
+    Number rho1 = vec.dot(rh, r);
+    if(rho1 == 0 || omega == 0)
+      break;
+    // p = r + beta (p - omega v)
+    vec.axpy(p, -omega, v);
+    vec.xpay(p, rho1 / rho * alpha / omega, r);
+    rho = rho1;
+    M.apply(p, y);
+    A(y, v);
+    Number rv = vec.dot(rh, v);
+    if(rv == 0)
+      break;
+    alpha = rho / rv;
+
+    // s = r - alpha v 存于 r
+    vec.axpy(r, -alpha, v);
+    vec.axpy(x, alpha, y);
+    Number ns = vec.norm(r) / nb;
+    if(ns <= opt.tol)
+    {
+      report(opt, res, ns);
+      break;
+    }
+
+    M.apply(r, z);
+    A(z, t);
+    Number tt = vec.dot(t, t);
+    omega = tt == 0 ? 0 : vec.dot(t, r) / tt;
+    vec.axpy(x, omega, z);
+    vec.axpy(r, -omega, t);
+    if(report(opt, res, vec.norm(r) / nb))
+      break;
+  }
+  return res;
+}
+
+// 每个周期内 Arnoldi 过程生成 A M^-1 的 Krylov 基 V，
+// 以 Givens 旋转把 Hessenberg 矩阵 H 化为上三角并递推残差 |g[j+1]|，
+// 周期结束时 x += M^-1 V y，其中 y 为 H y = g 的解
+KrylovResult gmres(const LinearOperator &A, const Matrix &b, const Matrix &x,
+    const Preconditioner &M, const KrylovOptions &opt)
+{
+  check_shapes(A, b, x);
+  Vectors vec(A.size());
+  KrylovResult res = { 0, 0, false };
+  Number nb = vec.norm(b);
+  if(zero_rhs(vec, x, nb, res))
+    return res;
+
+  size_t m = std::max<size_t>(1, std::min(opt.restart, A.size()));
+  Workspace ws(m + 2, A.size());
+  Matrix w = ws[m + 1];
+  Matrix H(m + 1, m);
+  std::vector<Number> cs(m), sn(m), g(m + 1);
+
+  for(;;)
+  {
+    Matrix v0 = ws[0];
+    A(x, v0);
+    vec.xpay(v0, -1, b);
+    Number beta = vec.norm(v0);
+    res.residual = beta / nb;
+    if((res.converged = res.residual <= opt.tol) || res.iterations >= opt.max_iter)
+      break;
+    vec.scale(v0, 1 / beta);
+    std::fill(g.begin(), g.end(), 0);
+    g[0] = beta;
+
+    size_t k = 0;
+    bool stop = false;
+    while(k < m && res.iterations < opt.max_iter && !stop)
+    {
+      M.apply(ws[k], w);
+      Matrix vk = ws[k + 1];
+      A(w, vk);
+      for(size_t i = 0; i <= k; ++i)
+      {
+        H(i, k) = vec.dot(ws[i], vk);
+        vec.axpy(vk, -H(i, k), ws[i]);
+      }
+      Number h = vec.norm(vk);
+      H(k + 1, k) = h;
+      if(h != 0)
+        vec.scale(vk, 1 / h);
+
+      for(size_t i = 0; i < k; ++i)
+      {
+        Number t = cs[i] * H(i, k) + sn[i] * H(i + 1, k);
+        H(i + 1, k) = -sn[i] * H(i, k) + cs[i] * H(i + 1, k);
+        H(i, k) = t;
+      }
+      Number d = std::hypot(H(k, k), H(k + 1, k));
+      if(d == 0)
+        break;
+      cs[k] = H(k, k) / d;
+      sn[k] = H(k + 1, k) / d;
+      H(k, k) = d;
+      H(k + 1, k) = 0;
+      g[k + 1] = -sn[k] * g[k];
+      g[k] *= cs[k];
+      ++k;
+      // h 为零时 Krylov 子空间已不变，解在其中精确
+      stop = report(opt, res, std::abs(g[k]) / nb) || h == 0;
+    }
+
+    // 回代 H y = g，y 存于 g，再累加 M^-1 V y
+    for(size_t q = 0; q < k; ++q)
+    {
+      size_t i = k - 1 - q;
+      for(size_t j = i + 1; j < k; ++j)
+        g[i] -= H(i, j) * g[j];
+      g[i] /= H(i, i);
+    }
+    vec.fill(w, 0);
+    for(size_t i = 0; i < k; ++i)
+      vec.axpy(w, g[i], ws[i]);
+    M.apply(w, v0);
+    vec.axpy(x, 1, v0);
+    if(stop || k == 0)
+    {
+      A(x, v0);
+      vec.xpay(v0, -1, b);
+      res.residual = vec.norm(v0) / nb;
+      res.converged = res.residual <= opt.tol;
+      break;
+    }
+  }
+  return res;
+}
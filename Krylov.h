@@ -0,0 +1,113 @@
+#pragma once
+
+#include "Basic.h"
+#include "Matrix.h"
+#include "Sparse.h"
+#include <functional>
+#include <vector>
+
+// Krylov 子空间迭代法求解 A x = b
+// A 只需提供矩阵向量乘积，x 与 b 为 n 行 1 列的矩阵（可以是跳步视图）
+// 工作向量在迭代开始前一次分配；由稀疏矩阵构造的算子和本文件的预条件
+// 在迭代中也不分配内存，多线程 SpMV 使用矩阵构造时确定的分段
+
+// 方阵线性算子 y = A x，可由稠密矩阵、稀疏矩阵或任意可调用对象隐式构造
+// 只保存对 A 的引用，A 须在算子使用期间有效；csc 稀疏矩阵例外，
+// 构造时转为 csr 副本保存，避免每次乘积分配并行归并的缓冲区
+class LinearOperator {
+private:
+  size_t  n;
+  std::function<void(const Matrix &x, const Matrix &y)>  f;
+
+public:
+  // A 非方阵时抛 domain_error
+  LinearOperator(const Matrix &A);
+  LinearOperator(const SparseMatrix &A);
+
+  // f(x, y) 将 A x 写入 y
+  template<class F>
+    LinearOperator(size_t order, F g) : n(order), f(std::move(g)) { }
+
+  size_t size() const { return n; }
+  void operator()(const Matrix &x, const Matrix &y) const { f(x, y); }
+};
+
+// 预条件 z = M^-1 r，基类即恒等预条件
+// z 与 r 不得重叠
+class Preconditioner {
+public:
+  virtual ~Preconditioner() = default;
+  virtual void apply(const Matrix &r, const Matrix &z) const;
+};
+
+// 以下预条件由方阵构造，非方阵时抛 domain_error
+// 稠密矩阵先去掉零元转为稀疏矩阵；对角元为零时抛 size_t 所在行
+
+// 对角预条件 M = D
+class Jacobi : public Preconditioner {
+private:
+  std::vector<Number>  inv;  // 对角元的倒数
+
+public:
+  explicit Jacobi(const SparseMatrix &);
+  explicit Jacobi(const Matrix &);
+  void apply(const Matrix &r, const Matrix &z) const override;
+};
+
+// 零填充不完全 LU 分解 M = L U，L 与 U 的非零结构与 A 相同
+class ILU0 : public Preconditioner {
+private:
+  SparseMatrix         lu;    // csr，严格下三角存 L（对角线为 1），其余存 U
+  std::vector<size_t>  diag;  // 每行对角元在 lu 中的位置
+
+public:
+  explicit ILU0(const SparseMatrix &);
+  explicit ILU0(const Matrix &);
+  void apply(const Matrix &r, const Matrix &z) const override;
+};
+
+// 对称逐次超松弛预条件，A = L + D + U，0 < omega < 2，否则抛 invalid_argument
+// M = omega / (2 - omega) * (D / omega + L) (D / omega)^-1 (D / omega + U)
+class SSOR : public Preconditioner {
+private:
+  SparseMatrix         a;      // csr
+  std::vector<size_t>  diag;   // 每行对角元在 a 中的位置
+  Number               omega;
+
+public:
+  explicit SSOR(const SparseMatrix &, Number omega = 1);
+  explicit SSOR(const Matrix &, Number omega = 1);
+  void apply(const Matrix &r, const Matrix &z) const override;
+};
+
+struct KrylovOptions {
+  Number  tol = 1e-10;       // 相对残差 |b - A x| / |b| 的收敛阈值
+  size_t  max_iter = 1000;   // 最大迭代次数（矩阵向量乘积轮数）
+  size_t  restart = 30;      // GMRES 的重启周期
+
+  // 每次迭代后以迭代次数和相对残差调用，返回 false 时停止迭代
+  // GMRES 内层迭代给出的是残差的递推估计
+  std::function<bool(size_t iter, Number residual)>  callback;
+};
+
+struct KrylovResult {
+  size_t  iterations;  // 完成的迭代次数
+  Number  residual;    // 结束时的相对残差
+  bool    converged;   // 是否达到 tol
+};
+
+// 以下求解器以 x 为初值，结果写回 x；b 为零向量时 x 置零
+// A 与 x、b 的行数不一致，或 x、b 不是单列时抛 domain_error
+// 出现除零（如 BiCGSTAB 的 breakdown）时提前结束，converged 为 false
+
+// 预条件共轭梯度法，A 与 M 须对称正定
+KrylovResult cg(const LinearOperator &A, const Matrix &b, const Matrix &x,
+    const Preconditioner &M = Preconditioner(), const KrylovOptions & = KrylovOptions());
+
+// 预条件稳定双共轭梯度法，适用于非对称 A
+KrylovResult bicgstab(const LinearOperator &A, const Matrix &b, const Matrix &x,
+    const Preconditioner &M = Preconditioner(), const KrylovOptions & = KrylovOptions());
+
+// 右预条件重启 GMRES(restart)，Arnoldi 过程用修正 Gram-Schmidt 正交化
+KrylovResult gmres(const LinearOperator &A, const Matrix &b, const Matrix &x,
+    const Preconditioner &M = Preconditioner(), const KrylovOptions & = KrylovOptions());
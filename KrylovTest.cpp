@@ -0,0 +1,348 @@
+#include "TestBasic.h"
+#include "Krylov.h"
+#include "Allocator.h"
+#include "ThreadPool.h"
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <atomic>
+#include <new>
+
+using namespace std;
+
+void test_krylov_spd();
+void test_krylov_nonsymmetric();
+void test_krylov_operators();
+void test_krylov_errors();
+void test_krylov_no_alloc();
+void test_krylov_repeat();
+
+int main()
+{
+  srand(time(NULL));
+  test_krylov_spd();
+  test_krylov_nonsymmetric();
+  test_krylov_operators();
+  test_krylov_errors();
+  test_krylov_no_alloc();
+  test_krylov_repeat();
+}
+
+// 统计全局 new 的次数
+static atomic<size_t> news(0);
+
+void *operator new(size_t size)
+{
+  ++news;
+  if(void *p = malloc(size ? size : 1))
+    return p;
+  throw bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+  free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+  free(p);
+}
+
+// 统计矩阵数据区的分配次数
+class CountingAllocator : public Allocator {
+public:
+  size_t count = 0;
+  void *allocate(size_t size) override
+  {
+    ++count;
+    return malloc_allocator().allocate(size);
+  }
+  void deallocate(void *p, size_t size) noexcept override
+  {
+    malloc_allocator().deallocate(p, size);
+  }
+};
+
+// 二维对流扩散算子，m*m 个未知量；c 为零时即对称正定的五点拉普拉斯算子
+static SparseMatrix convection_diffusion(size_t m, Number c = 0)
+{
+  vector<Triplet> ts;
+  for(size_t i = 0; i < m; ++i)
+    for(size_t j = 0; j < m; ++j)
+    {
+      size_t r = i * m + j;
+      ts.push_back({ r, r, 4 });
+      if(i)
+        ts.push_back({ r, r - m, -1 - c });
+      if(i + 1 < m)
+        ts.push_back({ r, r + m, -1 + c });
+      if(j)
+        ts.push_back({ r, r - 1, -1 - c });
+      if(j + 1 < m)
+        ts.push_back({ r, r + 1, -1 + c });
+    }
+  return SparseMatrix(m * m, m * m, ts);
+}
+
+static Matrix random_vector(size_t n)
+{
+  Matrix b(n, 1);
+  for(size_t i = 0; i < n; ++i)
+    b(i, 0) = (Number)rand() / RAND_MAX - 0.5;
+  return b;
+}
+
+// 相对残差 |b - A x| / |b|
+static Number residual(const SparseMatrix &A, const Matrix &b, const Matrix &x)
+{
+  Matrix r = A * x;
+  Number s = 0, t = 0;
+  for(size_t i = 0; i < b.nr(); ++i)
+  {
+    s += (b(i, 0) - r(i, 0)) * (b(i, 0) - r(i, 0));
+    t += b(i, 0) * b(i, 0);
+  }
+  return sqrt(s / t);
+}
+
+void test_krylov_spd()
+{
+  size_t m = 30, n = m * m;
+  SparseMatrix A = convection_diffusion(m);
+  Matrix b = random_vector(n);
+  Jacobi jacobi(A);
+  ILU0 ilu(A);
+  SSOR ssor(A, 1.5);
+  const Preconditioner none;
+  size_t plain = 0;
+  for(const Preconditioner *M : { &none, (const Preconditioner *)&jacobi,
+      (const Preconditioner *)&ilu, (const Preconditioner *)&ssor })
+  {
+    Matrix x(n, 1);
+    x.fill(0);
+    KrylovResult res = cg(A, b, x, *M);
+    assert(res.converged && res.residual <= 1e-10);
+    assert(residual(A, b, x) < 1e-9);
+    if(M == &none)
+      plain = res.iterations;
+    else if(M != &jacobi)  // 常对角时 Jacobi 不改变迭代次数
+      assert(res.iterations < plain);
+    for(auto solver : { bicgstab, gmres })
+    {
+      x.fill(0);
+      res = solver(A, b, x, *M, KrylovOptions());
+      assert(res.converged && residual(A, b, x) < 1e-9);
+    }
+  }
+
+  // 三对角矩阵的 ILU(0) 即精确 LU 分解
+  vector<Triplet> ts;
+  for(size_t i = 0; i < 50; ++i)
+  {
+    ts.push_back({ i, i, 3 + (Number)i / 10 });
+    if(i)
+      ts.push_back({ i, i - 1, -1 });
+    if(i + 1 < 50)
+      ts.push_back({ i, i + 1, -1.5 });
+  }
+  SparseMatrix T(50, 50, ts);
+  Matrix c = random_vector(50), y(50, 1);
+  y.fill(0);
+  KrylovResult res = gmres(T, c, y, ILU0(T));
+  assert(res.converged && res.iterations == 1);
+  TEST_PASSED;
+}
+
+void test_krylov_nonsymmetric()
+{
+  size_t m = 30, n = m * m;
+  SparseMatrix A = convection_diffusion(m, 0.6);
+  Matrix b = random_vector(n), x(n, 1);
+  ILU0 ilu(A);
+
+  x.fill(0);
+  KrylovResult plain = bicgstab(A, b, x);
+  assert(plain.converged && residual(A, b, x) < 1e-9);
+  x.fill(0);
+  KrylovResult res = bicgstab(A, b, x, ilu);
+  assert(res.converged && residual(A, b, x) < 1e-9 && res.iterations < plain.iterations);
+
+  KrylovOptions opt;
+  opt.restart = 20;
+  opt.max_iter = 5000;
+  x.fill(0);
+  plain = gmres(A, b, x, Preconditioner(), opt);
+  assert(plain.converged && residual(A, b, x) < 1e-9);
+  x.fill(0);
+  res = gmres(A, b, x, ilu, opt);
+  assert(res.converged && residual(A, b, x) < 1e-9 && res.iterations < plain.iterations);
+
+  // 从已收敛的初值出发不需迭代
+  res = gmres(A, b, x, ilu, opt);
+  assert(res.converged && res.iterations == 0);
+  TEST_PASSED;
+}
+
+void test_krylov_operators()
+{
+  // 稠密矩阵
+  size_t n = 60;
+  Matrix A(n, n);
+  for(size_t i = 0; i < n; ++i)
+    for(size_t j = 0; j < n; ++j)
+      A(i, j) = i == j ? n : 1.0 / (1 + i + j);
+  Matrix b = random_vector(n), x(n, 1);
+  for(auto solver : { cg, bicgstab, gmres })
+  {
+    x.fill(0);
+    KrylovResult res = solver(A, b, x, Preconditioner(), KrylovOptions());
+    assert(res.converged);
+    Matrix r = A * x;
+    for(size_t i = 0; i < n; ++i)
+      assert(fabs(r(i, 0) - b(i, 0)) < 1e-9);
+  }
+  x.fill(0);
+  assert(cg(A, b, x, ILU0(A)).iterations <= 2);
+  x.fill(0);
+  assert(gmres(A, b, x, SSOR(A)).converged);
+
+  // 隐式给出的算子：一维拉普拉斯算子，不存矩阵
+  n = 100;
+  LinearOperator L(n, [n](const Matrix &u, const Matrix &v) {
+    for(size_t i = 0; i < n; ++i)
+      v(i, 0) = 2 * u(i, 0) - (i ? u(i - 1, 0) : 0) - (i + 1 < n ? u(i + 1, 0) : 0);
+  });
+  Matrix c = random_vector(n), y(n, 1);
+  y.fill(0);
+  KrylovResult res = cg(L, c, y);
+  assert(res.converged && res.iterations <= n);
+
+  // 零右端项
+  y.fill(1);
+  c.fill(0);
+  res = gmres(L, c, y);
+  assert(res.converged && res.iterations == 0 && y(7, 0) == 0);
+
+  // 跳步视图作为 x 和 b
+  Matrix B(n, 3), X(n, 3);
+  B.col(1) = random_vector(n);
+  X.fill(0);
+  assert(bicgstab(L, B.col(1), X.col(1)).converged);
+  assert(X(0, 0) == 0 && X(0, 2) == 0);
+  TEST_PASSED;
+}
+
+void test_krylov_errors()
+{
+  SparseMatrix A = convection_diffusion(5);
+  ASSERT_EXCEPTION(domain_error, cg(A, Matrix(24, 1), Matrix(25, 1));)
+  ASSERT_EXCEPTION(domain_error, cg(A, Matrix(25, 2), Matrix(25, 2));)
+  ASSERT_EXCEPTION(domain_error, LinearOperator(Matrix(3, 4));)
+  ASSERT_EXCEPTION(domain_error, ILU0(SparseMatrix(3, 4));)
+  ASSERT_EXCEPTION(invalid_argument, SSOR(A, 2);)
+  ASSERT_EXCEPTION(invalid_argument, SSOR(A, 0);)
+
+  // 对角元缺失
+  vector<Triplet> ts = { { 0, 0, 1 }, { 1, 0, 1 }, { 2, 2, 1 } };
+  try
+  {
+    Jacobi M(SparseMatrix(3, 3, ts));
+    assert(false);
+  }
+  catch(size_t i)
+  {
+    assert(i == 1);
+  }
+
+  // 回调返回 false 时停止
+  Matrix b = random_vector(25), x(25, 1);
+  x.fill(0);
+  KrylovOptions opt;
+  size_t calls = 0;
+  opt.callback = [&](size_t iter, Number) { return ++calls == iter && iter < 3; };
+  KrylovResult res = cg(A, b, x, Preconditioner(), opt);
+  assert(calls == 3 && res.iterations == 3 && !res.converged);
+  calls = 0;
+  x.fill(0);
+  res = gmres(A, b, x, Preconditioner(), opt);
+  assert(calls == 3 && res.iterations == 3 && !res.converged);
+  opt.callback = nullptr;
+  opt.max_iter = 2;
+  x.fill(0);
+  res = bicgstab(A, b, x, Preconditioner(), opt);
+  assert(res.iterations == 2 && !res.converged);
+  TEST_PASSED;
+}
+
+// 迭代过程中既不分配矩阵也不调用 new
+void test_krylov_no_alloc()
+{
+  // 小规模串行；非零元超过并行阈值时多线程 SpMV，csc 矩阵由算子转为 csr
+  for(size_t threads : {1, 4})
+  for(SparseLayout layout : {SparseLayout::csr, SparseLayout::csc})
+  {
+    size_t m = threads == 1 ? 20 : 100, n = m * m;
+    SparseMatrix A = convection_diffusion(m, 0.3).to(layout);
+    assert(threads == 1 || A.nnz() >= 1 << 15);
+    ILU0 ilu(A);
+    LinearOperator op(A);
+    Matrix b = random_vector(n), x(n, 1);
+    set_num_threads(threads);
+    CountingAllocator counting;
+    Allocator &saved = get_allocator();
+    set_allocator(counting);
+
+    size_t first_alloc = 0, first_new = 0;
+    KrylovOptions opt;
+    opt.callback = [&](size_t iter, Number) {
+      if(iter == 1)
+      {
+        first_alloc = counting.count;
+        first_new = news;
+      }
+      else
+        assert(counting.count == first_alloc && news == first_new);
+      return true;
+    };
+    for(auto solver : { cg, bicgstab, gmres })
+    {
+      x.fill(0);
+      assert(solver(op, b, x, ilu, opt).iterations > 3);
+    }
+    set_allocator(saved);
+  }
+  set_num_threads(0);
+  TEST_PASSED;
+}
+
+void test_krylov_repeat()
+{
+  size_t m = 300, n = m * m;
+  SparseMatrix A = convection_diffusion(m);
+  Matrix b = random_vector(n), x(n, 1);
+
+  clock_t start = clock();
+  ILU0 ilu(A);
+  double setup = (double)(clock() - start) / CLOCKS_PER_SEC;
+  cout << "It took " << setup << " s to build ILU(0) of a " << n << "x" << n
+       << " Laplacian." << endl;
+
+  const Preconditioner none;
+  SSOR ssor(A, 1.8);
+  KrylovOptions opt;
+  opt.max_iter = 10000;
+  const char *names[] = { "no", "ILU(0)", "SSOR" };
+  const Preconditioner *pre[] = { &none, &ilu, &ssor };
+  for(size_t t = 0; t < 3; ++t)
+  {
+    x.fill(0);
+    start = clock();
+    KrylovResult res = cg(A, b, x, *pre[t], opt);
+    double d = (double)(clock() - start) / CLOCKS_PER_SEC;
+    assert(res.converged && residual(A, b, x) < 1e-9);
+    cout << "It took " << d << " s and " << res.iterations << " CG iterations with "
+         << names[t] << " preconditioner." << endl;
+  }
+  TEST_PASSED;
+}
@@ -0,0 +1,223 @@
+#include "LU.h"
+#include "Blas.h"
+#include <stdexcept>
+#include <cmath>
+#include <algorithm>
+
+using std::abs;
+
+namespace {
+
+// 求解 X T = B，结果写回 B；uplo 为 T 的三角部分
+// trsm 在转置视图上较慢，故在 B^T 的行内连续副本上求解
+void trsm_right(Uplo uplo, Diag diag, const Matrix &T, const Matrix &B)
+{
+  Matrix Bt = B.t().copy();
+  trsm(uplo == Uplo::lower ? Uplo::upper : Uplo::lower, diag, T.t(), Bt);
+  B = Bt.t();
+}
+
+// 就地求上三角矩阵 U 的逆
+// [U11, U12; 0, U22]^-1 = [U11^-1, -U11^-1 U12 U22^-1; 0, U22^-1]，先以原 U11、U22 求非对角块再递归
+void invert_upper(const Matrix &U)
+{
+  size_t n = U.nr();
+  if(n <= 16)
+  {
+    // 逐列进行，第 j 列上部为已求出的左上角之逆乘以原列
+    for(size_t j = 0; j < n; ++j)
+    {
+      U(j, j) = 1 / U(j, j);
+      Number a = -U(j, j);
+      for(size_t i = 0; i < j; ++i)
+      {
+        Number s = 0;
+        for(size_t k = i; k < j; ++k)
+          s += U(i, k) * U(k, j);
+        U(i, j) = s * a;
+      }
+    }
+    return;
+  }
+  size_t h = n / 2;
+  Matrix U11 = U.slice(0, h), U12 = U.slice(0, h, h, n), U22 = U.slice(h, n);
+  trsm_right(Uplo::upper, Diag::non_unit, U22, U12);
+  trsm(Uplo::upper, Diag::non_unit, U11, U12);
+  U12 *= -1;
+  invert_upper(U11);
+  invert_upper(U22);
+}
+
+// lu 为 P A = L U 的分解结果，就地改写为 A^-1
+void invert(const Matrix &lu, const std::vector<size_t> &piv, size_t block)
+{
+  size_t n = lu.nr();
+  invert_upper(lu);
+  if(n == 0)
+    return;
+
+  // X L = U^-1：取出第 [j0, j1) 列的 L 部分后清零，
+  // X(:, j0:j1) = (U^-1(:, j0:j1) - X(:, j1:n) L(j1:n, j0:j1)) L(j0:j1, j0:j1)^-1
+  Matrix W(n, block);
+  for(size_t j0 = (n - 1) / block * block + block; j0 > 0; )
+  {
+    j0 -= block;
+    size_t j1 = std::min(j0 + block, n);
+    Matrix L = W.slice(j0, n, 0, j1 - j0);
+    for(size_t i = j0; i < n; ++i)
+      for(size_t c = j0; c < j1; ++c)
+        if(i > c)
+        {
+          L(i - j0, c - j0) = lu(i, c);
+          lu(i, c) = 0;
+        }
+        else
+          L(i - j0, c - j0) = 0;
+    if(j1 < n)
+      gemm(-1, lu.col_slice(j1), L.row_slice(j1 - j0), 1, lu.col_slice(j0, j1));
+    trsm_right(Uplo::lower, Diag::unit, L.row_slice(0, j1 - j0), lu.col_slice(j0, j1));
+  }
+
+  // A^-1 = X P
+  for(size_t k = n; k-- > 0; )
+    if(piv[k] != k)
+      lu.t().row_swap(k, piv[k]);
+}
+
+}  // namespace
+
+LU::LU(const Matrix &A) : lu(A.copy()), piv(A.nr()), singular(A.nr())
+{
+  if(!A.square())
+    throw std::domain_error("factorizing non-square matrix");
+  factor();
+}
+
+void LU::factor()
+{
+  size_t N = n();
+  for(size_t k0 = 0; k0 < N; k0 += block)
+  {
+    size_t k1 = std::min(k0 + block, N);
+
+    // 面板 lu[k0:N, k0:k1] 逐列选主元消元，行交换作用于整行
+    for(size_t k = k0; k < k1; ++k)
+    {
+      size_t p = k;
+      Number pivot = abs(lu(k, k));
+      for(size_t i = k + 1; i < N; ++i)
+        if(abs(lu(i, k)) > pivot)
+        {
+          pivot = abs(lu(i, k));
+          p = i;
+        }
+      piv[k] = p;
+      if(p != k)
+        lu.row_swap(k, p);
+      if(pivot == 0)
+      {
+        singular = std::min(singular, k);
+        continue;
+      }
+      lu.slice(k + 1, N, k, k + 1) /= lu(k, k);
+      ger(-1, lu.slice(k + 1, N, k, k + 1), lu.slice(k, k + 1, k + 1, k1),
+          lu.slice(k + 1, N, k + 1, k1));
+    }
+    if(k1 == N)
+      break;
+
+    // U12 = L11^-1 A12，A22 -= L21 U12
+    trsm(Uplo::lower, Diag::unit, lu.slice(k0, k1), lu.slice(k0, k1, k1, N));
+    gemm(-1, lu.slice(k1, N, k0, k1), lu.slice(k0, k1, k1, N), 1, lu.slice(k1));
+  }
+}
+
+void LU::solve(const Matrix &B) const
+{
+  if(B.nr() != n())
+    throw std::invalid_argument("inconsistent A and B");
+  if(!invertible())
+    throw singular;
+  for(size_t k = 0; k < n(); ++k)
+    if(piv[k] != k)
+      B.row_swap(k, piv[k]);
+  trsm(Uplo::lower, Diag::unit, lu, B);
+  trsm(Uplo::upper, Diag::non_unit, lu, B);
+}
+
+Number LU::det() const
+{
+  if(!invertible())
+    return 0;
+  Number d = 1;
+  for(size_t k = 0; k < n(); ++k)
+    d *= piv[k] != k ? -lu(k, k) : lu(k, k);
+  return d;
+}
+
+Number LU::logdet(int &sign) const
+{
+  sign = 1;
+  if(!invertible())
+  {
+    sign = 0;
+    return -INFINITY;
+  }
+  Number s = 0;
+  for(size_t k = 0; k < n(); ++k)
+  {
+    Number u = lu(k, k);
+    if((u < 0) != (piv[k] != k))
+      sign = -sign;
+    s += std::log(abs(u));
+  }
+  return s;
+}
+
+Number LU::det_ratio(size_t i, const Matrix &r) const
+{
+  if(i >= n())
+    throw std::out_of_range("row index out of range");
+  if(r.nr() != 1 || r.nc() != n())
+    throw std::invalid_argument("inconsistent A and r");
+  Matrix x(n(), 1);
+  x.fill(0);
+  x(i, 0) = 1;
+  solve(x);
+  Number s = 0;
+  for(size_t k = 0; k < n(); ++k)
+    s += r(0, k) * x(k, 0);
+  return s;
+}
+
+Matrix LU::inverse() const &
+{
+  if(!invertible())
+    throw singular;
+  Matrix inv = lu.copy();
+  invert(inv, piv, block);
+  return inv;
+}
+
+Matrix LU::inverse() &&
+{
+  if(!invertible())
+    throw singular;
+  invert(lu, piv, block);
+  return lu;
+}
+
+Number det(const Matrix &A)
+{
+  return LU(A).det();
+}
+
+Number logdet(const Matrix &A, int &sign)
+{
+  return LU(A).logdet(sign);
+}
+
+Matrix inverse(const Matrix &A)
+{
+  return LU(A).inverse();
+}
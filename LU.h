@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Basic.h"
+#include "Matrix.h"
+#include <vector>
+
+// 列主元 LU 分解 P A = L U
+// 分块右视算法：面板内逐列选主元消元，再以三角求解和 gemm 更新右下子块
+// 分解结果可反复用于求解不同右端项
+class LU {
+  friend class LUTest;
+private:
+  Matrix               lu;        // 严格下三角存 L（对角线为 1，不存），上三角存 U
+  std::vector<size_t>  piv;       // 第 k 步与第 piv[k] 行交换
+  size_t               singular;  // 首个零主元所在行，非奇异时为 n
+
+  void factor();
+
+public:
+  static constexpr size_t block = 64;  // 面板宽度
+
+  // 分解 A 的副本；A 非方阵时抛 domain_error
+  // A 奇异时分解照常完成，求解时抛错
+  explicit LU(const Matrix &A);
+
+  // 方阵阶数
+  size_t n() const { return lu.nr(); }
+
+  // 是否非奇异
+  bool invertible() const { return singular == n(); }
+
+  // 分解结果和主元交换序列
+  const Matrix &factors() const { return lu; }
+  const std::vector<size_t> &pivots() const { return piv; }
+
+  // 求解 A X = B，结果写回 B，B 可有任意列
+  // B 行数与 A 不等时抛 invalid_argument
+  // A 奇异时抛 size_t 首个零主元所在行
+  void solve(const Matrix &B) const;
+
+  // 行列式，由 U 的对角线与交换次数得到，A 奇异时为 0；阶数较高时可能上溢，宜用 logdet
+  Number det() const;
+
+  // 行列式绝对值的对数，sign 置为行列式的符号；A 奇异时 sign 为 0，退回 -inf
+  Number logdet(int &sign) const;
+
+  // 将 A 的第 i 行换为行向量 r 后行列式的比值 det(A') / det(A)，即 r A^-1 e_i
+  // 只做一次 O(n^2) 的求解，不重新分解
+  // i 越界时抛 out_of_range，r 不是 1 行 n 列时抛 invalid_argument，A 奇异时抛 size_t
+  Number det_ratio(size_t i, const Matrix &r) const;
+
+  // 逆矩阵：先就地求 U 的逆（分块递归，非对角块由 trsm 完成），
+  // 再按列块从右向左解 X L = U^-1（gemm 与 trsm），最后交换列
+  // 左值上调用时在分解的副本上进行，右值（如 LU(A).inverse()）直接使用分解的存储
+  // A 奇异时抛 size_t 首个零主元所在行
+  Matrix inverse() const &;
+  Matrix inverse() &&;
+};
+
+// 以下函数各做一次 LU 分解，需要多个结果或反复求解时应直接使用 LU
+Number det(const Matrix &A);
+Number logdet(const Matrix &A, int &sign);
+Matrix inverse(const Matrix &A);
@@ -0,0 +1,342 @@
+#include "TestBasic.h"
+#include "LU.h"
+#include "Equation.h"
+#include <random>
+#include <ctime>
+#include <cmath>
+#include <chrono>
+#include "ThreadPool.h"
+
+using namespace std;
+
+class LUTest {
+private:
+  default_random_engine e;
+  Matrix random(size_t nr, size_t nc);
+  Number residual(const Matrix &A, const Matrix &X, const Matrix &B) const;
+  void test_LU_shapes();
+  void test_LU_factors();
+  void test_LU_solve();
+  void test_LU_singular();
+  void test_LU_det();
+  void test_LU_inverse();
+  void test_LU_repeat();
+  void test_LU_det_repeat();
+public:
+  void test();
+};
+
+int main()
+{
+  LUTest().test();
+}
+
+void LUTest::test()
+{
+  time_t seed = time(NULL);
+  cout << "Use seed: " << seed << endl;
+  e.seed(seed);
+  test_LU_shapes();
+  test_LU_factors();
+  test_LU_solve();
+  test_LU_singular();
+  test_LU_det();
+  test_LU_inverse();
+  test_LU_repeat();
+  test_LU_det_repeat();
+}
+
+Matrix LUTest::random(size_t nr, size_t nc)
+{
+  uniform_real_distribution<Number> urd(-1, 1);
+  Matrix A(nr, nc);
+  for(size_t i = 0; i < nr; ++i)
+    for(size_t j = 0; j < nc; ++j)
+      A(i, j) = urd(e);
+  return A;
+}
+
+// 相对残差 |A X - B| / (|A| |X|)
+Number LUTest::residual(const Matrix &A, const Matrix &X, const Matrix &B) const
+{
+  Matrix R = A * X - B;
+  Number r = 0, a = 0, x = 0;
+  for(size_t i = 0; i < R.nr(); ++i)
+    for(size_t j = 0; j < R.nc(); ++j)
+      r = max(r, abs(R(i, j)));
+  for(size_t i = 0; i < A.nr(); ++i)
+    for(size_t j = 0; j < A.nc(); ++j)
+      a = max(a, abs(A(i, j)));
+  for(size_t i = 0; i < X.nr(); ++i)
+    for(size_t j = 0; j < X.nc(); ++j)
+      x = max(x, abs(X(i, j)));
+  return r / (a * x * A.nr() + 1e-300);
+}
+
+void LUTest::test_LU_shapes()
+{
+  ASSERT_EXCEPTION(domain_error, LU(Matrix(2, 3));)
+  LU lu(random(3, 3));
+  ASSERT_EXCEPTION(invalid_argument, lu.solve(Matrix(2, 1));)
+  LU(Matrix(0, 0)).solve(Matrix(0, 4));
+  TEST_PASSED;
+}
+
+void LUTest::test_LU_factors()
+{
+  for(size_t n : {1, 5, 64, 65, 200})
+  {
+    Matrix A = random(n, n);
+    LU lu(A);
+    assert(lu.invertible());
+
+    // 重组 P A = L U
+    Matrix L(n, n), U(n, n);
+    L.fill(0);
+    U.fill(0);
+    for(size_t i = 0; i < n; ++i)
+    {
+      L(i, i) = 1;
+      for(size_t j = 0; j < i; ++j)
+        L(i, j) = lu.lu(i, j);
+      for(size_t j = i; j < n; ++j)
+        U(i, j) = lu.lu(i, j);
+    }
+    Matrix PA = A.copy();
+    for(size_t k = 0; k < n; ++k)
+    {
+      assert(lu.piv[k] >= k && lu.piv[k] < n);
+      PA.row_swap(k, lu.piv[k]);
+    }
+    Matrix R = L * U - PA;
+    for(size_t i = 0; i < n; ++i)
+      for(size_t j = 0; j < n; ++j)
+      {
+        assert(abs(R(i, j)) < 1e-12 * n);
+        assert(abs(L(i, j)) <= 1);
+      }
+  }
+  TEST_PASSED;
+}
+
+void LUTest::test_LU_solve()
+{
+  for(size_t n : {1, 3, 63, 64, 129, 300})
+  {
+    Matrix A = random(n, n);
+    LU lu(A);
+    for(size_t nrhs : {1, 7})
+    {
+      Matrix B = random(n, nrhs), X = B.copy();
+      lu.solve(X);
+      assert(residual(A, X, B) < 1e-14);
+
+      // 右端项为转置视图
+      Matrix Bt = B.t().copy(), Xt = Bt.copy();
+      lu.solve(Xt.t());
+      assert(residual(A, Xt.t(), B) < 1e-14);
+    }
+  }
+
+  // 与高斯约当消元一致
+  double in[2][3] = {
+    2, 3, 11,
+    3, 1, 6,
+  };
+  Matrix Ab(2, 3, in);
+  Matrix b = Ab.col_slice(2).copy();
+  LU(Ab.col_slice(0, 2)).solve(b);
+  solve_GJ(Ab);
+  assert(abs(b(0, 0) - Ab(0, 2)) < 1e-15 && abs(b(1, 0) - Ab(1, 2)) < 1e-15);
+
+  TEST_PASSED;
+}
+
+void LUTest::test_LU_singular()
+{
+  double in[3][3] = {
+    1, 2, 3,
+    2, 4, 6,
+    1, 0, 1,
+  };
+  LU lu(Matrix(3, 3, in));
+  assert(!lu.invertible());
+  ASSERT_EXCEPTION(size_t, lu.solve(Matrix(3, 1));)
+  TEST_PASSED;
+}
+
+void LUTest::test_LU_repeat()
+{
+  size_t n = 500;
+  Matrix A = random(n, n);
+  clock_t start = clock();
+  LU lu(A);
+  clock_t diff = clock() - start;
+  cout << "It took " << (double)diff / CLOCKS_PER_SEC
+       << " s to factorize a " << n << "x" << n << " matrix." << endl;
+
+  Matrix b = random(n, 1), x(n, 1);
+  start = clock();
+  for(int t = 0; t < 1000; ++t)
+  {
+    x = b;
+    lu.solve(x);
+  }
+  diff = clock() - start;
+  assert(residual(A, x, b) < 1e-14);
+  cout << "It took " << (double)diff / CLOCKS_PER_SEC
+       << " s to solve against it 1000 times." << endl;
+  TEST_PASSED;
+}
+
+void LUTest::test_LU_det()
+{
+  double in[3][3] = {
+    0, 2, 1,
+    1, 1, 0,
+    3, 0, 2,
+  };
+  Matrix A(3, 3, in);
+  // 按第一行展开：-2 (2 - 0) + 1 (0 - 3) = -7
+  LU lu(A);
+  assert(abs(lu.det() + 7) < 1e-14 && abs(det(A) + 7) < 1e-14);
+  int sign = 0;
+  assert(abs(lu.logdet(sign) - log(7.0)) < 1e-14 && sign == -1);
+  assert(abs(logdet(A, sign) - log(7.0)) < 1e-14 && sign == -1);
+
+  // 三角矩阵的行列式为对角元之积，交换两行变号
+  size_t n = 80;
+  Matrix T = random(n, n);
+  Number logd = 0;
+  int s = 1;
+  for(size_t i = 0; i < n; ++i)
+  {
+    for(size_t j = 0; j < i; ++j)
+      T(i, j) = 0;
+    logd += log(abs(T(i, i)));
+    s = T(i, i) < 0 ? -s : s;
+  }
+  assert(abs(logdet(T, sign) - logd) < 1e-12 && sign == s);
+  T.row_swap(3, 50);
+  assert(abs(logdet(T, sign) - logd) < 1e-12 && sign == -s);
+
+  // 阶数较高时 det 上溢而 logdet 有限
+  Matrix B = random(400, 400);
+  for(size_t i = 0; i < 400; ++i)
+    B(i, i) = 20;
+  LU big(B);
+  assert(isinf(big.det()) && isfinite(big.logdet(sign)) && sign == 1);
+
+  // 奇异矩阵不抛错
+  double sin[3][3] = {
+    1, 2, 3,
+    2, 4, 6,
+    1, 0, 1,
+  };
+  Matrix S(3, 3, sin);
+  assert(det(S) == 0);
+  assert(logdet(S, sign) == -INFINITY && sign == 0);
+  assert(det(Matrix(0, 0)) == 1);
+
+  // 换一行后的行列式之比
+  Matrix C = random(60, 60);
+  LU lc(C);
+  Matrix r = random(1, 60);
+  Number ratio = lc.det_ratio(17, r);
+  Matrix C2 = C.copy();
+  C2.row(17) = r;
+  int s1, s2;
+  Number l1 = lc.logdet(s1), l2 = logdet(C2, s2);
+  assert(abs(ratio - s1 * s2 * exp(l2 - l1)) < 1e-10 * max(1.0, abs(ratio)));
+  ASSERT_EXCEPTION(out_of_range, lc.det_ratio(60, r);)
+  ASSERT_EXCEPTION(invalid_argument, lc.det_ratio(0, Matrix(60, 1));)
+  ASSERT_EXCEPTION(size_t, LU(S).det_ratio(0, Matrix(1, 3));)
+  TEST_PASSED;
+}
+
+void LUTest::test_LU_inverse()
+{
+  for(size_t n : {1, 2, 15, 16, 17, 64, 65, 200, 333})
+  {
+    Matrix A = random(n, n);
+    LU lu(A);
+    Matrix X = lu.inverse();
+    Matrix I(n, n);
+    I.fill(0);
+    for(size_t i = 0; i < n; ++i)
+      I(i, i) = 1;
+    assert(residual(A, X, I) < 1e-14);
+    assert(residual(X, A, I) < 1e-13);
+
+    // 分解未被改写，右值版本结果相同
+    Matrix B = random(n, 2), Y = B.copy();
+    lu.solve(Y);
+    assert(residual(A, Y, B) < 1e-14);
+    Matrix Z = inverse(A);
+    for(size_t i = 0; i < n; ++i)
+      for(size_t j = 0; j < n; ++j)
+        assert(abs(Z(i, j) - X(i, j)) <= 1e-12 * (1 + abs(X(i, j))));
+  }
+
+  double in[3][3] = {
+    1, 2, 3,
+    2, 4, 6,
+    1, 0, 1,
+  };
+  ASSERT_EXCEPTION(size_t, inverse(Matrix(3, 3, in));)
+  LU ls(Matrix(3, 3, in));
+  ASSERT_EXCEPTION(size_t, ls.inverse();)
+  ASSERT_EXCEPTION(domain_error, inverse(Matrix(2, 3));)
+  assert(inverse(Matrix(0, 0)).empty());
+  TEST_PASSED;
+}
+
+void LUTest::test_LU_det_repeat()
+{
+  size_t n = 500, times = 200;
+  Matrix A = random(n, n);
+  int sign;
+  clock_t start = clock();
+  for(size_t t = 0; t < times; ++t)
+    logdet(A, sign);
+  double full = (double)(clock() - start) / CLOCKS_PER_SEC / times;
+  cout << "It took " << full * 1e3 << " ms per " << n << "x" << n << " logdet ("
+       << 1 / full << " per second)." << endl;
+
+  // 换一行的比值复用分解，每次为 O(n^2)
+  LU lu(A);
+  Matrix r = random(1, n);
+  Number ratio = 0;
+  start = clock();
+  for(size_t t = 0; t < times * 10; ++t)
+    ratio += lu.det_ratio(t % n, r);
+  double reuse = (double)(clock() - start) / CLOCKS_PER_SEC / (times * 10);
+  cout << "It took " << reuse * 1e3 << " ms per determinant ratio with a cached LU ("
+       << 1 / reuse << " per second)." << endl;
+
+  start = clock();
+  Matrix X = lu.inverse();
+  double inv = (double)(clock() - start) / CLOCKS_PER_SEC;
+  Matrix Y(n, n);
+  Y.fill(0);
+  for(size_t i = 0; i < n; ++i)
+    Y(i, i) = 1;
+  start = clock();
+  lu.solve(Y);
+  double solves = (double)(clock() - start) / CLOCKS_PER_SEC;
+  cout << "It took " << inv << " s to invert it in place and " << solves
+       << " s to solve against the identity." << endl;
+  for(size_t i = 0; i < n; ++i)
+    for(size_t j = 0; j < n; ++j)
+      assert(abs(X(i, j) - Y(i, j)) < 1e-10 * (1 + abs(Y(i, j))));
+
+  set_num_threads(4);
+  auto wall = chrono::steady_clock::now();
+  for(size_t t = 0; t < times; ++t)
+    logdet(A, sign);
+  chrono::duration<double> d = chrono::steady_clock::now() - wall;
+  cout << "It took " << d.count() / times * 1e3 << " ms per logdet with " << num_threads()
+       << " threads." << endl;
+  set_num_threads(0);
+  TEST_PASSED;
+}
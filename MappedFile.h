@@ -0,0 +1,60 @@
+#pragma once
+
+// 库内部使用的文件和映射区封装，不属于公开接口
+
+#include "Basic.h"
+#include <string>
+#include <system_error>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// 文件描述符，析构时关闭；无法打开时抛 system_error
+struct File {
+  int fd;
+
+  File(const std::string &path, int flags, mode_t mode = 0)
+  {
+    fd = open(path.c_str(), flags, mode);
+    if(fd < 0)
+      throw std::system_error(errno, std::generic_category(), path);
+  }
+
+  ~File() { close(fd); }
+  File(const File &) = delete;
+  File &operator=(const File &) = delete;
+
+  size_t size(const std::string &path) const
+  {
+    struct stat st;
+    if(fstat(fd, &st))
+      throw std::system_error(errno, std::generic_category(), path);
+    return st.st_size;
+  }
+};
+
+// 整个文件的映射区，release 之前析构时解除映射；映射失败时抛 system_error
+struct Mapping {
+  void    *addr;
+  size_t  length;
+
+  Mapping(const File &file, const std::string &path, size_t len, int prot, int flags)
+  {
+    length = len;
+    addr = mmap(nullptr, len, prot, flags, file.fd, 0);
+    if(addr == MAP_FAILED)
+      throw std::system_error(errno, std::generic_category(), path);
+  }
+
+  ~Mapping()
+  {
+    if(addr)
+      munmap(addr, length);
+  }
+  Mapping(const Mapping &) = delete;
+  Mapping &operator=(const Mapping &) = delete;
+
+  void release() { addr = nullptr; }
+};
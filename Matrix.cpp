@@ -1,5 +1,8 @@
 #include "Matrix.h"
+#include "Gemm.h"
+#include "Kernel.h"
 #include <cstdlib>
+#include <cstdint>
 #include <cstring>
 #include <stdexcept>
 #include <iostream>
@@ -7,37 +10,78 @@
 #include <string>
 #include <algorithm>
 #include <new>
+#include <utility>
+#include <complex>
 
-Matrix::Matrix(size_t nr, size_t nc)
+template<class T>
+size_t BasicMatrix<T>::leading_dim(size_t nc)
 {
-  if(nr > nmax)
-    throw std::out_of_range("row number exceeded");
-  if(nc > nmax)
-    throw std::out_of_range("column number exceeded");
-
-  size_t data_size = nr * nc * sizeof(Number);
-  size_t malloc_size = data_size + sizeof(size_t);
-  refc = (size_t *)malloc(malloc_size);
-  if(!refc)
-    throw std::bad_alloc();
+  constexpr size_t line = alloc_align / sizeof(T);
+  if(nc < pad_min || nc > SIZE_MAX - 2 * line)
+    return nc;
+  size_t ld = (nc + line - 1) / line * line;
+  if(ld * sizeof(T) % 512 == 0)
+    ld += line;
+  return ld;
+}
+
+template<class T>
+BasicMatrix<T>::BasicMatrix(size_t nr, size_t nc)
+{
+  // 最后一行只计 nc 个元素
+  size_t ld = leading_dim(nc);
+  size_t count = 0, size;
+  if(nr && nc && (__builtin_mul_overflow(nr - 1, ld, &count) ||
+                  __builtin_add_overflow(count, nc, &count)))
+    throw std::out_of_range("matrix size exceeded");
+  if(__builtin_mul_overflow(count, sizeof(T), &size) ||
+     __builtin_add_overflow(size, sizeof(Header), &size))
+    throw std::out_of_range("matrix size exceeded");
 
-  data = (Number *)&refc[1];
-  *refc = 1;
+  Allocator &alloc = get_allocator();
+  Header *header = new(alloc.allocate(size)) Header{ {1}, 1, size, &alloc };
+
+  data = (T *)(header + 1);
+  refc = &header->refc;
   nrow = nr;
   ncol = nc;
-  srow = nc;
+  srow = ld;
   scol = 1;
 }
 
-Matrix::~Matrix()
+template<class T>
+typename BasicMatrix<T>::Header BasicMatrix<T>::borrowed{ {SIZE_MAX / 2}, 0, 0, nullptr };
+
+template<class T>
+BasicMatrix<T>::BasicMatrix(Header *header, T *d, size_t nr, size_t nc, size_t sr, size_t sc)
 {
-  if(!--*refc)
-    free(refc);
+  data = d;
+  refc = &header->refc;
+  nrow = nr;
+  ncol = nc;
+  srow = sr;
+  scol = sc;
 }
 
-Matrix::Matrix(const Matrix &matrix)
+template<class T>
+BasicMatrix<T>::~BasicMatrix()
 {
-  ++*matrix.refc;
+  // 计数为 base 时没有其他对象可以增加计数，省去原子减法
+  // 释放前须看到其他线程经由各自视图的全部写入
+  // base 须在递减前读出，递减后头部可能已被其他线程释放
+  if(!refc)
+    return;
+  Header *header = (Header *)refc;
+  size_t base = header->base;
+  if(refc->load(std::memory_order_acquire) == base ||
+     refc->fetch_sub(1, std::memory_order_acq_rel) == base)
+    header->alloc->deallocate(header, header->size);
+}
+
+template<class T>
+BasicMatrix<T>::BasicMatrix(const BasicMatrix &matrix)
+{
+  matrix.refc->fetch_add(1, std::memory_order_relaxed);
   data = matrix.data;
   refc = matrix.refc;
   nrow = matrix.nrow;
@@ -46,53 +90,84 @@ Matrix::Matrix(const Matrix &matrix)
   scol = matrix.scol;
 }
 
-Matrix &Matrix::operator=(const Matrix &matrix)
+template<class T>
+BasicMatrix<T>::BasicMatrix(BasicMatrix &&matrix) noexcept
 {
-  return (Matrix &)(*(const Matrix *)this = matrix);
+  data = matrix.data;
+  refc = matrix.refc;
+  nrow = matrix.nrow;
+  ncol = matrix.ncol;
+  srow = matrix.srow;
+  scol = matrix.scol;
+  matrix.data = nullptr;
+  matrix.refc = nullptr;
+  matrix.nrow = matrix.ncol = 0;
 }
 
-const Matrix &Matrix::operator=(const Matrix &matrix) const
+template<class T>
+BasicMatrix<T> &BasicMatrix<T>::operator=(BasicMatrix &&matrix)
 {
-  if(nr() != matrix.nr() || nc() != matrix.nc())
-    throw std::domain_error("inconsistent shapes");
-  for(size_t i = 0; i < nr(); ++i)
+  if(!refc)
   {
-    StepIterator Ai = (*this)[i];
-    StepIterator Bi = matrix[i];
-    while(Ai != row_end(i))
-      *Ai++ = *Bi++;
+    if(matrix.ref() == 1)
+      new((void *)this) BasicMatrix(std::move(matrix));
+    else
+      new((void *)this) BasicMatrix(matrix.copy());
+    return *this;
   }
+  if(ref() == 1 && matrix.ref() == 1 && nr() == matrix.nr() && nc() == matrix.nc())
+  {
+    std::swap(data, matrix.data);
+    std::swap(refc, matrix.refc);
+    std::swap(srow, matrix.srow);
+    std::swap(scol, matrix.scol);
+    return *this;
+  }
+  return *this = (const BasicMatrix &)matrix;
+}
+
+template<class T>
+BasicMatrix<T> &BasicMatrix<T>::operator=(const BasicMatrix &matrix)
+{
+  return (BasicMatrix &)(*(const BasicMatrix *)this = matrix);
+}
+
+template<class T>
+const BasicMatrix<T> &BasicMatrix<T>::operator=(const BasicMatrix &matrix) const
+{
+  if(nr() != matrix.nr() || nc() != matrix.nc())
+    throw std::domain_error("inconsistent shapes");
+  for_each_line(*this, matrix, element_kernels<T>().assign);
   return *this;
 }
 
-void Matrix::reset(const Matrix &matrix)
+template<class T>
+void BasicMatrix<T>::reset(const BasicMatrix &matrix)
 {
   if(refc == matrix.refc)
     memcpy(this, &matrix, sizeof *this);
   else
   {
-    this->~Matrix();
-    new((void *)this) Matrix(matrix);
+    this->~BasicMatrix();
+    new((void *)this) BasicMatrix(matrix);
   }
 }
 
-Matrix Matrix::copy() const
+template<class T>
+BasicMatrix<T> BasicMatrix<T>::copy() const
 {
-  Matrix matrix(nr(), nc());
+  BasicMatrix matrix(nr(), nc());
   return matrix = *this;
 }
 
-void Matrix::fill(Number v) const
+template<class T>
+void BasicMatrix<T>::fill(T v) const
 {
-  for(size_t i = 0; i < nr(); ++i)
-  {
-    StepIterator iter = row_begin(i);
-    while(iter != row_end(i))
-      *iter++ = v;
-  }
+  for_each_line(*this, v, element_kernels<T>().fill);
 }
 
-std::ostream &operator<<(std::ostream &os, const Matrix &matrix)
+template<class T>
+std::ostream &operator<<(std::ostream &os, const BasicMatrix<T> &matrix)
 {
   size_t nr = matrix.nr();
   size_t nc = matrix.nc();
@@ -120,42 +195,27 @@ std::ostream &operator<<(std::ostream &os, const Matrix &matrix)
   return os;
 }
 
-Matrix operator*(const Matrix &A, const Matrix &B)
+template<class T>
+BasicMatrix<T> operator*(const BasicMatrix<T> &A, const BasicMatrix<T> &B)
 {
   if(A.nc() != B.nr())
     throw std::domain_error("inconsistent shapes");
-  Matrix C(A.nr(), B.nc());
-  // for(size_t i = 0; i < C.nr(); ++i)
-  //   for(size_t j = 0; j < C.nc(); ++j)
-  //   {
-  //     C(i, j) = 0;
-  //     for(size_t k = 0; k < A.nc(); ++k)
-  //       C(i, j) += A(i, k) * B(k, j);
-  //   }
-  for(size_t i = 0; i < C.nr(); ++i)
-  {
-    StepIterator Ci = C.row_begin(i);
-    for(size_t j = 0; j < C.nc(); ++j)
-    {
-      Number c = 0;
-      StepIterator Ai = A.row_begin(i);
-      StepIterator Bj = B.col_begin(j);
-      while(Ai != A.row_end(i))
-        c += *Ai++ * *Bj++;
-      *Ci++ = c;
-    }
-  }
+  BasicMatrix<T> C(A.nr(), B.nc());
+  gemm_engine(C.nr(), C.nc(), A.nc(), 1,
+      A.ptr(), A.sr(), A.sc(), B.ptr(), B.sr(), B.sc(),
+      0, C.ptr(), C.sr(), C.sc());
   return C;
 }
 
-bool operator==(const Matrix &A, const Matrix &B)
+template<class T>
+bool operator==(const BasicMatrix<T> &A, const BasicMatrix<T> &B)
 {
   if(A.nr() != B.nr() || A.nc() != B.nc())
     throw std::domain_error("inconsistent shapes");
   for(size_t i = 0; i < A.nr(); ++i)
   {
-    StepIterator Ai = A[i];
-    StepIterator Bi = B[i];
+    BasicStepIterator<T> Ai = A[i];
+    BasicStepIterator<T> Bi = B[i];
     while(Ai != A.row_end(i))
       if(!(*Ai++ == *Bi++))
         return false;
@@ -163,160 +223,139 @@ bool operator==(const Matrix &A, const Matrix &B)
   return true;
 }
 
-Matrix Matrix::row_slice(size_t i1, size_t i2) const
+template<class T>
+BasicMatrix<T> BasicMatrix<T>::row_slice(size_t i1, size_t i2) const
 {
   if(i1 > i2)
     throw std::invalid_argument("invalid row interval");
   if(i2 > nr())
     throw std::out_of_range("row index exceeded");
-  Matrix matrix(*this);
+  BasicMatrix matrix(*this);
   matrix.data = &matrix[i1][0];
   matrix.nrow = i2 - i1;
   return matrix;
 }
 
-Matrix Matrix::col_slice(size_t j1, size_t j2) const
+template<class T>
+BasicMatrix<T> BasicMatrix<T>::col_slice(size_t j1, size_t j2) const
 {
   if(j1 > j2)
     throw std::invalid_argument("invalid column interval");
   if(j2 > nc())
     throw std::out_of_range("column index exceeded");
-  Matrix matrix(*this);
+  BasicMatrix matrix(*this);
   matrix.data = &matrix[0][j1];
   matrix.ncol = j2 - j1;
   return matrix;
 }
 
-Matrix Matrix::slice(size_t i1, size_t i2, size_t j1, size_t j2) const
+template<class T>
+BasicMatrix<T> BasicMatrix<T>::slice(size_t i1, size_t i2, size_t j1, size_t j2) const
 {
   if(i1 > i2 || j1 > j2)
     throw std::invalid_argument("invalid row interval");
   if(i2 > nr() || j2 > nc())
     throw std::out_of_range("row index exceeded");
-  Matrix matrix(*this);
+  BasicMatrix matrix(*this);
   matrix.data = &matrix[i1][j1];
   matrix.nrow = i2 - i1;
   matrix.ncol = j2 - j1;
   return matrix;
 }
 
-void Matrix::row_swap(size_t i1, size_t i2) const
+template<class T>
+void BasicMatrix<T>::row_swap(size_t i1, size_t i2) const
 {
-  StepIterator iter1 = row_begin(i1);
-  StepIterator iter2 = row_begin(i2);
+  BasicStepIterator<T> iter1 = row_begin(i1);
+  BasicStepIterator<T> iter2 = row_begin(i2);
   while(iter1 != row_end(i1))
     std::iter_swap(iter1++, iter2++);
 }
 
-void Matrix::col_swap(size_t j1, size_t j2) const
+template<class T>
+void BasicMatrix<T>::col_swap(size_t j1, size_t j2) const
 {
-  StepIterator iter1 = col_begin(j1);
-  StepIterator iter2 = col_begin(j2);
+  BasicStepIterator<T> iter1 = col_begin(j1);
+  BasicStepIterator<T> iter2 = col_begin(j2);
   while(iter1 != col_end(j1))
     std::iter_swap(iter1++, iter2++);
 }
 
-Matrix Matrix::t() const
+template<class T>
+BasicMatrix<T> BasicMatrix<T>::t() const
 {
-  Matrix matrix(*this);
+  BasicMatrix matrix(*this);
   std::swap(matrix.nrow, matrix.ncol);
   std::swap(matrix.srow, matrix.scol);
   return matrix;
 }
 
-Matrix Matrix::operator+() const
+template<class T>
+BasicMatrix<T> BasicMatrix<T>::operator+() const
 {
-  Matrix matrix(nr(), nc());
-  for(size_t i = 0; i < nr(); ++i)
-  {
-    StepIterator w_it = matrix.row_begin(i);
-    StepIterator r_it = row_begin(i);
-    while(w_it != matrix.row_end(i))
-      *w_it++ = +*r_it++;
-  }
+  BasicMatrix matrix(nr(), nc());
+  for_each_line(matrix, *this, element_kernels<T>().assign);
   return matrix;
 }
 
-Matrix Matrix::operator-() const
+template<class T>
+BasicMatrix<T> BasicMatrix<T>::operator-() const &
 {
-  Matrix matrix(nr(), nc());
-  for(size_t i = 0; i < nr(); ++i)
-  {
-    StepIterator w_it = matrix.row_begin(i);
-    StepIterator r_it = row_begin(i);
-    while(w_it != matrix.row_end(i))
-      *w_it++ = -*r_it++;
-  }
+  BasicMatrix matrix(nr(), nc());
+  for_each_line(matrix, *this, element_kernels<T>().negate);
   return matrix;
 }
 
-const Matrix &Matrix::operator+=(const Matrix &matrix) const
+template<class T>
+BasicMatrix<T> BasicMatrix<T>::operator-() &&
 {
-  for(size_t i = 0; i < nr(); ++i)
-  {
-    StepIterator w_it = row_begin(i);
-    StepIterator r_it = matrix.row_begin(i);
-    while(w_it != row_end(i))
-      *w_it++ += *r_it++;
-  }
-  return *this;
+  if(ref() != 1)
+    return -*this;
+  for_each_line(*this, *this, element_kernels<T>().negate);
+  return std::move(*this);
 }
 
-const Matrix &Matrix::operator-=(const Matrix &matrix) const 
+template<class T>
+const BasicMatrix<T> &BasicMatrix<T>::operator+=(const BasicMatrix &matrix) const
 {
-  for(size_t i = 0; i < nr(); ++i)
-  {
-    StepIterator w_it = row_begin(i);
-    StepIterator r_it = matrix.row_begin(i);
-    while(w_it != row_end(i))
-      *w_it++ -= *r_it++;
-  }
+  for_each_line(*this, matrix, element_kernels<T>().add);
   return *this;
 }
 
-const Matrix &Matrix::operator*=(Number k) const 
+template<class T>
+const BasicMatrix<T> &BasicMatrix<T>::operator-=(const BasicMatrix &matrix) const
 {
-  for(size_t i = 0; i < nr(); ++i)
-  {
-    StepIterator w_it = row_begin(i);
-    while(w_it != row_end(i))
-      *w_it++ *= k;
-  }
+  for_each_line(*this, matrix, element_kernels<T>().sub);
   return *this;
 }
 
-const Matrix &Matrix::operator/=(Number k) const 
+template<class T>
+const BasicMatrix<T> &BasicMatrix<T>::operator*=(T k) const
 {
-  for(size_t i = 0; i < nr(); ++i)
-  {
-    StepIterator w_it = row_begin(i);
-    while(w_it != row_end(i))
-      *w_it++ /= k;
-  }
+  for_each_line(*this, k, element_kernels<T>().mul);
   return *this;
 }
 
-Matrix operator+(const Matrix &A, const Matrix &B)
-{
-  return A.copy() += B;
-}
-
-Matrix operator-(const Matrix &A, const Matrix &B)
+template<class T>
+const BasicMatrix<T> &BasicMatrix<T>::operator/=(T k) const
 {
-  return A.copy() -= B;
+  for_each_line(*this, k, element_kernels<T>().div);
+  return *this;
 }
 
-Matrix operator*(const Matrix &A, Number k)
+template<class T>
+void BasicMatrix<T>::print() const
 {
-  return A.copy() *= k;
+  std::cout << *this << std::endl;
 }
 
-Matrix operator/(const Matrix &A, Number k)
-{
-  return A.copy() /= k;
-}
+#define MATRIX_INSTANTIATE(T) \
+  template class BasicMatrix<T>; \
+  template BasicMatrix<T> operator*(const BasicMatrix<T> &, const BasicMatrix<T> &); \
+  template bool operator==(const BasicMatrix<T> &, const BasicMatrix<T> &); \
+  template std::ostream &operator<<(std::ostream &, const BasicMatrix<T> &);
 
-void Matrix::print() const
-{
-  std::cout << *this << std::endl;
-}
+MATRIX_INSTANTIATE(float)
+MATRIX_INSTANTIATE(double)
+MATRIX_INSTANTIATE(long double)
+MATRIX_INSTANTIATE(std::complex<double>)
@@ -3,52 +3,111 @@
 #include "Basic.h"
 #include "StepIterator.h"
 #include "IOStream.h"
-
-class Matrix {
+#include "Allocator.h"
+#include <type_traits>
+#include <atomic>
+#include <string>
+#include <map>
+#include <complex>
+
+template<class E> class MatrixExpr;
+struct MatrixExprBase;
+struct Mapping;
+
+// 矩阵元类型为 T 的矩阵视图，T 为 float、double、long double 或 std::complex<double>
+// 成员函数在库内对这四种类型显式实例化，Matrix 即 BasicMatrix<double>
+template<class T>
+class BasicMatrix {
   friend class MatrixTest;
 private:
-  Number  *data;  // 首元素地址
-  size_t  *refc;  // 数据区引用计数
-  size_t  nrow;   // 行数
-  size_t  ncol;   // 列数
-  size_t  srow;   // 行跳步
-  size_t  scol;   // 列跳步
+  // 数据区头部，独占一个缓存行，紧接其后为矩阵元
+  // 引用计数为原子变量，且不与矩阵元共享缓存行
+  struct alignas(alloc_align) Header {
+    std::atomic<size_t>  refc;   // 引用计数
+    size_t               base;   // 只剩一个视图时的计数，该视图析构时释放数据区
+    size_t               size;   // 含头部的分配字节数
+    Allocator            *alloc; // 分配数据区的分配器
+  };
+
+  T                    *data;  // 首元素地址
+  std::atomic<size_t>  *refc;  // 数据区引用计数，即头部首成员
+  size_t               nrow;   // 行数
+  size_t               ncol;   // 列数
+  size_t               srow;   // 行跳步
+  size_t               scol;   // 列跳步
+
+  // 新建矩阵的行跳步
+  static size_t leading_dim(size_t nc);
+
+  // 接管引用计数为 base 的数据区头部
+  BasicMatrix(Header *, T *data, size_t nr, size_t nc, size_t sr, size_t sc);
+
+  // 借用视图共用的数据区头部，计数从极大值起增减，永不归零
+  static Header borrowed;
+
+  // 创建位于映射区内的矩阵，接管映射区（见 MappedFile.h），最后一个视图析构时解除映射
+  // 计数从 2 起增减，ref() 不为 1，因而映射区不被移动赋值换走，也不被右值运算就地改写
+  static BasicMatrix adopt(Mapping &, T *data, size_t nr, size_t nc, size_t sr, size_t sc);
+  friend BasicMatrix<double> load_npy(const std::string &, bool);
+  friend std::map<std::string, BasicMatrix<double>> load_npz(const std::string &);
 
 public:
-  static constexpr size_t nmax = (1 << 14) - 1;
+  typedef T value_type;
+
+  static constexpr size_t pad_min = 16;
 
-  // 行数或列数大于 nmax 时抛 out_of_range
-  // 内存分配失败时抛 bad_alloc
-  Matrix(size_t nr, size_t nc);
+  // 行列数不受限制，数据区字节数超出 size_t 表示范围时抛 out_of_range
+  // 数据区由 get_allocator() 分配，内存分配失败时抛 bad_alloc
+  // 首元素按缓存行对齐；列数不小于 pad_min 时每行补齐到整缓存行，
+  // 行长为 512 字节的整数倍时再错开一个缓存行，避免同列元素落入同一缓存组
+  BasicMatrix(size_t nr, size_t nc);
   template<class M>
-    Matrix(size_t nr, size_t nc, const M &);
+    BasicMatrix(size_t nr, size_t nc, const M &);
   template<class M, size_t Nr, size_t Nc>
-    Matrix(const M (&)[Nr][Nc]);
+    BasicMatrix(const M (&)[Nr][Nc]);
+
+  // 从惰性表达式求值构造（见 Expression.h）
+  template<class E>
+    BasicMatrix(const MatrixExpr<E> &);
 
-  // 非虚函数，递减数据区引用计数，归零时释放内存
-  ~Matrix();
+  // 借用调用者的存储作为矩阵视图，不分配内存，调用者保证存储在视图及其切片析构前有效
+  // 借用视图的 ref() 不为 1，因而不被移动赋值交换数据区，也不被右值运算就地改写；
+  // 各借用视图共用一个引用计数，对它的原子增减在多线程间共享同一缓存行
+  static BasicMatrix borrow(T *data, size_t nr, size_t nc, size_t sr, size_t sc = 1);
+
+  // 非虚函数，递减数据区引用计数，归零时交还分配器
+  ~BasicMatrix();
 
   // 拷贝构造具有引用语义
-  Matrix(const Matrix &);
+  // 引用计数的增减是原子操作，同一数据区的视图可在不同线程中各自拷贝和析构，
+  // 矩阵元的并发读写仍由调用者保证不冲突
+  BasicMatrix(const BasicMatrix &);
+
+  // 移动构造接管数据区，源对象不再持有数据区，此后只可析构、reset 或移动赋值
+  BasicMatrix(BasicMatrix &&) noexcept;
 
   // 引用重置
-  void reset(const Matrix &);
+  void reset(const BasicMatrix &);
 
   // 拷贝赋值具有值语义
-  Matrix &operator=(const Matrix &);
-  const Matrix &operator=(const Matrix &) const;
+  BasicMatrix &operator=(const BasicMatrix &);
+  // 移动赋值同样具有值语义：双方数据区都不与其他对象共享且形状一致时交换数据区，
+  // 否则逐元素拷贝；不持有数据区的对象接管源对象或其副本
+  BasicMatrix &operator=(BasicMatrix &&);
+  const BasicMatrix &operator=(const BasicMatrix &) const;
   template<class M>
-    Matrix &operator=(const M &);
+    BasicMatrix &operator=(const M &);
   template<class M>
-    const Matrix &operator=(const M &) const;
-  void fill(Number) const;
+    const BasicMatrix &operator=(const M &) const;
+  void fill(T) const;
 
   // 值拷贝
-  Matrix copy() const;
+  BasicMatrix copy() const;
 
   // 获取引用状态
-  size_t ref() const { return *refc; }
-  bool ref(const Matrix &m) const { return refc == m.refc; }
+  // ref() 为 1 时数据区只属于本对象，其他线程的析构对本线程可见
+  size_t ref() const { return refc ? refc->load(std::memory_order_acquire) : 0; }
+  bool ref(const BasicMatrix &m) const { return refc == m.refc; }
 
   // 获取行数和列数
   size_t nr() const { return nrow; }
@@ -56,198 +115,264 @@ public:
   bool empty() const { return !nrow || !ncol; }
   bool square() const { return nrow == ncol; }
 
+  // 获取首元素地址和行列跳步
+  T *ptr() const { return data; }
+  size_t sr() const { return srow; }
+  size_t sc() const { return scol; }
+
   // 行列访问（无越界检查）
-  StepIterator row_begin(size_t i) const;
-  StepIterator row_end(size_t i) const;
-  StepIterator col_begin(size_t j) const;
-  StepIterator col_end(size_t j) const;
-  StepIterator operator[](size_t i) const;
+  BasicStepIterator<T> row_begin(size_t i) const;
+  BasicStepIterator<T> row_end(size_t i) const;
+  BasicStepIterator<T> col_begin(size_t j) const;
+  BasicStepIterator<T> col_end(size_t j) const;
+  BasicStepIterator<T> operator[](size_t i) const;
 
   // 矩阵元访问（无越界检查）
-  Number &operator()(size_t i, size_t j) const;
+  T &operator()(size_t i, size_t j) const;
 
   // 行列切片
-  Matrix row_slice(size_t i1, size_t i2) const;
-  Matrix row_slice(size_t i1) const;  // 一切到尾
-  Matrix col_slice(size_t j1, size_t j2) const;
-  Matrix col_slice(size_t j1) const;  // 一切到尾
-  Matrix row(size_t i1) const;  // 切单行
-  Matrix col(size_t j1) const;  // 切单列
-  Matrix slice(size_t i1, size_t i2, size_t j1, size_t j2) const;
-  Matrix slice(size_t ij1, size_t ij2) const;  // 行列同步
-  Matrix slice(size_t ij1) const;  // 行列同步一切到尾
+  BasicMatrix row_slice(size_t i1, size_t i2) const;
+  BasicMatrix row_slice(size_t i1) const;  // 一切到尾
+  BasicMatrix col_slice(size_t j1, size_t j2) const;
+  BasicMatrix col_slice(size_t j1) const;  // 一切到尾
+  BasicMatrix row(size_t i1) const;  // 切单行
+  BasicMatrix col(size_t j1) const;  // 切单列
+  BasicMatrix slice(size_t i1, size_t i2, size_t j1, size_t j2) const;
+  BasicMatrix slice(size_t ij1, size_t ij2) const;  // 行列同步
+  BasicMatrix slice(size_t ij1) const;  // 行列同步一切到尾
 
   // 行列交换
   void row_swap(size_t i1, size_t i2) const;
   void col_swap(size_t j1, size_t j2) const;
 
   // 行列转置
-  Matrix t() const;
+  BasicMatrix t() const;
 
-  // 正负号
-  Matrix operator+() const;
-  Matrix operator-() const;
+  // 正负号，右值数据区不与其他对象共享时就地取负
+  BasicMatrix operator+() const;
+  BasicMatrix operator-() const &;
+  BasicMatrix operator-() &&;
 
   // 复合加法
-  Matrix &operator+=(const Matrix &);
-  const Matrix &operator+=(const Matrix &) const;
-  Matrix &operator-=(const Matrix &);
-  const Matrix &operator-=(const Matrix &) const;
+  BasicMatrix &operator+=(const BasicMatrix &);
+  const BasicMatrix &operator+=(const BasicMatrix &) const;
+  BasicMatrix &operator-=(const BasicMatrix &);
+  const BasicMatrix &operator-=(const BasicMatrix &) const;
+  template<class E>
+    BasicMatrix &operator+=(const MatrixExpr<E> &);
+  template<class E>
+    const BasicMatrix &operator+=(const MatrixExpr<E> &) const;
+  template<class E>
+    BasicMatrix &operator-=(const MatrixExpr<E> &);
+  template<class E>
+    const BasicMatrix &operator-=(const MatrixExpr<E> &) const;
 
   // 复合数量乘法
-  Matrix &operator*=(Number);
-  const Matrix &operator*=(Number) const;
-  Matrix &operator/=(Number);
-  const Matrix &operator/=(Number) const;
+  BasicMatrix &operator*=(T);
+  const BasicMatrix &operator*=(T) const;
+  BasicMatrix &operator/=(T);
+  const BasicMatrix &operator/=(T) const;
 
   // 打印矩阵
   void print() const;
+
+  // 映射二进制矩阵文件（格式见 MatrixFile.h），矩阵元直接位于映射区，不读入内存
+  // 文件的元素类型须与 T 一致
+  // shared 为假时写入只影响本进程（写时复制），为真时写回文件且不更新校验和
+  // 未写入的页面在同一主机的各进程间共享；映射时不校验数据区，见 verify_matrix_file
+  // 文件无法打开或映射时抛 system_error，格式不符时抛 runtime_error
+  static BasicMatrix map(const std::string &path, bool shared = false);
+
+  // 保存为二进制矩阵文件，按行存储，行跳步同新建矩阵；写入失败时抛 system_error
+  void save(const std::string &path) const;
 };
 
 // 输出矩阵
-std::ostream &operator<<(std::ostream &, const Matrix &);
+template<class T>
+std::ostream &operator<<(std::ostream &, const BasicMatrix<T> &);
 
-inline StepIterator Matrix::row_begin(size_t i) const
+template<class T>
+inline BasicStepIterator<T> BasicMatrix<T>::row_begin(size_t i) const
 {
-  return StepIterator(&data[i * srow], scol);
+  return BasicStepIterator<T>(&data[i * srow], scol);
 }
 
-inline StepIterator Matrix::row_end(size_t i) const
+template<class T>
+inline BasicStepIterator<T> BasicMatrix<T>::row_end(size_t i) const
 {
   return row_begin(i) + ncol;
 }
 
-inline StepIterator Matrix::col_begin(size_t j) const
+template<class T>
+inline BasicStepIterator<T> BasicMatrix<T>::col_begin(size_t j) const
 {
-  return StepIterator(&data[j * scol], srow);
+  return BasicStepIterator<T>(&data[j * scol], srow);
 }
 
-inline StepIterator Matrix::col_end(size_t j) const
+template<class T>
+inline BasicStepIterator<T> BasicMatrix<T>::col_end(size_t j) const
 {
   return col_begin(j) + nrow;
 }
 
-inline StepIterator Matrix::operator[](size_t i) const
+template<class T>
+inline BasicStepIterator<T> BasicMatrix<T>::operator[](size_t i) const
 {
   return row_begin(i);
 }
 
-inline Number &Matrix::operator()(size_t i, size_t j) const
+template<class T>
+inline T &BasicMatrix<T>::operator()(size_t i, size_t j) const
 {
   return (*this)[i][j];
 }
 
+template<class T>
+inline BasicMatrix<T> BasicMatrix<T>::borrow(T *d, size_t nr, size_t nc, size_t sr, size_t sc)
+{
+  borrowed.refc.fetch_add(1, std::memory_order_relaxed);
+  return BasicMatrix(&borrowed, d, nr, nc, sr, sc);
+}
+
+template<class T>
 template<class M>
-Matrix::Matrix(size_t nr, size_t nc, const M &m) : Matrix(nr, nc)
+BasicMatrix<T>::BasicMatrix(size_t nr, size_t nc, const M &m) : BasicMatrix(nr, nc)
 {
   *this = m;
 }
 
+template<class T>
 template<class M, size_t Nr, size_t Nc>
-Matrix::Matrix(const M (&m)[Nr][Nc]) : Matrix(Nr, Nc)
+BasicMatrix<T>::BasicMatrix(const M (&m)[Nr][Nc]) : BasicMatrix(Nr, Nc)
 {
   *this = m;
 }
 
+template<class T>
 template<class M>
-Matrix &Matrix::operator=(const M &m)
+BasicMatrix<T> &BasicMatrix<T>::operator=(const M &m)
 {
-  return (Matrix &)(*(const Matrix *)this = m);
+  return (BasicMatrix &)(*(const BasicMatrix *)this = m);
 }
 
+template<class T>
 template<class M>
-const Matrix &Matrix::operator=(const M &m) const
+const BasicMatrix<T> &BasicMatrix<T>::operator=(const M &m) const
 {
-  // for(size_t i = 0; i < nr(); ++i)
-  //   for(size_t j = 0; j < nc(); ++j)
-  //     (*this)(i, j) = m[i][j];
-  for(size_t i = 0; i < nr(); ++i)
+  if constexpr(std::is_base_of_v<MatrixExprBase, M>)
+    m.assign_to(*this);
+  else
   {
-    StepIterator iter = (*this)[i];
-    for(size_t j = 0; j < nc(); ++j)
-      *iter++ = m[i][j];
+    // for(size_t i = 0; i < nr(); ++i)
+    //   for(size_t j = 0; j < nc(); ++j)
+    //     (*this)(i, j) = m[i][j];
+    for(size_t i = 0; i < nr(); ++i)
+    {
+      BasicStepIterator<T> iter = (*this)[i];
+      for(size_t j = 0; j < nc(); ++j)
+        *iter++ = m[i][j];
+    }
   }
   return *this;
 }
 
-// 矩阵加法
-Matrix operator+(const Matrix &A, const Matrix &B);
-Matrix operator-(const Matrix &A, const Matrix &B);
-
-// 矩阵数量乘法
-Matrix operator*(const Matrix &A, Number k);
-Matrix operator/(const Matrix &A, Number k);
-inline Matrix operator*(Number k, const Matrix &A)
-{
-  return A * k;
-}
+// 矩阵加法和数量乘法为惰性求值，右值操作数就地计算，见 Expression.h
 
 // 矩阵乘法
-Matrix operator*(const Matrix &A, const Matrix &B);
+template<class T>
+BasicMatrix<T> operator*(const BasicMatrix<T> &A, const BasicMatrix<T> &B);
 
 // 矩阵判等
-bool operator==(const Matrix &A, const Matrix &B);
-inline bool operator!=(const Matrix &A, const Matrix &B)
+template<class T>
+bool operator==(const BasicMatrix<T> &A, const BasicMatrix<T> &B);
+template<class T>
+inline bool operator!=(const BasicMatrix<T> &A, const BasicMatrix<T> &B)
 {
   return !(A == B);
 }
 
 // 行切片到尾
-inline Matrix Matrix::row_slice(size_t i1) const
+template<class T>
+inline BasicMatrix<T> BasicMatrix<T>::row_slice(size_t i1) const
 {
   return row_slice(i1, nr());
 }
 
 // 列切片到尾
-inline Matrix Matrix::col_slice(size_t j1) const
+template<class T>
+inline BasicMatrix<T> BasicMatrix<T>::col_slice(size_t j1) const
 {
   return col_slice(j1, nc());
 }
 
 // 切单行
-inline Matrix Matrix::row(size_t i1) const
+template<class T>
+inline BasicMatrix<T> BasicMatrix<T>::row(size_t i1) const
 {
   return row_slice(i1, i1 + 1);
 }
 
 // 切单列
-inline Matrix Matrix::col(size_t j1) const
+template<class T>
+inline BasicMatrix<T> BasicMatrix<T>::col(size_t j1) const
 {
   return col_slice(j1, j1 + 1);
 }
 
 // 行列同切
-inline Matrix Matrix::slice(size_t ij1, size_t ij2) const
+template<class T>
+inline BasicMatrix<T> BasicMatrix<T>::slice(size_t ij1, size_t ij2) const
 {
   return slice(ij1, ij2, ij1, ij2);
 }
 
 // 行列同切到尾
-inline Matrix Matrix::slice(size_t ij1) const
+template<class T>
+inline BasicMatrix<T> BasicMatrix<T>::slice(size_t ij1) const
 {
   return slice(ij1, nr(), ij1, nc());
 }
 
 // 固定矩阵复合加法
-inline Matrix &Matrix::operator+=(const Matrix &matrix)
+template<class T>
+inline BasicMatrix<T> &BasicMatrix<T>::operator+=(const BasicMatrix &matrix)
 {
-  return (Matrix &)(*(const Matrix *)this += matrix);
+  return (BasicMatrix &)(*(const BasicMatrix *)this += matrix);
 }
 
 // 固定矩阵复合减法
-inline Matrix &Matrix::operator-=(const Matrix &matrix)
+template<class T>
+inline BasicMatrix<T> &BasicMatrix<T>::operator-=(const BasicMatrix &matrix)
 {
-  return (Matrix &)(*(const Matrix *)this -= matrix);
+  return (BasicMatrix &)(*(const BasicMatrix *)this -= matrix);
 }
 
 // 固定矩阵复合数量乘法
-inline Matrix &Matrix::operator*=(Number k)
+template<class T>
+inline BasicMatrix<T> &BasicMatrix<T>::operator*=(T k)
 {
-  return (Matrix &)(*(const Matrix *)this *= k);
+  return (BasicMatrix &)(*(const BasicMatrix *)this *= k);
 }
 
 // 固定矩阵复合数量除法
-inline Matrix &Matrix::operator/=(Number k)
+template<class T>
+inline BasicMatrix<T> &BasicMatrix<T>::operator/=(T k)
 {
-  return (Matrix &)(*(const Matrix *)this /= k);
+  return (BasicMatrix &)(*(const BasicMatrix *)this /= k);
 }
+
+// 以下实例化位于库内，见 Matrix.cpp
+#define MATRIX_EXTERN_TEMPLATE(T) \
+  extern template class BasicMatrix<T>; \
+  extern template BasicMatrix<T> operator*(const BasicMatrix<T> &, const BasicMatrix<T> &); \
+  extern template bool operator==(const BasicMatrix<T> &, const BasicMatrix<T> &); \
+  extern template std::ostream &operator<<(std::ostream &, const BasicMatrix<T> &);
+
+MATRIX_EXTERN_TEMPLATE(float)
+MATRIX_EXTERN_TEMPLATE(double)
+MATRIX_EXTERN_TEMPLATE(long double)
+MATRIX_EXTERN_TEMPLATE(std::complex<double>)
+
+#undef MATRIX_EXTERN_TEMPLATE
+
+#include "Expression.h"
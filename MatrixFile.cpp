@@ -0,0 +1,221 @@
+#include "MatrixFile.h"
+#include "Matrix.h"
+#include "Kernel.h"
+#include "MappedFile.h"
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <stdexcept>
+#include <system_error>
+#include <new>
+#include <unistd.h>
+
+static_assert(sizeof(long double) == 16, "float80 elements occupy 16 bytes");
+
+namespace {
+
+// 映射矩阵的数据区头部之后存放映射区位置，引用计数归零时解除映射
+struct MapRecord {
+  void    *addr;
+  size_t  length;
+};
+
+class Unmapper : public Allocator {
+public:
+  void *allocate(size_t size) override
+  {
+    return malloc_allocator().allocate(size);
+  }
+
+  void deallocate(void *p, size_t size) noexcept override
+  {
+    MapRecord *r = (MapRecord *)((char *)p + size - sizeof(MapRecord));
+    munmap(r->addr, r->length);
+    malloc_allocator().deallocate(p, size);
+  }
+};
+
+Unmapper unmapper;
+
+// 校验文件头，返回数据区字节数；格式不符时抛 runtime_error
+// 元素类型须为 dtype，每个元素 elem 字节
+size_t check_header(const MatrixFileHeader &h, size_t length, const std::string &path,
+    MatrixDType dtype, size_t elem)
+{
+  auto invalid = [&](const char *what) {
+    return std::runtime_error("invalid matrix file " + path + ": " + what);
+  };
+  if(memcmp(h.magic, matrix_file_magic, sizeof h.magic))
+    throw invalid("bad magic");
+  if(h.version != 1)
+    throw invalid("unsupported version");
+  if(h.dtype != (uint32_t)dtype)
+    throw invalid("unsupported dtype");
+  if(h.data_offset < sizeof h || h.data_offset % elem || h.data_offset > length)
+    throw invalid("bad data offset");
+  if(!h.nrow || !h.ncol)
+    return 0;
+  uint64_t extent, t;
+  if(__builtin_mul_overflow(h.nrow - 1, h.srow, &extent) ||
+     __builtin_mul_overflow(h.ncol - 1, h.scol, &t) ||
+     __builtin_add_overflow(t, 1, &t) ||
+     __builtin_add_overflow(extent, t, &extent) ||
+     __builtin_mul_overflow(extent, elem, &extent) ||
+     extent > length - h.data_offset)
+    throw invalid("data exceeds file size");
+  return extent;
+}
+
+uint64_t rotl(uint64_t x, int r)
+{
+  return (x << r) | (x >> (64 - r));
+}
+
+// 保存时使用的矩阵描述，供 for_each_line 使用
+template<class T>
+struct View {
+  typedef T value_type;
+
+  T       *p;
+  size_t  rows, cols, rs, cs;
+
+  size_t nr() const { return rows; }
+  size_t nc() const { return cols; }
+  size_t sr() const { return rs; }
+  size_t sc() const { return cs; }
+  T *ptr() const { return p; }
+  bool empty() const { return !rows || !cols; }
+};
+
+}  // namespace
+
+// 四路 xxHash64 轮函数，尾部逐字节混合
+uint64_t matrix_checksum(const void *p, size_t n, uint64_t seed)
+{
+  constexpr uint64_t P1 = 11400714785074694791ull;
+  constexpr uint64_t P2 = 14029467366897019727ull;
+  constexpr uint64_t P3 = 1609587929392839161ull;
+  const unsigned char *s = (const unsigned char *)p;
+  uint64_t h0 = seed + P1 + P2, h1 = seed + P2, h2 = seed, h3 = seed - P1;
+  size_t i = 0;
+  for(; i + 32 <= n; i += 32)
+  {
+    uint64_t w[4];
+    memcpy(w, s + i, sizeof w);
+    h0 = rotl(h0 + w[0] * P2, 31) * P1;
+    h1 = rotl(h1 + w[1] * P2, 31) * P1;
+    h2 = rotl(h2 + w[2] * P2, 31) * P1;
+    h3 = rotl(h3 + w[3] * P2, 31) * P1;
+  }
+  uint64_t h = rotl(h0, 1) + rotl(h1, 7) + rotl(h2, 12) + rotl(h3, 18) + n;
+  for(; i < n; ++i)
+    h = rotl(h ^ (s[i] * P3), 11) * P1;
+  h ^= h >> 33;
+  h *= P2;
+  h ^= h >> 29;
+  h *= P3;
+  return h ^ (h >> 32);
+}
+
+bool verify_matrix_file(const std::string &path)
+{
+  File file(path, O_RDONLY);
+  size_t length = file.size(path);
+  if(length < sizeof(MatrixFileHeader))
+    return false;
+  Mapping m(file, path, length, PROT_READ, MAP_SHARED);
+  MatrixFileHeader h = *(const MatrixFileHeader *)m.addr;
+  size_t elem;
+  switch((MatrixDType)h.dtype)
+  {
+  case MatrixDType::float32: elem = 4; break;
+  case MatrixDType::float64: elem = 8; break;
+  case MatrixDType::complex128: case MatrixDType::float80: elem = 16; break;
+  default: return false;
+  }
+  size_t bytes;
+  try {
+    bytes = check_header(h, length, path, (MatrixDType)h.dtype, elem);
+  }
+  catch(const std::runtime_error &) {
+    return false;
+  }
+  uint64_t checksum = h.checksum;
+  h.checksum = 0;
+  uint64_t seed = matrix_checksum(&h, sizeof h);
+  return matrix_checksum((const char *)m.addr + h.data_offset, bytes, seed) == checksum;
+}
+
+template<class T>
+BasicMatrix<T> BasicMatrix<T>::map(const std::string &path, bool shared)
+{
+  File file(path, shared ? O_RDWR : O_RDONLY);
+  size_t length = file.size(path);
+  if(length < sizeof(MatrixFileHeader))
+    throw std::runtime_error("invalid matrix file " + path + ": truncated header");
+  Mapping m(file, path, length, PROT_READ | PROT_WRITE, shared ? MAP_SHARED : MAP_PRIVATE);
+  const MatrixFileHeader &h = *(const MatrixFileHeader *)m.addr;
+  check_header(h, length, path, MatrixDTypeOf<T>::value, sizeof(T));
+  T *data = (T *)((char *)m.addr + h.data_offset);
+  return adopt(m, data, h.nrow, h.ncol, h.srow, h.scol);
+}
+
+template<class T>
+BasicMatrix<T> BasicMatrix<T>::adopt(Mapping &m, T *data, size_t nr, size_t nc, size_t sr, size_t sc)
+{
+  size_t size = sizeof(Header) + sizeof(MapRecord);
+  Header *header = new(unmapper.allocate(size)) Header{ {2}, 2, size, &unmapper };
+  MapRecord *r = (MapRecord *)(header + 1);
+  r->addr = m.addr;
+  r->length = m.length;
+  m.release();
+  return BasicMatrix(header, data, nr, nc, sr, sc);
+}
+
+// 先写入临时文件再改名，正在映射旧文件的进程不受影响
+template<class T>
+void BasicMatrix<T>::save(const std::string &path) const
+{
+  size_t ld = leading_dim(nc());
+  size_t count = empty() ? 0 : (nr() - 1) * ld + nc();
+  MatrixFileHeader h = { };
+  memcpy(h.magic, matrix_file_magic, sizeof h.magic);
+  h.version = 1;
+  h.dtype = (uint32_t)MatrixDTypeOf<T>::value;
+  h.nrow = nr();
+  h.ncol = nc();
+  h.srow = ld;
+  h.scol = 1;
+  h.data_offset = sizeof h;
+  size_t length = sizeof h + count * sizeof(T);
+
+  std::string tmp = path + ".tmp";
+  try {
+    File file(tmp, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    // 预先分配磁盘块，空间不足时在此抛出，而不是写入映射区时收到 SIGBUS
+    if(int err = posix_fallocate(file.fd, 0, length))
+      throw std::system_error(err, std::generic_category(), tmp);
+    Mapping m(file, tmp, length, PROT_READ | PROT_WRITE, MAP_SHARED);
+    T *dst = (T *)((char *)m.addr + sizeof h);
+    for_each_line(View<T>{ dst, nr(), nc(), ld, 1 }, View<T>{ ptr(), nr(), nc(), sr(), sc() },
+        element_kernels<T>().assign);
+    h.checksum = matrix_checksum(dst, count * sizeof(T), matrix_checksum(&h, sizeof h));
+    memcpy(m.addr, &h, sizeof h);
+    if(rename(tmp.c_str(), path.c_str()))
+      throw std::system_error(errno, std::generic_category(), path);
+  }
+  catch(...) {
+    unlink(tmp.c_str());
+    throw;
+  }
+}
+
+#define MATRIX_FILE_INSTANTIATE(T) \
+  template BasicMatrix<T> BasicMatrix<T>::map(const std::string &, bool); \
+  template BasicMatrix<T> BasicMatrix<T>::adopt(Mapping &, T *, size_t, size_t, size_t, size_t); \
+  template void BasicMatrix<T>::save(const std::string &) const;
+
+MATRIX_FILE_INSTANTIATE(float)
+MATRIX_FILE_INSTANTIATE(double)
+MATRIX_FILE_INSTANTIATE(long double)
+MATRIX_FILE_INSTANTIATE(std::complex<double>)
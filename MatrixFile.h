@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Basic.h"
+#include <cstdint>
+#include <string>
+#include <complex>
+
+// 二进制矩阵文件格式，所有字段按小端序存储
+//   偏移 0：文件头 MatrixFileHeader，共 64 字节
+//   偏移 data_offset：矩阵元，(i, j) 位于 data_offset + (i * srow + j * scol) * 元素字节数
+// Matrix::save 写出的文件 data_offset 为 64，按行存储，行跳步与新建矩阵相同
+// checksum 依次对 checksum 置 0 的文件头和数据区调用 matrix_checksum 得到，
+// 数据区从 data_offset 起，到最后一个矩阵元结束
+struct MatrixFileHeader {
+  char      magic[8];     // matrix_file_magic
+  uint32_t  version;      // 格式版本，当前为 1
+  uint32_t  dtype;        // 元素类型，见 MatrixDType
+  uint64_t  nrow;         // 行数
+  uint64_t  ncol;         // 列数
+  uint64_t  srow;         // 行跳步，以元素计
+  uint64_t  scol;         // 列跳步，以元素计
+  uint64_t  data_offset;  // 数据区偏移，按元素大小对齐
+  uint64_t  checksum;     // 校验和
+};
+static_assert(sizeof(MatrixFileHeader) == 64);
+
+constexpr char matrix_file_magic[8] = { 'M', 'A', 'T', 'R', 'I', 'X', '\0', '\x1a' };
+
+enum class MatrixDType : uint32_t {
+  float64 = 1,
+  float32 = 2,
+  complex128 = 3,   // 实部、虚部两个 float64
+  float80 = 4,      // x86 扩展精度 long double，每个元素占 16 字节
+};
+
+// 矩阵元类型对应的 MatrixDType
+template<class T> struct MatrixDTypeOf;
+template<> struct MatrixDTypeOf<double> { static constexpr MatrixDType value = MatrixDType::float64; };
+template<> struct MatrixDTypeOf<float> { static constexpr MatrixDType value = MatrixDType::float32; };
+template<> struct MatrixDTypeOf<std::complex<double>> {
+  static constexpr MatrixDType value = MatrixDType::complex128;
+};
+template<> struct MatrixDTypeOf<long double> {
+  static constexpr MatrixDType value = MatrixDType::float80;
+};
+
+// 64 位校验和，seed 用于串接多段数据
+uint64_t matrix_checksum(const void *p, size_t n, uint64_t seed = 0);
+
+// 读取文件并校验文件头和校验和，文件无法读取时抛 system_error
+bool verify_matrix_file(const std::string &path);
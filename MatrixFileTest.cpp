@@ -0,0 +1,261 @@
+#include "TestBasic.h"
+#include "MatrixFile.h"
+#include "Matrix.h"
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <complex>
+#include <system_error>
+#include <ctime>
+#include <unistd.h>
+
+using namespace std;
+
+void test_save_map();
+void test_save_map_types();
+void test_map_private_shared();
+void test_map_assign();
+void test_map_invalid();
+void test_checksum();
+void test_map_repeat();
+
+static string temp_path(const char *name)
+{
+  return "/tmp/MatrixFileTest." + to_string(getpid()) + "." + name;
+}
+
+static void fill_index(const Matrix &A)
+{
+  for(size_t i = 0; i < A.nr(); ++i)
+    for(size_t j = 0; j < A.nc(); ++j)
+      A(i, j) = i * 1000 + j + 0.5;
+}
+
+int main()
+{
+  test_save_map();
+  test_save_map_types();
+  test_map_private_shared();
+  test_map_assign();
+  test_map_invalid();
+  test_checksum();
+  test_map_repeat();
+}
+
+void test_save_map()
+{
+  string path = temp_path("save");
+  for(size_t nr : {0, 1, 7, 100})
+  for(size_t nc : {0, 1, 20, 64})
+  {
+    Matrix A(nr, nc);
+    fill_index(A);
+    A.save(path);
+    assert(verify_matrix_file(path));
+    Matrix B = Matrix::map(path);
+    assert(B.nr() == nr && B.nc() == nc && B == A);
+    assert(B.ref() == 2 && (uintptr_t)B.ptr() % alloc_align == 0);
+
+    // 转置视图按行保存
+    Matrix C(nc, nr);
+    fill_index(C);
+    C.t().save(path);
+    assert(Matrix::map(path) == C.t());
+  }
+
+  // 映射矩阵可与普通矩阵一起运算，视图在映射矩阵析构后保持有效
+  Matrix A(30, 40);
+  fill_index(A);
+  A.save(path);
+  Matrix v = Matrix::map(path).col(3);
+  assert(v == A.col(3));
+  Matrix P = Matrix::map(path).t() * A;
+  assert(P == A.t() * A);
+  remove(path.c_str());
+  TEST_PASSED;
+}
+
+template<class T>
+static void check_save_map_type(const string &path, MatrixDType dtype)
+{
+  BasicMatrix<T> A(13, 9);
+  for(size_t i = 0; i < A.nr(); ++i)
+    for(size_t j = 0; j < A.nc(); ++j)
+      A(i, j) = T(i * 1000 + j) / T(3);
+  A.t().save(path);
+  assert(verify_matrix_file(path));
+  BasicMatrix<T> B = BasicMatrix<T>::map(path);
+  assert(B == A.t());
+  ifstream in(path, ios::binary);
+  MatrixFileHeader h;
+  in.read((char *)&h, sizeof h);
+  assert(h.dtype == (uint32_t)dtype);
+}
+
+// 各矩阵元类型保存和映射，元素类型不符时拒绝映射
+void test_save_map_types()
+{
+  string path = temp_path("types");
+  check_save_map_type<float>(path, MatrixDType::float32);
+  check_save_map_type<long double>(path, MatrixDType::float80);
+  check_save_map_type<complex<double>>(path, MatrixDType::complex128);
+  ASSERT_EXCEPTION(runtime_error, Matrix::map(path);)
+  ASSERT_EXCEPTION(runtime_error, BasicMatrix<float>::map(path);)
+  check_save_map_type<double>(path, MatrixDType::float64);
+  ASSERT_EXCEPTION(runtime_error, BasicMatrix<complex<double>>::map(path);)
+  remove(path.c_str());
+  TEST_PASSED;
+}
+
+void test_map_private_shared()
+{
+  string path = temp_path("shared");
+  Matrix A(10, 20);
+  fill_index(A);
+  A.save(path);
+
+  // 私有映射的写入不影响文件
+  Matrix B = Matrix::map(path);
+  B(3, 4) = -1;
+  assert(Matrix::map(path) == A);
+
+  // 共享映射的写入对其他映射可见并写回文件
+  Matrix C = Matrix::map(path, true);
+  Matrix D = Matrix::map(path, true);
+  C(3, 4) = -1;
+  assert(D(3, 4) == -1);
+  assert(Matrix::map(path)(3, 4) == -1);
+  assert(!verify_matrix_file(path));
+
+  // 保存到正在映射的文件不影响已有映射
+  Matrix E(10, 20);
+  E.fill(7);
+  E.save(path);
+  assert(C(3, 4) == -1 && Matrix::map(path) == E);
+  remove(path.c_str());
+  TEST_PASSED;
+}
+
+// 映射区不被移动赋值换走，也不被右值运算就地改写
+void test_map_assign()
+{
+  string path = temp_path("assign");
+  Matrix A(10, 20), B(10, 10);
+  fill_index(A);
+  fill_index(B);
+  A.save(path);
+
+  Matrix M = Matrix::map(path, true);
+  M = B * A;
+  Matrix P = B * A;
+  assert(M == P && Matrix::map(path) == P);
+  M(3, 4) = -1;
+  assert(Matrix::map(path)(3, 4) == -1);
+
+  Matrix S = Matrix::map(path, true) * 2;
+  assert(S(3, 4) == -2 && Matrix::map(path)(3, 4) == -1);
+  Matrix N = -Matrix::map(path, true);
+  assert(N(3, 4) == 1 && Matrix::map(path)(3, 4) == -1);
+  remove(path.c_str());
+  TEST_PASSED;
+}
+
+void test_map_invalid()
+{
+  string path = temp_path("invalid");
+  remove(path.c_str());
+  ASSERT_EXCEPTION(system_error, Matrix::map(path);)
+  ASSERT_EXCEPTION(system_error, verify_matrix_file(path);)
+  ASSERT_EXCEPTION(system_error, Matrix(2, 2).save("/nonexistent/dir/file");)
+
+  ofstream(path) << "not a matrix";
+  ASSERT_EXCEPTION(runtime_error, Matrix::map(path);)
+  assert(!verify_matrix_file(path));
+
+  // 篡改文件头
+  Matrix A(5, 5);
+  fill_index(A);
+  auto poke = [&](size_t offset, uint64_t value) {
+    FILE *f = fopen(path.c_str(), "r+b");
+    fseek(f, offset, SEEK_SET);
+    fwrite(&value, sizeof value, 1, f);
+    fclose(f);
+  };
+  auto patch = [&](size_t offset, uint64_t value) {
+    A.save(path);
+    poke(offset, value);
+  };
+  patch(0, 0);                                              // magic
+  ASSERT_EXCEPTION(runtime_error, Matrix::map(path);)
+  patch(offsetof(MatrixFileHeader, version), 2);            // version 和 dtype
+  ASSERT_EXCEPTION(runtime_error, Matrix::map(path);)
+  patch(offsetof(MatrixFileHeader, nrow), 6);
+  ASSERT_EXCEPTION(runtime_error, Matrix::map(path);)
+  patch(offsetof(MatrixFileHeader, srow), UINT64_MAX / 2);
+  ASSERT_EXCEPTION(runtime_error, Matrix::map(path);)
+  patch(offsetof(MatrixFileHeader, data_offset), 4);
+  ASSERT_EXCEPTION(runtime_error, Matrix::map(path);)
+  patch(offsetof(MatrixFileHeader, data_offset), 1 << 20);
+  ASSERT_EXCEPTION(runtime_error, Matrix::map(path);)
+
+  // 末元位置加一回绕为 0，元素 (0, 1) 将落在数据区之前
+  patch(offsetof(MatrixFileHeader, nrow), 1);
+  poke(offsetof(MatrixFileHeader, ncol), 2);
+  poke(offsetof(MatrixFileHeader, scol), UINT64_MAX);
+  ASSERT_EXCEPTION(runtime_error, Matrix::map(path);)
+  poke(offsetof(MatrixFileHeader, scol), UINT64_MAX / 8 + 1);
+  ASSERT_EXCEPTION(runtime_error, Matrix::map(path);)
+
+  // 未篡改结构的文件可映射，校验和可发现数据错误
+  patch(sizeof(MatrixFileHeader) + 8, 0);
+  assert(Matrix::map(path)(0, 1) == 0);
+  assert(!verify_matrix_file(path));
+  remove(path.c_str());
+  TEST_PASSED;
+}
+
+void test_checksum()
+{
+  char buf[100];
+  for(size_t i = 0; i < sizeof buf; ++i)
+    buf[i] = i;
+  uint64_t c = matrix_checksum(buf, sizeof buf);
+  assert(c == matrix_checksum(buf, sizeof buf));
+  assert(c != matrix_checksum(buf, sizeof buf, 1));
+  assert(c != matrix_checksum(buf, sizeof buf - 1));
+  for(size_t i : {0, 31, 32, 99})
+  {
+    buf[i] ^= 1;
+    assert(c != matrix_checksum(buf, sizeof buf));
+    buf[i] ^= 1;
+  }
+  TEST_PASSED;
+}
+
+void test_map_repeat()
+{
+  string path = temp_path("repeat");
+  size_t n = 4096;
+  Matrix A(n, n);
+  A.fill(1);
+  clock_t start = clock();
+  A.save(path);
+  clock_t diff = clock() - start;
+  cout << "It took " << (double)diff / CLOCKS_PER_SEC << " s to save a "
+       << n << "x" << n << " matrix." << endl;
+
+  start = clock();
+  for(int t = 0; t < 1000; ++t)
+    Matrix::map(path);
+  diff = clock() - start;
+  cout << "It took " << (double)diff / CLOCKS_PER_SEC << " s to map it 1000 times." << endl;
+
+  start = clock();
+  assert(verify_matrix_file(path));
+  diff = clock() - start;
+  cout << "It took " << (double)diff / CLOCKS_PER_SEC << " s to verify it." << endl;
+  remove(path.c_str());
+  TEST_PASSED;
+}
@@ -1,11 +1,14 @@
 #include "TestBasic.h"
 #include "Matrix.h"
+#include "ThreadPool.h"
 #include <cstdint>
 #include <type_traits>
 #include <vector>
 #include <deque>
 #include <ctime>
 #include <cstdlib>
+#include <cmath>
+#include <complex>
 
 using namespace std;
 
@@ -29,12 +32,15 @@ class MatrixTest {
 private:
   Matrix get_Matrix_3_3() const;
   void test_Number() const;
-  void test_Matrix_nmax() const;
+  void test_Matrix_size() const;
+  void test_Matrix_layout() const;
   void test_Matrix_nr_nc() const;
+  void test_Matrix_large() const;
   void test_Matrix_init(const Matrix &, size_t nr, size_t nc) const;
   void test_Matrix_Matrix() const;
   void test_Matrix_Matrix_repeat() const;
   void test_Matrix_reset() const;
+  void test_Matrix_move() const;
   void test_Matrix_assign() const;
   void test_Matrix_assign_repeat() const;
   void test_Matrix_copy() const;
@@ -45,9 +51,22 @@ private:
   void test_Matrix_swap() const;
   void test_Matrix_dot() const;
   void test_Matrix_dot_repeat() const;
+  void test_Matrix_dot_blocked() const;
+  void test_Matrix_dot_large() const;
   void test_Matrix_pn() const;
   void test_Matrix_cplus_cminus() const;
   void test_Matrix_cmultiplies() const;
+  void test_Matrix_cops_views() const;
+  void test_Matrix_cops_repeat() const;
+  void test_Matrix_expr() const;
+  void test_Matrix_expr_alias() const;
+  void test_Matrix_expr_repeat() const;
+  void test_Matrix_rvalue_ops() const;
+  void test_Matrix_rvalue_repeat() const;
+  template<class T>
+    void test_Matrix_typed(double eps) const;
+  void test_Matrix_types() const;
+  void test_Matrix_dot_float_repeat() const;
 public:
   void test() const;
 };
@@ -60,11 +79,14 @@ int main()
 void MatrixTest::test() const
 {
   test_Number();
-  test_Matrix_nmax();
+  test_Matrix_size();
+  test_Matrix_layout();
   test_Matrix_nr_nc();
+  test_Matrix_large();
   test_Matrix_Matrix();
   test_Matrix_Matrix_repeat();
   test_Matrix_reset();
+  test_Matrix_move();
   test_Matrix_assign();
   test_Matrix_assign_repeat();
   test_Matrix_copy();
@@ -75,9 +97,20 @@ void MatrixTest::test() const
   test_Matrix_swap();
   test_Matrix_dot();
   test_Matrix_dot_repeat();
+  test_Matrix_dot_blocked();
+  test_Matrix_dot_large();
   test_Matrix_pn();
   test_Matrix_cplus_cminus();
   test_Matrix_cmultiplies();
+  test_Matrix_cops_views();
+  test_Matrix_cops_repeat();
+  test_Matrix_expr();
+  test_Matrix_expr_alias();
+  test_Matrix_expr_repeat();
+  test_Matrix_rvalue_ops();
+  test_Matrix_rvalue_repeat();
+  test_Matrix_types();
+  test_Matrix_dot_float_repeat();
 }
 
 Matrix MatrixTest::get_Matrix_3_3() const
@@ -94,52 +127,115 @@ void MatrixTest::test_Number() const
   TEST_PASSED;
 }
 
-void MatrixTest::test_Matrix_nmax() const
+void MatrixTest::test_Matrix_size() const
 {
-  // 需要保证
-  //   nmax * nmax * sizeof(Number) + sizeof(size_t)
-  // 不溢出
-  uint64_t n = Matrix::nmax, size = ~sizeof(size_t);
-  assert(n < ((uint64_t)1 << 32));
-  assert(n * n <= size / sizeof(Number));
+  // 数据区字节数
+  //   ((nr - 1) * leading_dim(nc) + nc) * sizeof(Number) + sizeof(Header)
+  // 溢出时抛 out_of_range
+  size_t big = SIZE_MAX / sizeof(Number);
+  ASSERT_EXCEPTION(out_of_range, Matrix(big, 2);)
+  ASSERT_EXCEPTION(out_of_range, Matrix(2, big);)
+  ASSERT_EXCEPTION(out_of_range, Matrix(SIZE_MAX, SIZE_MAX);)
+  ASSERT_EXCEPTION(out_of_range, Matrix((size_t)1 << 32, (size_t)1 << 32);)
+  ASSERT_EXCEPTION(out_of_range, Matrix(1, SIZE_MAX);)
   TEST_PASSED;
 }
 
-void MatrixTest::test_Matrix_nr_nc() const
+void MatrixTest::test_Matrix_layout() const
 {
-  size_t nmax = Matrix::nmax;
+  // 窄矩阵不补齐
+  assert(Matrix::leading_dim(0) == 0);
+  assert(Matrix::leading_dim(3) == 3);
+  assert(Matrix::leading_dim(Matrix::pad_min - 1) == Matrix::pad_min - 1);
+  // 补齐到整缓存行，行长为 512 字节整数倍时错开
+  assert(Matrix::leading_dim(16) == 16);
+  assert(Matrix::leading_dim(100) == 104);
+  assert(Matrix::leading_dim(64) == 72);
+  assert(Matrix::leading_dim(1024) == 1032);
+  assert(Matrix::leading_dim(4096) == 4104);
+
+  // 补齐不影响按行按列访问和整体运算
+  Matrix A(5, 20), B(5, 20);
+  assert(A.sr() == 24);
+  for(size_t i = 0; i < A.nr(); ++i)
+    for(size_t j = 0; j < A.nc(); ++j)
+    {
+      A(i, j) = i * 20 + j;
+      assert((uintptr_t)&A(i, 0) % alloc_align == 0);
+    }
+  B = A;
+  B += A * 2;
+  for(size_t i = 0; i < A.nr(); ++i)
+    for(size_t j = 0; j < A.nc(); ++j)
+      assert(B(i, j) == 3 * A(i, j));
+  TEST_PASSED;
+}
 
+void MatrixTest::test_Matrix_nr_nc() const
+{
   // 测试行数和列数极限值
   test_Matrix_init(Matrix(0, 0), 0, 0);
-  test_Matrix_init(Matrix(0, nmax), 0, nmax);
-  test_Matrix_init(Matrix(nmax, 0), nmax, 0);
-  test_Matrix_init(Matrix(nmax, nmax), nmax, nmax);
-
-  // 测试大于 nmax 的行数或列数
-  ASSERT_EXCEPTION(out_of_range, Matrix(nmax + 1, 0);)
-  ASSERT_EXCEPTION(out_of_range, Matrix(0, nmax + 1);)
-  ASSERT_EXCEPTION(out_of_range, Matrix(nmax + 1, nmax + 1);)
+  test_Matrix_init(Matrix(0, SIZE_MAX), 0, SIZE_MAX);
+  test_Matrix_init(Matrix(SIZE_MAX, 0), SIZE_MAX, 0);
+  test_Matrix_init(Matrix(1 << 14, 1 << 14), 1 << 14, 1 << 14);
 
   // 测试内存分配失败时的行为
+  ASSERT_EXCEPTION(bad_alloc, Matrix((size_t)1 << 24, (size_t)1 << 24);)
   ASSERT_EXCEPTION(bad_alloc,
     vector<Matrix> matrices;
     for(;;)
     {
-      matrices.emplace_back(nmax, nmax);
-      test_Matrix_init(matrices.back(), nmax, nmax);
+      matrices.emplace_back(1 << 16, 1 << 16);
+      test_Matrix_init(matrices.back(), 1 << 16, 1 << 16);
     }
   )
 
   TEST_PASSED;
 }
 
+// 单一维度超过 16383 的矩阵
+void MatrixTest::test_Matrix_large() const
+{
+  size_t n = 100000;
+  Matrix A(n, 8);
+  for(size_t i = 0; i < n; ++i)
+    for(size_t j = 0; j < 8; ++j)
+      A(i, j) = (Number)(i % 10) + j;
+  assert(&A(n - 1, 7) == A.ptr() + (n - 1) * 8 + 7);
+  assert(A.col_end(3) - A.col_begin(3) == (ptrdiff_t)n);
+  assert(A.col_begin(3) - A.col_end(3) == -(ptrdiff_t)n);
+  assert(&*(A.col_end(3) - n) == &A(0, 3));
+
+  // 100000 x 8 的乘积与逐项求和一致
+  Matrix G = A.t() * A;
+  for(size_t j = 0; j < 8; ++j)
+    for(size_t k = 0; k < 8; ++k)
+    {
+      Number g = 0;
+      for(size_t d = 0; d < 10; ++d)
+        g += (Number)(d + j) * (d + k);
+      assert(G(j, k) == g * (n / 10));
+    }
+
+  // 超过 huge_alloc_min 的矩阵由大页映射，首元素仍按缓存行对齐
+  Matrix B(20000, 600), C(600, 20000);
+  assert(B.sr() * B.nr() * sizeof(Number) >= huge_alloc_min);
+  assert((uintptr_t)B.ptr() % huge_page == alloc_align);
+  B.fill(1);
+  C = B.t() * 2;
+  assert(C(599, 19999) == 2 && C.row_slice(599).t() == B.col(599) * 2);
+  TEST_PASSED;
+}
+
 void MatrixTest::test_Matrix_init(
     const Matrix &matrix, size_t nr, size_t nc) const
 {
   assert(matrix.refc);
-  assert((void *)matrix.data == (void *)&matrix.refc[1]);
+  assert((void *)matrix.data == (void *)((Matrix::Header *)matrix.refc + 1));
   assert(*matrix.refc == 1);
-  assert(matrix.ncol == matrix.srow);
+  assert(matrix.srow == Matrix::leading_dim(nc));
+  assert((uintptr_t)matrix.data % alloc_align == 0);
+  assert((uintptr_t)matrix.refc % alloc_align == 0);
   assert(matrix.scol == 1);
   assert(matrix.nrow == nr);
   assert(matrix.ncol == nc);
@@ -200,6 +296,53 @@ void MatrixTest::test_Matrix_reset() const
   TEST_PASSED;
 }
 
+void MatrixTest::test_Matrix_move() const
+{
+  // 移动构造接管数据区
+  Matrix A = get_Matrix_3_3();
+  Number *data = A.data;
+  Matrix B(std::move(A));
+  assert(B.data == data && *B.refc == 1);
+  assert(!A.refc && A.empty() && A.ref() == 0);
+
+  // 双方均独占数据区时交换
+  Matrix C = get_Matrix_3_3(), D(3, 3);
+  data = C.data;
+  D = std::move(C);
+  assert(D.data == data && D == B);
+  assert(C.ref() == 1);
+
+  // 目标共享数据区时逐元素拷贝，共享者可见
+  Matrix E(3, 3), F = E, G = get_Matrix_3_3();
+  data = G.data;
+  E = std::move(G);
+  assert(E.data != data && F == B);
+
+  // 源共享数据区时逐元素拷贝，源不受影响
+  Matrix H(3, 3), I = get_Matrix_3_3(), J = I;
+  H = std::move(I);
+  assert(H.refc != J.refc && H == J);
+  H(0, 0) = 100;
+  assert(J(0, 0) != 100);
+
+  // 切片视图仍按值写入
+  Matrix K(4, 4);
+  K.fill(0);
+  K.slice(1, 4) = get_Matrix_3_3();
+  assert(K.slice(1, 4) == B && K(0, 0) == 0);
+
+  ASSERT_EXCEPTION(domain_error, D = Matrix(2, 3);)
+
+  // 不持有数据区的对象重新获得数据区
+  A = std::move(D);
+  assert(A == B && *A.refc == 1);
+  B = std::move(F);
+  Matrix L = std::move(B), M = L;
+  B = std::move(M);
+  assert(B.refc != L.refc && B == L);
+  TEST_PASSED;
+}
+
 void MatrixTest::test_Matrix_assign() const
 {
   Matrix(0, 0) = Matrix(0, 0);
@@ -256,10 +399,10 @@ void MatrixTest::test_Matrix_elem() const
     StepIterator iter = matrix.row_begin(i);
     for(size_t j = 0; j < ncol; ++j)
     {
-      assert(&matrix[i][j] == &matrix(0, 0) + i * ncol + j);
-      assert(&matrix(i, j) == &matrix(0, 0) + i * ncol + j);
+      assert(&matrix[i][j] == &matrix(0, 0) + i * matrix.srow + j);
+      assert(&matrix(i, j) == &matrix(0, 0) + i * matrix.srow + j);
       assert(iter < matrix.row_end(i));
-      assert(&*iter == &matrix(0, 0) + i * ncol + j);
+      assert(&*iter == &matrix(0, 0) + i * matrix.srow + j);
       ++iter;
     }
     assert(iter == matrix.row_end(i));
@@ -270,7 +413,7 @@ void MatrixTest::test_Matrix_elem() const
     for(size_t i = 0; i < nrow; ++i)
     {
       assert(iter < matrix.col_end(j));
-      assert(&*iter == &matrix(0, 0) + i * ncol + j);
+      assert(&*iter == &matrix(0, 0) + i * matrix.srow + j);
       ++iter;
     }
     assert(iter == matrix.col_end(j));
@@ -381,6 +524,96 @@ void MatrixTest::test_Matrix_dot_repeat() const
   TEST_PASSED;
 }
 
+// 随机填充矩阵
+template<class T>
+static void fill_random(const BasicMatrix<T> &A)
+{
+  for(size_t i = 0; i < A.nr(); ++i)
+    for(size_t j = 0; j < A.nc(); ++j)
+      if constexpr(is_same_v<T, complex<double>>)
+        A(i, j) = T((double)rand() / RAND_MAX - 0.5, (double)rand() / RAND_MAX - 0.5);
+      else
+        A(i, j) = (double)rand() / RAND_MAX - 0.5;
+}
+
+// 按定义计算矩阵乘积，与 A * B 比较
+static void check_dot(const Matrix &A, const Matrix &B)
+{
+  Matrix C = A * B;
+  assert(C.nr() == A.nr() && C.nc() == B.nc());
+  for(size_t i = 0; i < C.nr(); ++i)
+    for(size_t j = 0; j < C.nc(); ++j)
+    {
+      double c = 0;
+      for(size_t k = 0; k < A.nc(); ++k)
+        c += A(i, k) * B(k, j);
+      assert(fabs(C(i, j) - c) <= 1e-12 * (A.nc() + 1));
+    }
+}
+
+void MatrixTest::test_Matrix_dot_blocked() const
+{
+  size_t shapes[][3] = {
+    {1, 1, 1}, {0, 5, 3}, {4, 0, 3}, {4, 5, 0}, {37, 53, 41},
+    {100, 70, 300}, {257, 131, 600}, {33, 1025, 17}, {600, 7, 9},
+  };
+  for(size_t nt : {1, 4})
+  for(auto [m, n, k] : shapes)
+  {
+    set_num_threads(nt);
+    Matrix A(m, k), B(k, n);
+    fill_random(A);
+    fill_random(B);
+    check_dot(A, B);
+
+    // 转置视图
+    Matrix At = A.t().copy(), Bt = B.t().copy();
+    check_dot(At.t(), B);
+    check_dot(A, Bt.t());
+    check_dot(At.t(), Bt.t());
+
+    // 切片视图
+    Matrix Ab(m + 3, k + 5), Bb(k + 2, n + 7);
+    fill_random(Ab);
+    fill_random(Bb);
+    check_dot(Ab.slice(2, m + 2, 3, k + 3), Bb.slice(1, k + 1, 4, n + 4));
+    check_dot(Bb.slice(1, k + 1, 4, n + 4).t(), Ab.slice(2, m + 2, 3, k + 3).t());
+  }
+
+  set_num_threads(0);
+
+  // 空内积维度的结果为零矩阵
+  Matrix Z = Matrix(3, 0) * Matrix(0, 4);
+  for(size_t i = 0; i < Z.nr(); ++i)
+    for(size_t j = 0; j < Z.nc(); ++j)
+      assert(Z(i, j) == 0);
+
+  TEST_PASSED;
+}
+
+void MatrixTest::test_Matrix_dot_large() const
+{
+  size_t n = 1024;
+  Matrix A(n, n), B(n, n);
+  fill_random(A);
+  fill_random(B);
+  clock_t start = clock();
+  Matrix C = A * B;
+  clock_t diff = clock() - start;
+  double seconds = (double)diff / CLOCKS_PER_SEC;
+  cout << "It took " << seconds << " s to dot two " << n << "x" << n
+       << " matrices (" << 2e-9 * n * n * n / seconds << " GFLOPS)." << endl;
+  for(size_t t = 0; t < 16; ++t)
+  {
+    size_t i = rand() % n, j = rand() % n;
+    double c = 0;
+    for(size_t k = 0; k < n; ++k)
+      c += A(i, k) * B(k, j);
+    assert(fabs(C(i, j) - c) <= 1e-12 * n);
+  }
+  TEST_PASSED;
+}
+
 void MatrixTest::test_Matrix_pn() const
 {
   Matrix A = get_Matrix_3_3();
@@ -405,7 +638,7 @@ void MatrixTest::test_Matrix_pn() const
 void MatrixTest::test_Matrix_cplus_cminus() const
 {
   Matrix A = get_Matrix_3_3(), Ac = A.copy();
-  size_t *refc = A.refc;
+  auto *refc = A.refc;
 
   A += A;
   assert(A.refc == refc);
@@ -439,7 +672,7 @@ void MatrixTest::test_Matrix_cplus_cminus() const
 void MatrixTest::test_Matrix_cmultiplies() const
 {
   Matrix A = get_Matrix_3_3(), Ac = A.copy();
-  size_t *refc = A.refc;
+  auto *refc = A.refc;
 
   A *= 3;
   assert(A.refc == refc);
@@ -457,3 +690,303 @@ void MatrixTest::test_Matrix_cmultiplies() const
 
   TEST_PASSED;
 }
+
+void MatrixTest::test_Matrix_cops_views() const
+{
+  Matrix A(13, 17), B(17, 13);
+  fill_random(A);
+  fill_random(B);
+
+  // 转置、切片和整块视图混合运算
+  Matrix views[][2] = {
+    {A, B.t()},
+    {A.t(), B},
+    {A.slice(1, 12, 2, 15), B.slice(2, 15, 1, 12).t()},
+    {A.col(3), B.row(5).t()},
+    {A.row(4).t(), B.col(6)},
+  };
+  for(auto &[Y, X] : views)
+  {
+    Matrix Y0 = Y.copy();
+    Y += X;
+    for(size_t i = 0; i < Y.nr(); ++i)
+      for(size_t j = 0; j < Y.nc(); ++j)
+        assert(Y(i, j) == Y0(i, j) + X(i, j));
+    Y = Y0;
+    Y -= X;
+    for(size_t i = 0; i < Y.nr(); ++i)
+      for(size_t j = 0; j < Y.nc(); ++j)
+        assert(Y(i, j) == Y0(i, j) - X(i, j));
+    Y = Y0;
+    Y *= 3;
+    Y /= 4;
+    for(size_t i = 0; i < Y.nr(); ++i)
+      for(size_t j = 0; j < Y.nc(); ++j)
+        assert(Y(i, j) == Y0(i, j) * 3 / 4);
+    Matrix N = -X;
+    for(size_t i = 0; i < N.nr(); ++i)
+      for(size_t j = 0; j < N.nc(); ++j)
+        assert(N(i, j) == -X(i, j));
+    Y = X;
+    assert(Y == X);
+    Y.fill(3);
+    for(size_t i = 0; i < Y.nr(); ++i)
+      for(size_t j = 0; j < Y.nc(); ++j)
+        assert(Y(i, j) == 3);
+  }
+  TEST_PASSED;
+}
+
+void MatrixTest::test_Matrix_cops_repeat() const
+{
+  size_t n = 2048;
+  Matrix A(n, n), B(n, n);
+  A.fill(1);
+  B.fill(2);
+  clock_t start = clock();
+  for(int t = 0; t < 10; ++t)
+    A += B;
+  clock_t diff = clock() - start;
+  double seconds = (double)diff / CLOCKS_PER_SEC;
+  cout << "It took " << seconds << " s to add two " << n << "x" << n
+       << " matrices 10 times (" << 10 * 3 * n * n * sizeof(Number) / seconds / 1e9
+       << " GB/s)." << endl;
+  assert(A(n - 1, n - 1) == 21);
+  TEST_PASSED;
+}
+
+void MatrixTest::test_Matrix_expr() const
+{
+  Matrix A(5, 4), B(5, 4), C(5, 4);
+  fill_random(A);
+  fill_random(B);
+  fill_random(C);
+
+  // 表达式持有操作数引用，求值前不分配内存
+  {
+    auto e = A + B * 3 - C;
+    assert(*A.refc == 2 && *B.refc == 2 && *C.refc == 2);
+    Matrix R = e;
+    for(size_t i = 0; i < R.nr(); ++i)
+      for(size_t j = 0; j < R.nc(); ++j)
+        assert(R(i, j) == A(i, j) + B(i, j) * 3 - C(i, j));
+  }
+  assert(*A.refc == 1 && *B.refc == 1 && *C.refc == 1);
+
+  Matrix R(5, 4);
+  R = 2 * (A - B) / 4 + -C;
+  for(size_t i = 0; i < R.nr(); ++i)
+    for(size_t j = 0; j < R.nc(); ++j)
+      assert(R(i, j) == 2 * (A(i, j) - B(i, j)) / 4 + -C(i, j));
+
+  R += A * 2;
+  R -= A + A;
+  for(size_t i = 0; i < R.nr(); ++i)
+    for(size_t j = 0; j < R.nc(); ++j)
+      assert(R(i, j) == 2 * (A(i, j) - B(i, j)) / 4 + -C(i, j) + A(i, j) * 2 - (A(i, j) + A(i, j)));
+
+  // 表达式参与矩阵乘法和比较
+  Matrix P = (A + B) * C.t();
+  Matrix S = A + B;
+  assert(P == S * C.t());
+  assert(A + B == S);
+
+  // 形状不一致
+  ASSERT_EXCEPTION(domain_error, A + Matrix(4, 5);)
+  ASSERT_EXCEPTION(domain_error, R = A.t() * 2;)
+  ASSERT_EXCEPTION(domain_error, Matrix(4, 5) += A - B;)
+
+  TEST_PASSED;
+}
+
+void MatrixTest::test_Matrix_expr_alias() const
+{
+  Matrix A(6, 6), B(6, 6);
+  fill_random(A);
+  fill_random(B);
+
+  // 与目标完全重合的操作数可直接融合
+  Matrix A0 = A.copy();
+  A = A * 2 + B;
+  for(size_t i = 0; i < A.nr(); ++i)
+    for(size_t j = 0; j < A.nc(); ++j)
+      assert(A(i, j) == A0(i, j) * 2 + B(i, j));
+
+  // 与目标部分重叠的转置或平移视图须先求值
+  A0 = A;
+  A = A.t() - B;
+  for(size_t i = 0; i < A.nr(); ++i)
+    for(size_t j = 0; j < A.nc(); ++j)
+      assert(A(i, j) == A0(j, i) - B(i, j));
+
+  A0 = A;
+  A.slice(1, 6, 0, 6) += A.slice(0, 5, 0, 6) * 3;
+  for(size_t i = 1; i < A.nr(); ++i)
+    for(size_t j = 0; j < A.nc(); ++j)
+      assert(A(i, j) == A0(i, j) + A0(i - 1, j) * 3);
+
+  // 高斯消元中的行变换互不重叠
+  A0 = A;
+  Number k = A(2, 0);
+  A.row(2) -= A(2, 0) * A.row(0);
+  for(size_t j = 0; j < A.nc(); ++j)
+    assert(A(2, j) == A0(2, j) - k * A0(0, j));
+
+  TEST_PASSED;
+}
+
+void MatrixTest::test_Matrix_expr_repeat() const
+{
+  size_t n = 2048;
+  Matrix A(n, n), B(n, n), C(n, n), R(n, n);
+  A.fill(1);
+  B.fill(2);
+  C.fill(3);
+  clock_t start = clock();
+  for(int t = 0; t < 10; ++t)
+    R = A + B * 0.5 - C;
+  clock_t diff = clock() - start;
+  cout << "It took " << (double)diff / CLOCKS_PER_SEC << " s to evaluate A + B * k - C on "
+       << n << "x" << n << " matrices 10 times." << endl;
+  assert(R(n - 1, n - 1) == -1);
+  TEST_PASSED;
+}
+
+void MatrixTest::test_Matrix_rvalue_ops() const
+{
+  Matrix A(5, 4), B(5, 4), C(4, 5), I(4, 4);
+  srand(time(NULL));
+  for(Matrix *M : {&A, &B, &C})
+    for(size_t i = 0; i < M->nr(); ++i)
+      for(size_t j = 0; j < M->nc(); ++j)
+        (*M)(i, j) = rand() % 17 - 8;
+  for(size_t i = 0; i < 4; ++i)
+    for(size_t j = 0; j < 4; ++j)
+      I(i, j) = i == j;
+
+  // 独占的临时量就地计算
+  Matrix T = A * I;
+  Number *data = T.data;
+  Matrix R = std::move(T) + B;
+  assert(R.data == data && R == A + B);
+  R = B - A * I;
+  assert(R == B - A);
+  Matrix S = A * I * 2 - B * 0.5;
+  assert(S == 2 * A - B / 2);
+  S = (A * I) / 4 + (B * I);
+  assert(S == A / 4 + B);
+  S = -(A * I);
+  assert(S == -A);
+  S = 3 * (A * I) - (B * I);
+  assert(S == A * 3 - B);
+  S = (A + B) - A * I;
+  assert(S == B);
+
+  // 共享的临时量不被改写
+  Matrix U = A * I, V = U;
+  S = std::move(U) + B;
+  assert(V == A && S == A + B);
+  S = std::move(V) * 2;
+  assert(U == A && S == 2 * A);
+  S = -std::move(U);
+  assert(V == A && S == -A);
+
+  ASSERT_EXCEPTION(domain_error, A * I + C;)
+  ASSERT_EXCEPTION(domain_error, C - A * I;)
+  ASSERT_EXCEPTION(domain_error, A * I - C * 2;)
+  TEST_PASSED;
+}
+
+void MatrixTest::test_Matrix_rvalue_repeat() const
+{
+  Matrix A(3, 3), B = get_Matrix_3_3(), R(3, 3);
+  A.fill(1);
+  clock_t start = clock();
+  for(int t = 0; t < 100000; ++t)
+    R = (A * B) * 2 + A - B / 4;
+  clock_t diff = clock() - start;
+  cout << "It took " << (double)diff / CLOCKS_PER_SEC
+       << " s to evaluate (A * B) * k + A - B / k on 3x3 matrices 100000 times." << endl;
+  TEST_PASSED;
+}
+
+// 各矩阵元类型的构造、逐元素运算、表达式和乘法，乘法与按定义计算的结果比较
+template<class T>
+void MatrixTest::test_Matrix_typed(double eps) const
+{
+  static_assert(is_same_v<typename BasicMatrix<T>::value_type, T>);
+  BasicMatrix<T> A(37, 45), B(37, 45), C(45, 29);
+  fill_random(A);
+  fill_random(B);
+  fill_random(C);
+  assert(A.ref() == 1 && (uintptr_t)A.ptr() % alloc_align == 0);
+
+  BasicMatrix<T> R = A * 2 - B / 4 + -A;
+  for(size_t i = 0; i < A.nr(); ++i)
+    for(size_t j = 0; j < A.nc(); ++j)
+      assert(abs(R(i, j) - (A(i, j) - B(i, j) / T(4))) <= eps);
+  R += A;
+  R -= B.t().t();
+  R *= 2;
+  R /= 2;
+  BasicMatrix<T> S = std::move(R) + B / 4;
+  for(size_t i = 0; i < A.nr(); ++i)
+    for(size_t j = 0; j < A.nc(); ++j)
+      assert(abs(S(i, j) - (A(i, j) * T(2) - B(i, j))) <= eps);
+  S.row_slice(3, 5).fill(1);
+  assert(S(4, 7) == T(1) && S == S.copy() && S != A);
+
+  BasicMatrix<T> P = (A + B) * C, Q = A.t().t() * C;
+  for(size_t i = 0; i < P.nr(); ++i)
+    for(size_t j = 0; j < P.nc(); ++j)
+    {
+      T p = 0, q = 0;
+      for(size_t k = 0; k < C.nr(); ++k)
+      {
+        p += (A(i, k) + B(i, k)) * C(k, j);
+        q += A(i, k) * C(k, j);
+      }
+      assert(abs(P(i, j) - p) <= eps * C.nr() && abs(Q(i, j) - q) <= eps * C.nr());
+    }
+  ASSERT_EXCEPTION(domain_error, A * B;)
+  ASSERT_EXCEPTION(domain_error, A + C;)
+}
+
+void MatrixTest::test_Matrix_types() const
+{
+  test_Matrix_typed<float>(1e-5);
+  test_Matrix_typed<double>(1e-13);
+  test_Matrix_typed<long double>(1e-16);
+  test_Matrix_typed<complex<double>>(1e-13);
+
+  BasicMatrix<complex<double>> Z(1, 2);
+  Z(0, 0) = complex<double>(1, 2);
+  Z(0, 1) = complex<double>(0, -1);
+  BasicMatrix<complex<double>> W = Z.t() * Z;
+  assert(W(0, 0) == complex<double>(-3, 4) && W(1, 1) == complex<double>(-1, 0));
+  cout << Z << endl;
+  TEST_PASSED;
+}
+
+void MatrixTest::test_Matrix_dot_float_repeat() const
+{
+  size_t n = 1024;
+  BasicMatrix<float> A(n, n), B(n, n);
+  fill_random(A);
+  fill_random(B);
+  clock_t start = clock();
+  BasicMatrix<float> C = A * B;
+  clock_t diff = clock() - start;
+  double seconds = (double)diff / CLOCKS_PER_SEC;
+  cout << "It took " << seconds << " s to dot two " << n << "x" << n
+       << " float matrices (" << 2e-9 * n * n * n / seconds << " GFLOPS)." << endl;
+  for(size_t t = 0; t < 16; ++t)
+  {
+    size_t i = rand() % n, j = rand() % n;
+    double c = 0;
+    for(size_t k = 0; k < n; ++k)
+      c += (double)A(i, k) * B(k, j);
+    assert(fabs(C(i, j) - c) <= 1e-5 * n);
+  }
+  TEST_PASSED;
+}
@@ -0,0 +1,228 @@
+#include "MatrixText.h"
+#include "Matrix.h"
+#include "ThreadPool.h"
+#include <charconv>
+#include <algorithm>
+#include <vector>
+#include <stdexcept>
+#include <system_error>
+#include <cerrno>
+#include <cstring>
+#include <cstdio>
+#include <iostream>
+#include <iterator>
+
+namespace {
+
+constexpr size_t parse_chunk = 1 << 20;   // 并行解析的分块字节数
+constexpr size_t format_chunk = 1 << 20;  // 并行格式化的分块字节数（估计）
+constexpr size_t number_max = 32;         // 最短往返表示的最大字符数
+
+bool is_separator(char c)
+{
+  return c == ' ' || c == '\t' || c == '\r' || c == ',' || c == '\v' || c == '\f';
+}
+
+// 一段以行为边界的文本的解析结果
+struct Chunk {
+  const char           *begin;
+  const char           *end;
+  std::vector<Number>  values;
+  size_t               rows = 0;
+  size_t               cols = 0;
+  const char           *error = nullptr;  // 出错位置
+  const char           *what = nullptr;
+
+  Chunk(const char *b, const char *e) : begin(b), end(e) { }
+  void parse();
+};
+
+void Chunk::parse()
+{
+  values.reserve((end - begin) / 8);
+  const char *p = begin;
+  while(p < end)
+  {
+    size_t n = 0;
+    const char *line = p;
+    for(;;)
+    {
+      while(p < end && is_separator(*p))
+        ++p;
+      if(p == end || *p == '\n')
+        break;
+      Number v;
+      auto [q, ec] = std::from_chars(p, end, v);
+      if(ec != std::errc() || (q < end && !is_separator(*q) && *q != '\n'))
+      {
+        error = p;
+        what = "invalid number";
+        return;
+      }
+      values.push_back(v);
+      ++n;
+      p = q;
+    }
+    if(p < end)
+      ++p;
+    if(!n)
+      continue;
+    if(!rows)
+      cols = n;
+    else if(n != cols)
+    {
+      error = line;
+      what = "inconsistent row length";
+      return;
+    }
+    ++rows;
+  }
+}
+
+[[noreturn]] void parse_error(std::string_view text, const char *pos, const char *what)
+{
+  size_t line = 1 + std::count(text.data(), pos, '\n');
+  throw std::invalid_argument(std::string(what) + " at line " + std::to_string(line));
+}
+
+// 格式化 A 的 [i1, i2) 行，追加到 out
+void format_rows(std::string &out, const Matrix &A, size_t i1, size_t i2, char sep)
+{
+  out.reserve(out.size() + (i2 - i1) * (A.nc() * (number_max + 1) + 1));
+  char buf[number_max];
+  for(size_t i = i1; i < i2; ++i)
+  {
+    for(size_t j = 0; j < A.nc(); ++j)
+    {
+      if(j)
+        out.push_back(sep);
+      char *q = std::to_chars(buf, buf + sizeof buf, A(i, j)).ptr;
+      out.append(buf, q);
+    }
+    out.push_back('\n');
+  }
+}
+
+// 按行分块，每批 2 * num_threads() 块并行格式化，再按顺序对每块调用 put(s)
+// put 返回假时停止
+template<class F>
+void format_batches(const Matrix &A, char sep, F put)
+{
+  size_t rows = std::max<size_t>(1, format_chunk / (A.nc() * 20 + 1));
+  size_t batch = 2 * num_threads();
+  std::vector<std::string> blocks(batch);
+  for(size_t i0 = 0; i0 < A.nr(); i0 += batch * rows)
+  {
+    size_t n = std::min(batch, (A.nr() - i0 + rows - 1) / rows);
+    parallel_for(n, [&](size_t b) {
+      blocks[b].clear();
+      size_t i1 = i0 + b * rows;
+      format_rows(blocks[b], A, i1, std::min(A.nr(), i1 + rows), sep);
+    });
+    for(size_t b = 0; b < n; ++b)
+      if(!put(blocks[b]))
+        return;
+  }
+}
+
+}  // namespace
+
+Matrix parse_matrix(std::string_view text)
+{
+  // 分块边界对齐到换行之后
+  std::vector<Chunk> chunks;
+  const char *p = text.data(), *end = p + text.size();
+  while(p < end)
+  {
+    const char *q = end - p > (ptrdiff_t)parse_chunk ? p + parse_chunk : end;
+    q = std::find(q, end, '\n');
+    if(q < end)
+      ++q;
+    chunks.emplace_back(p, q);
+    p = q;
+  }
+  parallel_for(chunks.size(), [&](size_t c) { chunks[c].parse(); });
+
+  size_t rows = 0, cols = 0;
+  for(Chunk &c : chunks)
+  {
+    if(c.error)
+      parse_error(text, c.error, c.what);
+    if(!c.rows)
+      continue;
+    if(rows && c.cols != cols)
+      parse_error(text, std::find_if(c.begin, c.end,
+            [](char ch) { return !is_separator(ch) && ch != '\n'; }),
+          "inconsistent row length");
+    cols = c.cols;
+    rows += c.rows;
+  }
+
+  Matrix A(rows, cols);
+  std::vector<size_t> first(chunks.size());
+  for(size_t c = 1; c < chunks.size(); ++c)
+    first[c] = first[c - 1] + chunks[c - 1].rows;
+  parallel_for(chunks.size(), [&](size_t c) {
+    const Number *v = chunks[c].values.data();
+    for(size_t i = 0; i < chunks[c].rows; ++i, v += cols)
+      std::copy(v, v + cols, &A(first[c] + i, 0));
+  });
+  return A;
+}
+
+Matrix read_matrix(std::istream &is)
+{
+  std::string text(std::istreambuf_iterator<char>(is), { });
+  return parse_matrix(text);
+}
+
+Matrix read_matrix(const std::string &path)
+{
+  FILE *f = fopen(path.c_str(), "rb");
+  if(!f)
+    throw std::system_error(errno, std::generic_category(), path);
+  std::string text;
+  char buf[1 << 16];
+  size_t n;
+  while((n = fread(buf, 1, sizeof buf, f)))
+    text.append(buf, n);
+  int err = ferror(f) ? errno : 0;
+  fclose(f);
+  if(err)
+    throw std::system_error(err, std::generic_category(), path);
+  return parse_matrix(text);
+}
+
+std::string format_matrix(const Matrix &A, char sep)
+{
+  std::string out;
+  format_batches(A, sep, [&](const std::string &s) {
+    out += s;
+    return true;
+  });
+  return out;
+}
+
+void write_matrix(std::ostream &os, const Matrix &A, char sep)
+{
+  format_batches(A, sep, [&](const std::string &s) {
+    return (bool)os.write(s.data(), s.size());
+  });
+}
+
+void write_matrix(const std::string &path, const Matrix &A, char sep)
+{
+  FILE *f = fopen(path.c_str(), "wb");
+  if(!f)
+    throw std::system_error(errno, std::generic_category(), path);
+  int err = 0;
+  format_batches(A, sep, [&](const std::string &s) {
+    if(fwrite(s.data(), 1, s.size(), f) != s.size())
+      err = errno ? errno : EIO;
+    return !err;
+  });
+  if(fclose(f) && !err)
+    err = errno;
+  if(err)
+    throw std::system_error(err, std::generic_category(), path);
+}
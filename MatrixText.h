@@ -0,0 +1,27 @@
+#pragma once
+
+#include "Basic.h"
+#include "IOStream.h"
+#include <string>
+#include <string_view>
+
+// 文本矩阵格式：每行对应矩阵一行，元素以空白或逗号分隔，空行忽略
+// 行尾的 \r 视为空白，因此可直接读取 CSV 文件
+
+// 解析文本矩阵，文本较长时分块并行解析
+// 数字格式错误或各行元素数不同时抛 invalid_argument，消息中含行号
+Matrix parse_matrix(std::string_view text);
+
+// 读取整个输入流或文件后解析
+// 文件无法读取时抛 system_error
+Matrix read_matrix(std::istream &);
+Matrix read_matrix(const std::string &path);
+
+// 以最短往返表示格式化矩阵，元素以 sep 分隔，每行以换行结束
+// 按行分块并行格式化
+std::string format_matrix(const Matrix &, char sep = ' ');
+
+// 分批格式化后写出，每批内并行
+// 文件无法写入时抛 system_error
+void write_matrix(std::ostream &, const Matrix &, char sep = ' ');
+void write_matrix(const std::string &path, const Matrix &, char sep = ' ');
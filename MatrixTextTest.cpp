@@ -0,0 +1,172 @@
+#include "TestBasic.h"
+#include "MatrixText.h"
+#include "Matrix.h"
+#include "ThreadPool.h"
+#include <sstream>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <limits>
+#include <system_error>
+#include <chrono>
+#include <unistd.h>
+
+using namespace std;
+
+void test_parse();
+void test_parse_error();
+void test_format();
+void test_round_trip();
+void test_parallel();
+void test_text_repeat();
+
+int main()
+{
+  srand(time(NULL));
+  test_parse();
+  test_parse_error();
+  test_format();
+  test_round_trip();
+  test_parallel();
+  test_text_repeat();
+}
+
+static void fill_random(const Matrix &A)
+{
+  for(size_t i = 0; i < A.nr(); ++i)
+    for(size_t j = 0; j < A.nc(); ++j)
+      A(i, j) = (rand() - RAND_MAX / 2) / (Number)(rand() + 1) * pow(10, rand() % 21 - 10);
+}
+
+void test_parse()
+{
+  double data[2][3] = {
+    1, 2.5, -3e-4,
+    4, 0, 1e300,
+  };
+  Matrix A(2, 3, data);
+  assert(parse_matrix("1 2.5 -3e-4\n4 0 1e300\n") == A);
+  assert(parse_matrix("1,2.5,-3e-4\r\n4,0,1e300") == A);
+  assert(parse_matrix("\n  1\t2.5, -3e-4  \n\n\t\n4 ,0 ,1e300\n\n") == A);
+
+  Matrix E = parse_matrix("");
+  assert(E.nr() == 0 && E.nc() == 0);
+  E = parse_matrix(" \n\r\n");
+  assert(E.nr() == 0 && E.nc() == 0);
+  Matrix v = parse_matrix("1\n2\n3\n");
+  assert(v.nr() == 3 && v.nc() == 1 && v(2, 0) == 3);
+
+  Matrix s = parse_matrix("inf -inf nan");
+  assert(isinf(s(0, 0)) && s(0, 1) < 0 && isnan(s(0, 2)));
+
+  istringstream is("1 2.5 -3e-4\n4 0 1e300\n");
+  assert(read_matrix(is) == A);
+  TEST_PASSED;
+}
+
+static void assert_parse_error(const string &text, const string &what)
+{
+  try {
+    parse_matrix(text);
+    assert(!"invalid_argument not thrown");
+  }
+  catch(const invalid_argument &e) {
+    assert(string(e.what()) == what);
+  }
+}
+
+void test_parse_error()
+{
+  assert_parse_error("1 2\n3 x\n", "invalid number at line 2");
+  assert_parse_error("1 2\n3 4x\n", "invalid number at line 2");
+  assert_parse_error("1 2\n\n3 4 5\n", "inconsistent row length at line 3");
+  assert_parse_error("1e400\n", "invalid number at line 1");
+  assert_parse_error("1;2\n", "invalid number at line 1");
+  ASSERT_EXCEPTION(system_error, read_matrix(string("/nonexistent/file"));)
+  ASSERT_EXCEPTION(system_error, write_matrix(string("/nonexistent/dir/file"), Matrix(1, 1));)
+  TEST_PASSED;
+}
+
+void test_format()
+{
+  double data[2][3] = {
+    1, 2.5, -3e-4,
+    4, 0, 0.1,
+  };
+  Matrix A(2, 3, data);
+  assert(format_matrix(A) == "1 2.5 -3e-04\n4 0 0.1\n");
+  assert(format_matrix(A, ',') == "1,2.5,-3e-04\n4,0,0.1\n");
+  assert(format_matrix(A.t()) == "1 4\n2.5 0\n-3e-04 0.1\n");
+  assert(format_matrix(Matrix(0, 3)) == "");
+  ostringstream os;
+  write_matrix(os, A.col_slice(1), '\t');
+  assert(os.str() == "2.5\t-3e-04\n0\t0.1\n");
+  TEST_PASSED;
+}
+
+// 最短往返表示解析后逐位相同
+void test_round_trip()
+{
+  Matrix A(37, 23);
+  fill_random(A);
+  A(0, 0) = numeric_limits<Number>::max();
+  A(0, 1) = numeric_limits<Number>::denorm_min();
+  A(0, 2) = -0.0;
+  assert(parse_matrix(format_matrix(A)) == A);
+  assert(parse_matrix(format_matrix(A, ',')) == A);
+  assert(signbit(parse_matrix(format_matrix(A))(0, 2)));
+
+  string path = "/tmp/MatrixTextTest." + to_string(getpid());
+  write_matrix(path, A.t(), ',');
+  assert(read_matrix(path) == A.t());
+  remove(path.c_str());
+  TEST_PASSED;
+}
+
+// 多块并行解析与单线程结果相同
+void test_parallel()
+{
+  Matrix A(50000, 13);
+  fill_random(A);
+  string text = format_matrix(A);
+  assert(text.size() > (4 << 20));
+  for(size_t nt : {1, 4})
+  {
+    set_num_threads(nt);
+    assert(parse_matrix(text) == A);
+    assert(format_matrix(A) == text);
+  }
+
+  // 出错行号跨块计算
+  text += "1 2\n";
+  assert_parse_error(text, "inconsistent row length at line 50001");
+  text.insert(text.size() / 2, "@");
+  try {
+    parse_matrix(text);
+    assert(!"invalid_argument not thrown");
+  }
+  catch(const invalid_argument &e) {
+    size_t line = 1 + count(text.begin(), text.begin() + text.find('@'), '\n');
+    assert(string(e.what()) == "invalid number at line " + to_string(line));
+  }
+  set_num_threads(0);
+  TEST_PASSED;
+}
+
+void test_text_repeat()
+{
+  Matrix A(200000, 16);
+  fill_random(A);
+  auto start = chrono::steady_clock::now();
+  string text = format_matrix(A);
+  double t1 = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  start = chrono::steady_clock::now();
+  Matrix B = parse_matrix(text);
+  double t2 = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  assert(B == A);
+  cout << "It took " << t1 << " s to format " << text.size() / 1e6 << " MB ("
+       << text.size() / t1 / 1e6 << " MB/s) and " << t2 << " s to parse it ("
+       << text.size() / t2 / 1e6 << " MB/s) with " << num_threads() << " threads." << endl;
+  TEST_PASSED;
+}
@@ -0,0 +1,181 @@
+#include "TestBasic.h"
+#include "Matrix.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <ctime>
+#include <chrono>
+
+using namespace std;
+
+void test_share_views();
+void test_share_writes();
+void test_share_release();
+void test_share_parallel_for();
+void test_share_repeat();
+
+static constexpr size_t nthread = 8;
+
+static void fill_index(const Matrix &A)
+{
+  for(size_t i = 0; i < A.nr(); ++i)
+    for(size_t j = 0; j < A.nc(); ++j)
+      A(i, j) = i * 1000 + j;
+}
+
+// 在 nthread 个线程中各调用一次 f(t)
+template<class F>
+static void run_threads(F f)
+{
+  vector<thread> threads;
+  for(size_t t = 0; t < nthread; ++t)
+    threads.emplace_back(f, t);
+  for(thread &th : threads)
+    th.join();
+}
+
+int main()
+{
+  test_share_views();
+  test_share_writes();
+  test_share_release();
+  test_share_parallel_for();
+  test_share_repeat();
+}
+
+// 各线程同时从同一矩阵切出视图、拷贝和析构
+void test_share_views()
+{
+  Matrix A(200, 64);
+  fill_index(A);
+  atomic<size_t> errors{0};
+  run_threads([&](size_t t) {
+    vector<Matrix> kept;
+    for(size_t k = 0; k < 20000; ++k)
+    {
+      size_t i = (t * 37 + k) % A.nr(), j = (t * 11 + k) % A.nc();
+      Matrix r = A.row_slice(i, i + 1), c = A.col_slice(j);
+      Matrix v = k % 2 ? A.slice(i / 2, i, j / 2, j) : A.t();
+      Matrix w = v;
+      if(r(0, j) != i * 1000 + j || c(i, 0) != i * 1000 + j || !w.ref(A))
+        ++errors;
+      if(k % 64 == 0)
+        kept.push_back(c);
+      if(kept.size() > 16)
+        kept.clear();
+    }
+  });
+  assert(!errors && A.ref() == 1);
+  TEST_PASSED;
+}
+
+// 各线程经由各自的行视图写入互不重叠的行
+void test_share_writes()
+{
+  Matrix A(nthread * 50, 100);
+  A.fill(0);
+  run_threads([&](size_t t) {
+    Matrix rows = A.row_slice(t * 50, (t + 1) * 50);
+    for(size_t k = 0; k < 100; ++k)
+    {
+      Matrix r = rows.row(k % 50);
+      for(size_t j = 0; j < r.nc(); ++j)
+        r(0, j) += 1;
+    }
+  });
+  assert(A.ref() == 1);
+  for(size_t i = 0; i < A.nr(); ++i)
+    for(size_t j = 0; j < A.nc(); ++j)
+      assert(A(i, j) == 2);
+  TEST_PASSED;
+}
+
+class CountingAllocator : public Allocator {
+public:
+  atomic<size_t> live{0};
+
+  void *allocate(size_t size) override
+  {
+    ++live;
+    return malloc_allocator().allocate(size);
+  }
+
+  void deallocate(void *p, size_t size) noexcept override
+  {
+    --live;
+    malloc_allocator().deallocate(p, size);
+  }
+};
+
+// 数据区在最后释放视图的线程中交还分配器，包括线程局部缓存的缓冲池
+void test_share_release()
+{
+  CountingAllocator counting;
+  for(Allocator *alloc : {(Allocator *)&counting, &pool_allocator()})
+  for(int round = 0; round < 200; ++round)
+  {
+    set_allocator(*alloc);
+    vector<Matrix> views;
+    {
+      Matrix A(64, 64);
+      fill_index(A);
+      for(size_t t = 0; t < nthread; ++t)
+        views.push_back(A.row_slice(t * 8, t * 8 + 8));
+    }
+    set_allocator(pool_allocator());
+    atomic<size_t> errors{0};
+    run_threads([&](size_t t) {
+      Matrix v = std::move(views[t]);
+      for(size_t j = 0; j < v.nc(); ++j)
+        if(v(0, j) != t * 8000 + j)
+          ++errors;
+    });
+    assert(!errors);
+  }
+  assert(counting.live == 0);
+  TEST_PASSED;
+}
+
+void test_share_parallel_for()
+{
+  set_num_threads(4);
+  Matrix A(1000, 50), s(1000, 1);
+  fill_index(A);
+  for(int round = 0; round < 20; ++round)
+    parallel_for(A.nr(), [&](size_t i) {
+      Matrix r = A.row(i), out = s.row(i);
+      Number sum = 0;
+      for(size_t j = 0; j < r.nc(); ++j)
+        sum += r(0, j);
+      out(0, 0) = sum;
+    });
+  for(size_t i = 0; i < A.nr(); ++i)
+    assert(s(i, 0) == 50 * i * 1000 + 49 * 50 / 2);
+  assert(A.ref() == 1 && s.ref() == 1);
+  set_num_threads(0);
+  TEST_PASSED;
+}
+
+void test_share_repeat()
+{
+  Matrix A(100, 100);
+  size_t n = 10000000;
+  clock_t start = clock();
+  for(size_t k = 0; k < n; ++k)
+    Matrix v = A.row(k % 100);
+  clock_t diff = clock() - start;
+  cout << "It took " << (double)diff / CLOCKS_PER_SEC << " s to copy and destroy "
+       << n << " views in one thread." << endl;
+
+  auto wall = chrono::steady_clock::now();
+  run_threads([&](size_t) {
+    for(size_t k = 0; k < n / nthread; ++k)
+      Matrix v = A.row(k % 100);
+  });
+  chrono::duration<double> d = chrono::steady_clock::now() - wall;
+  cout << "It took " << d.count() << " s to copy and destroy them in "
+       << nthread << " threads sharing one buffer." << endl;
+  assert(A.ref() == 1);
+  TEST_PASSED;
+}
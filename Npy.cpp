@@ -0,0 +1,477 @@
+#include "Npy.h"
+#include "Matrix.h"
+#include "Kernel.h"
+#include "MappedFile.h"
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+
+namespace {
+
+constexpr char npy_magic[] = "\x93NUMPY";
+constexpr size_t npy_align = 64;  // 文件头补齐的字节数
+
+// .npy 文件头的解析结果
+struct NpyHeader {
+  size_t  offset;   // 数据区相对 .npy 起点的偏移
+  size_t  nr, nc;
+  bool    fortran;
+};
+
+[[noreturn]] void invalid(const std::string &path, const char *what)
+{
+  throw std::runtime_error("invalid npy file " + path + ": " + what);
+}
+
+// 在字典文本中查找键 key 对应值的起点
+const char *find_value(const std::string &dict, const char *key, const std::string &path)
+{
+  for(char q : { '\'', '"' })
+  {
+    std::string k = q + std::string(key) + q;
+    size_t pos = dict.find(k);
+    if(pos == std::string::npos)
+      continue;
+    pos = dict.find(':', pos + k.size());
+    if(pos == std::string::npos)
+      break;
+    pos = dict.find_first_not_of(' ', pos + 1);
+    if(pos == std::string::npos)
+      break;
+    return dict.c_str() + pos;
+  }
+  invalid(path, "missing header key");
+}
+
+NpyHeader parse_header(const char *p, size_t n, const std::string &path)
+{
+  if(n < 10 || memcmp(p, npy_magic, 6))
+    invalid(path, "bad magic");
+  unsigned major = (unsigned char)p[6];
+  size_t len, start;
+  if(major == 1)
+  {
+    len = (unsigned char)p[8] | (unsigned char)p[9] << 8;
+    start = 10;
+  }
+  else if(major == 2 || major == 3)
+  {
+    if(n < 12)
+      invalid(path, "truncated header");
+    len = (unsigned char)p[8] | (unsigned char)p[9] << 8 |
+          (size_t)(unsigned char)p[10] << 16 | (size_t)(unsigned char)p[11] << 24;
+    start = 12;
+  }
+  else
+    invalid(path, "unsupported version");
+  if(len > n - start)
+    invalid(path, "truncated header");
+
+  std::string dict(p + start, len);
+  NpyHeader h = { start + len, 1, 1, false };
+  const char *v = find_value(dict, "descr", path);
+  if(strncmp(v + 1, "<f8", 3) || v[0] != v[4])
+    invalid(path, "unsupported dtype");
+  v = find_value(dict, "fortran_order", path);
+  if(!strncmp(v, "True", 4))
+    h.fortran = true;
+  else if(strncmp(v, "False", 5))
+    invalid(path, "bad fortran_order");
+
+  // 形如 ()、(n,)、(r, c)
+  v = find_value(dict, "shape", path);
+  if(*v++ != '(')
+    invalid(path, "bad shape");
+  size_t dims[2], ndim = 0;
+  for(;;)
+  {
+    while(*v == ' ' || *v == ',')
+      ++v;
+    if(*v == ')')
+      break;
+    char *e;
+    unsigned long long d = strtoull(v, &e, 10);
+    if(e == v || ndim == 2)
+      invalid(path, ndim == 2 ? "more than two dimensions" : "bad shape");
+    dims[ndim++] = d;
+    v = e;
+  }
+  if(ndim >= 1)
+    h.nr = dims[0];
+  if(ndim == 2)
+    h.nc = dims[1];
+  return h;
+}
+
+std::string npy_header(const Matrix &A, bool fortran)
+{
+  std::string dict = "{'descr': '<f8', 'fortran_order': ";
+  dict += fortran ? "True" : "False";
+  dict += ", 'shape': (" + std::to_string(A.nr()) + ", " + std::to_string(A.nc()) + "), }";
+  size_t total = 10 + dict.size() + 1;
+  dict.append((npy_align - total % npy_align) % npy_align, ' ');
+  dict.push_back('\n');
+  std::string h(npy_magic, 6);
+  h += '\x01';
+  h += '\x00';
+  h += (char)(dict.size() & 0xff);
+  h += (char)(dict.size() >> 8);
+  return h + dict;
+}
+
+// 行跳步为 1 而列跳步不为 1 的视图按 Fortran 顺序保存
+bool fortran_layout(const Matrix &A)
+{
+  return A.sc() != 1 && A.sr() == 1;
+}
+
+// 按存储顺序逐段交给 sink(p, n)，行或列连续时不拷贝
+template<class F>
+void for_each_segment(const Matrix &A, bool fortran, F sink)
+{
+  if(A.empty())
+    return;
+  if(fortran)
+  {
+    if(contiguous(A.t()))
+      return sink(A.ptr(), A.nr() * A.nc());
+    for(size_t j = 0; j < A.nc(); ++j)
+      sink(&A(0, j), A.nr());
+  }
+  else if(A.sc() == 1)
+  {
+    if(contiguous(A))
+      return sink(A.ptr(), A.nr() * A.nc());
+    for(size_t i = 0; i < A.nr(); ++i)
+      sink(&A(i, 0), A.nc());
+  }
+  else
+  {
+    std::vector<Number> row(A.nc());
+    for(size_t i = 0; i < A.nr(); ++i)
+    {
+      for(size_t j = 0; j < A.nc(); ++j)
+        row[j] = A(i, j);
+      sink(row.data(), A.nc());
+    }
+  }
+}
+
+// 数据区未对齐时逐元素拷贝到新矩阵
+Matrix npy_copy(const char *d, const NpyHeader &h)
+{
+  Matrix A(h.nr, h.nc);
+  for(size_t k = 0; k < h.nr * h.nc; ++k)
+  {
+    size_t i = h.fortran ? k % h.nr : k / h.nc, j = h.fortran ? k / h.nr : k % h.nc;
+    memcpy(&A(i, j), d + k * sizeof(Number), sizeof(Number));
+  }
+  return A;
+}
+
+// 以 zip 规定的多项式计算 CRC-32，每次处理 8 字节
+uint32_t crc32(uint32_t crc, const void *p, size_t n)
+{
+  static const struct Tables {
+    uint32_t t[8][256];
+    Tables()
+    {
+      for(uint32_t i = 0; i < 256; ++i)
+      {
+        uint32_t c = i;
+        for(int k = 0; k < 8; ++k)
+          c = c & 1 ? (c >> 1) ^ 0xedb88320 : c >> 1;
+        t[0][i] = c;
+      }
+      for(int k = 1; k < 8; ++k)
+        for(int i = 0; i < 256; ++i)
+          t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xff];
+    }
+  } tables;
+  const auto &t = tables.t;
+  const unsigned char *s = (const unsigned char *)p;
+  crc = ~crc;
+  for(; n >= 8; n -= 8, s += 8)
+  {
+    uint32_t a, b;
+    memcpy(&a, s, 4);
+    memcpy(&b, s + 4, 4);
+    a ^= crc;
+    crc = t[7][a & 0xff] ^ t[6][(a >> 8) & 0xff] ^ t[5][(a >> 16) & 0xff] ^ t[4][a >> 24] ^
+          t[3][b & 0xff] ^ t[2][(b >> 8) & 0xff] ^ t[1][(b >> 16) & 0xff] ^ t[0][b >> 24];
+  }
+  while(n--)
+    crc = t[0][(crc ^ *s++) & 0xff] ^ (crc >> 8);
+  return ~crc;
+}
+
+// 写出失败时抛 system_error
+struct Writer {
+  FILE         *f;
+  std::string  path;
+
+  explicit Writer(const std::string &p) : path(p)
+  {
+    f = fopen(p.c_str(), "wb");
+    if(!f)
+      fail();
+  }
+
+  ~Writer()
+  {
+    if(f)
+      fclose(f);
+  }
+
+  [[noreturn]] void fail()
+  {
+    throw std::system_error(errno ? errno : EIO, std::generic_category(), path);
+  }
+
+  void write(const void *p, size_t n)
+  {
+    if(fwrite(p, 1, n, f) != n)
+      fail();
+  }
+
+  // 小端序整数
+  void put(uint64_t v, size_t bytes)
+  {
+    unsigned char b[8];
+    for(size_t k = 0; k < bytes; ++k)
+      b[k] = v >> (8 * k);
+    write(b, bytes);
+  }
+
+  uint64_t tell()
+  {
+    off_t pos = ftello(f);
+    if(pos < 0)
+      fail();
+    return pos;
+  }
+
+  void seek(uint64_t pos)
+  {
+    if(fseeko(f, pos, SEEK_SET))
+      fail();
+  }
+
+  void close()
+  {
+    FILE *g = f;
+    f = nullptr;
+    if(fclose(g))
+      fail();
+  }
+};
+
+uint64_t get(const char *p, size_t bytes)
+{
+  uint64_t v = 0;
+  for(size_t k = bytes; k--; )
+    v = v << 8 | (unsigned char)p[k];
+  return v;
+}
+
+constexpr uint32_t zip_local = 0x04034b50;
+constexpr uint32_t zip_central = 0x02014b50;
+constexpr uint32_t zip_end = 0x06054b50;
+constexpr uint16_t zip_date = (0 << 9) | (1 << 5) | 1;  // 1980-01-01
+constexpr uint16_t zip_pad_id = 0xd935;                 // 对齐用的扩展字段
+
+}  // namespace
+
+Matrix load_npy(const std::string &path, bool shared)
+{
+  File file(path, shared ? O_RDWR : O_RDONLY);
+  size_t length = file.size(path);
+  if(!length)
+    invalid(path, "empty file");
+  Mapping m(file, path, length, PROT_READ | PROT_WRITE, shared ? MAP_SHARED : MAP_PRIVATE);
+  const char *p = (const char *)m.addr;
+  NpyHeader h = parse_header(p, length, path);
+  if(h.nc && h.nr > (length - h.offset) / sizeof(Number) / h.nc)
+    invalid(path, "data exceeds file size");
+  Number *data = (Number *)(p + h.offset);
+  if((uintptr_t)data % sizeof(Number))
+    return npy_copy(p + h.offset, h);
+  return Matrix::adopt(m, data, h.nr, h.nc, h.fortran ? 1 : h.nc, h.fortran ? h.nr : 1);
+}
+
+void save_npy(const std::string &path, const Matrix &A)
+{
+  bool fortran = fortran_layout(A);
+  Writer w(path);
+  std::string header = npy_header(A, fortran);
+  w.write(header.data(), header.size());
+  for_each_segment(A, fortran, [&](const Number *p, size_t n) {
+    w.write(p, n * sizeof(Number));
+  });
+  w.close();
+}
+
+void save_npz(const std::string &path, const std::vector<std::pair<std::string, Matrix>> &arrays)
+{
+  struct Entry {
+    std::string  name;
+    uint64_t     offset;
+    uint64_t     size;
+    uint32_t     crc;
+  };
+  std::vector<Entry> entries;
+  Writer w(path);
+  for(const auto &[key, A] : arrays)
+  {
+    bool fortran = fortran_layout(A);
+    std::string header = npy_header(A, fortran);
+    Entry e = { key + ".npy", w.tell(), header.size() + A.nr() * A.nc() * sizeof(Number), 0 };
+    if(e.offset + e.size + 30 + e.name.size() + npy_align + 4 >= UINT32_MAX)
+      throw std::length_error("npz archive exceeds 4 GiB");
+
+    // 扩展字段补齐，使成员数据按缓存行对齐
+    size_t pad = (npy_align - (e.offset + 30 + e.name.size()) % npy_align) % npy_align;
+    if(pad && pad < 4)
+      pad += npy_align;
+    w.put(zip_local, 4);
+    w.put(20, 2);                           // 所需版本
+    w.put(0, 2);                            // 标志
+    w.put(0, 2);                            // 不压缩
+    w.put(0, 2);
+    w.put(zip_date, 2);
+    w.put(0, 4);                            // CRC，写完数据后回填
+    w.put(e.size, 4);
+    w.put(e.size, 4);
+    w.put(e.name.size(), 2);
+    w.put(pad, 2);
+    w.write(e.name.data(), e.name.size());
+    if(pad)
+    {
+      w.put(zip_pad_id, 2);
+      w.put(pad - 4, 2);
+      std::string zeros(pad - 4, '\0');
+      w.write(zeros.data(), zeros.size());
+    }
+
+    e.crc = crc32(0, header.data(), header.size());
+    w.write(header.data(), header.size());
+    for_each_segment(A, fortran, [&](const Number *p, size_t n) {
+      e.crc = crc32(e.crc, p, n * sizeof(Number));
+      w.write(p, n * sizeof(Number));
+    });
+    uint64_t end = w.tell();
+    w.seek(e.offset + 14);
+    w.put(e.crc, 4);
+    w.seek(end);
+    entries.push_back(e);
+  }
+
+  uint64_t cd = w.tell();
+  for(const Entry &e : entries)
+  {
+    w.put(zip_central, 4);
+    w.put(20, 2);                           // 创建版本
+    w.put(20, 2);                           // 所需版本
+    w.put(0, 2);
+    w.put(0, 2);
+    w.put(0, 2);
+    w.put(zip_date, 2);
+    w.put(e.crc, 4);
+    w.put(e.size, 4);
+    w.put(e.size, 4);
+    w.put(e.name.size(), 2);
+    w.put(0, 2);                            // 扩展字段
+    w.put(0, 2);                            // 注释
+    w.put(0, 2);                            // 磁盘号
+    w.put(0, 2);                            // 内部属性
+    w.put(0, 4);                            // 外部属性
+    w.put(e.offset, 4);
+    w.write(e.name.data(), e.name.size());
+  }
+  uint64_t cd_end = w.tell();
+  if(cd_end >= UINT32_MAX || entries.size() >= UINT16_MAX)
+    throw std::length_error("npz archive exceeds 4 GiB");
+  w.put(zip_end, 4);
+  w.put(0, 2);
+  w.put(0, 2);
+  w.put(entries.size(), 2);
+  w.put(entries.size(), 2);
+  w.put(cd_end - cd, 4);
+  w.put(cd, 4);
+  w.put(0, 2);
+  w.close();
+}
+
+std::map<std::string, Matrix> load_npz(const std::string &path)
+{
+  File file(path, O_RDONLY);
+  size_t length = file.size(path);
+  if(length < 22)
+    invalid(path, "truncated zip archive");
+  Mapping m(file, path, length, PROT_READ | PROT_WRITE, MAP_PRIVATE);
+  const char *p = (const char *)m.addr;
+
+  // 目录结束记录位于文件末尾，其后可有至多 65535 字节的注释
+  size_t eocd = length - 22;
+  while(get(p + eocd, 4) != zip_end)
+  {
+    if(!eocd || length - eocd > 22 + 0xffff)
+      invalid(path, "missing zip end record");
+    --eocd;
+  }
+  size_t count = get(p + eocd + 10, 2);
+  size_t cd = get(p + eocd + 16, 4);
+  if(cd == 0xffffffff || count == 0xffff)
+    invalid(path, "zip64 archives are not supported");
+
+  // 所有矩阵共享一份映射区
+  Matrix base = Matrix::adopt(m, (Number *)p, 0, 0, 0, 0);
+  std::map<std::string, Matrix> arrays;
+  for(size_t k = 0; k < count; ++k)
+  {
+    if(cd + 46 > length || get(p + cd, 4) != zip_central)
+      invalid(path, "bad zip central directory");
+    size_t method = get(p + cd + 10, 2);
+    size_t size = get(p + cd + 24, 4);
+    size_t name_len = get(p + cd + 28, 2);
+    size_t extra_len = get(p + cd + 30, 2);
+    size_t comment_len = get(p + cd + 32, 2);
+    size_t local = get(p + cd + 42, 4);
+    if(cd + 46 + name_len > length)
+      invalid(path, "bad zip central directory");
+    std::string name(p + cd + 46, name_len);
+    cd += 46 + name_len + extra_len + comment_len;
+    if(method != 0)
+      invalid(path, "compressed npz entries are not supported");
+    if(size == 0xffffffff || local == 0xffffffff)
+      invalid(path, "zip64 archives are not supported");
+    if(local + 30 > length || get(p + local, 4) != zip_local)
+      invalid(path, "bad zip local header");
+    size_t start = local + 30 + get(p + local + 26, 2) + get(p + local + 28, 2);
+    if(start > length || size > length - start)
+      invalid(path, "zip entry exceeds file size");
+
+    NpyHeader h = parse_header(p + start, size, path);
+    if(h.nc && h.nr > (size - h.offset) / sizeof(Number) / h.nc)
+      invalid(path, "data exceeds entry size");
+    if(name.size() > 4 && !name.compare(name.size() - 4, 4, ".npy"))
+      name.resize(name.size() - 4);
+    const char *d = p + start + h.offset;
+    if((uintptr_t)d % sizeof(Number))
+    {
+      arrays.emplace(name, npy_copy(d, h));
+      continue;
+    }
+    Matrix A(base);
+    A.data = (Number *)d;
+    A.nrow = h.nr;
+    A.ncol = h.nc;
+    A.srow = h.fortran ? 1 : h.nc;
+    A.scol = h.fortran ? h.nr : 1;
+    arrays.emplace(name, A);
+  }
+  return arrays;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Basic.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <utility>
+
+// NumPy .npy 文件，元素类型须为 '<f8'
+// 二维数组对应同形矩阵，一维数组对应列向量，零维数组对应 1x1 矩阵
+
+// 映射 .npy 文件，矩阵元直接位于映射区；fortran_order 为真时得到列优先的视图，不拷贝
+// shared 的含义同 Matrix::map；数据区未按元素大小对齐时拷贝到新矩阵
+// 文件无法打开或映射时抛 system_error，格式不符时抛 runtime_error
+Matrix load_npy(const std::string &path, bool shared = false);
+
+// 保存为 .npy 文件（格式版本 1.0）
+// 行连续的视图按 C 顺序、列连续的视图（如 t() 得到的转置）按 Fortran 顺序直接写出
+// 写入失败时抛 system_error
+void save_npy(const std::string &path, const Matrix &);
+
+// NumPy .npz 文件：不压缩的 zip 存档，成员为 名字.npy
+// 保存时成员数据按缓存行对齐，单个存档不超过 4 GiB，否则抛 length_error
+void save_npz(const std::string &path, const std::vector<std::pair<std::string, Matrix>> &);
+
+// 映射 .npz 文件，返回以名字（去掉 .npy）为键的矩阵，各矩阵共享同一映射区
+// 不校验 CRC；成员经过压缩或使用 zip64 时抛 runtime_error
+std::map<std::string, Matrix> load_npz(const std::string &path);
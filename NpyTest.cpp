@@ -0,0 +1,240 @@
+#include "TestBasic.h"
+#include "Npy.h"
+#include "Matrix.h"
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <ctime>
+#include <unistd.h>
+
+using namespace std;
+
+void test_npy_save_load();
+void test_npy_header();
+void test_npy_numpy_files();
+void test_npy_invalid();
+void test_npz();
+void test_npy_repeat();
+
+static string temp_path(const char *name)
+{
+  return "/tmp/NpyTest." + to_string(getpid()) + "." + name;
+}
+
+static void fill_index(const Matrix &A)
+{
+  for(size_t i = 0; i < A.nr(); ++i)
+    for(size_t j = 0; j < A.nc(); ++j)
+      A(i, j) = i * 1000 + j + 0.5;
+}
+
+static string read_file(const string &path)
+{
+  ifstream is(path, ios::binary);
+  return string(istreambuf_iterator<char>(is), { });
+}
+
+// 以给定的文件头字典和数据写出 .npy 文件，pre 为数据区前额外的字节数
+static void write_npy(const string &path, const string &dict, const Number *data, size_t n,
+                      size_t pre = 0, int major = 1)
+{
+  string h = "\x93NUMPY";
+  h += (char)major;
+  h += '\0';
+  string d = dict + string(pre, ' ') + "\n";
+  for(int k = 0; k < (major == 1 ? 2 : 4); ++k)
+    h += (char)(d.size() >> (8 * k));
+  ofstream os(path, ios::binary);
+  os << h << d;
+  os.write((const char *)data, n * sizeof(Number));
+}
+
+int main()
+{
+  test_npy_save_load();
+  test_npy_header();
+  test_npy_numpy_files();
+  test_npy_invalid();
+  test_npz();
+  test_npy_repeat();
+}
+
+void test_npy_save_load()
+{
+  string path = temp_path("save.npy");
+  for(size_t nr : {0, 1, 7, 100})
+  for(size_t nc : {0, 1, 20, 64})
+  {
+    Matrix A(nr, nc);
+    fill_index(A);
+    save_npy(path, A);
+    Matrix B = load_npy(path);
+    assert(B.nr() == nr && B.nc() == nc && B == A);
+    assert(B.ref() == 2 && B.sc() == 1);
+
+    // 转置视图按 Fortran 顺序保存，载入后仍是列优先视图
+    save_npy(path, A.t());
+    Matrix C = load_npy(path);
+    assert(C == A.t());
+    if(nr > 1 && nc > 1)
+      assert(C.sr() == 1 && C.sc() == nc);
+  }
+
+  // 子矩阵、带跳步的视图
+  Matrix A(30, 40);
+  fill_index(A);
+  for(const Matrix &V : {A.slice(3, 10, 5, 20), A.t().slice(2, 7, 1, 9), A.col(4), A.row(5)})
+  {
+    save_npy(path, V);
+    assert(load_npy(path) == V);
+  }
+
+  // 共享映射的写入写回文件
+  save_npy(path, A);
+  Matrix S = load_npy(path, true);
+  S(3, 4) = -1;
+  Matrix P = load_npy(path);
+  P(5, 6) = -2;
+  assert(load_npy(path)(3, 4) == -1 && load_npy(path)(5, 6) == A(5, 6));
+  remove(path.c_str());
+  TEST_PASSED;
+}
+
+void test_npy_header()
+{
+  string path = temp_path("header.npy");
+  Matrix A(3, 2);
+  fill_index(A);
+  save_npy(path, A);
+  string s = read_file(path);
+  size_t len = (unsigned char)s[8] | (unsigned char)s[9] << 8;
+  assert(!s.compare(0, 8, "\x93NUMPY\x01\x00", 8));
+  assert((10 + len) % 64 == 0 && s.size() == 10 + len + 6 * sizeof(Number));
+  assert(s.substr(10, len).find("{'descr': '<f8', 'fortran_order': False, 'shape': (3, 2), }")
+         == 0);
+  assert(s[10 + len - 1] == '\n');
+  assert(!memcmp(s.data() + 10 + len, A.ptr(), sizeof(Number) * 2));
+
+  save_npy(path, A.t());
+  s = read_file(path);
+  assert(s.find("'fortran_order': True, 'shape': (2, 3)") != string::npos);
+  remove(path.c_str());
+  TEST_PASSED;
+}
+
+void test_npy_numpy_files()
+{
+  string path = temp_path("numpy.npy");
+  Number v[6] = {1, 2, 3, 4, 5, 6};
+
+  // numpy.save 的 Fortran 顺序输出
+  write_npy(path, "{'descr': '<f8', 'fortran_order': True, 'shape': (2, 3), }", v, 6, 5);
+  Matrix A = load_npy(path);
+  assert(A.nr() == 2 && A.nc() == 3 && A(1, 0) == 2 && A(0, 1) == 3 && A(1, 2) == 6);
+
+  // 一维数组为列向量，零维数组为 1x1 矩阵
+  write_npy(path, "{'descr': '<f8', 'fortran_order': False, 'shape': (6,), }", v, 6, 3);
+  Matrix B = load_npy(path);
+  assert(B.nr() == 6 && B.nc() == 1 && B(5, 0) == 6);
+  write_npy(path, "{'descr': '<f8', 'fortran_order': False, 'shape': (), }", v, 1, 2);
+  Matrix C = load_npy(path);
+  assert(C.nr() == 1 && C.nc() == 1 && C(0, 0) == 1);
+
+  // 双引号、版本 2.0 的文件头
+  write_npy(path, "{\"descr\": \"<f8\", \"fortran_order\": False, \"shape\": (3, 2)}", v, 6, 7, 2);
+  Matrix D = load_npy(path);
+  assert(D.nr() == 3 && D.nc() == 2 && D(1, 0) == 3);
+
+  // 数据区未对齐时拷贝
+  write_npy(path, "{'descr': '<f8', 'fortran_order': True, 'shape': (3, 2), }", v, 6, 1);
+  Matrix E = load_npy(path);
+  assert(E.nr() == 3 && E.nc() == 2 && E(1, 0) == 2 && E(0, 1) == 4);
+  remove(path.c_str());
+  TEST_PASSED;
+}
+
+void test_npy_invalid()
+{
+  string path = temp_path("invalid.npy");
+  remove(path.c_str());
+  ASSERT_EXCEPTION(system_error, load_npy(path);)
+  ASSERT_EXCEPTION(system_error, save_npy("/nonexistent/dir/file.npy", Matrix(2, 2));)
+
+  ofstream(path) << "not a npy file";
+  ASSERT_EXCEPTION(runtime_error, load_npy(path);)
+
+  Number v[6] = { };
+  write_npy(path, "{'descr': '<f4', 'fortran_order': False, 'shape': (2, 3), }", v, 6);
+  ASSERT_EXCEPTION(runtime_error, load_npy(path);)
+  write_npy(path, "{'descr': '>f8', 'fortran_order': False, 'shape': (2, 3), }", v, 6);
+  ASSERT_EXCEPTION(runtime_error, load_npy(path);)
+  write_npy(path, "{'descr': '<f8', 'fortran_order': False, 'shape': (1, 2, 3), }", v, 6);
+  ASSERT_EXCEPTION(runtime_error, load_npy(path);)
+  write_npy(path, "{'descr': '<f8', 'fortran_order': False, 'shape': (3, 3), }", v, 6);
+  ASSERT_EXCEPTION(runtime_error, load_npy(path);)
+  write_npy(path, "{'descr': '<f8', 'shape': (2, 3), }", v, 6);
+  ASSERT_EXCEPTION(runtime_error, load_npy(path);)
+  write_npy(path, "{'descr': '<f8', 'fortran_order': False, 'shape': (2, 3), }", v, 6, 0, 4);
+  ASSERT_EXCEPTION(runtime_error, load_npy(path);)
+  remove(path.c_str());
+  TEST_PASSED;
+}
+
+void test_npz()
+{
+  string path = temp_path("arrays.npz");
+  Matrix A(30, 40), B(7, 3), E(0, 5);
+  fill_index(A);
+  fill_index(B);
+  save_npz(path, {{"A", A}, {"Bt", B.t()}, {"sub", A.slice(1, 4, 2, 9)}, {"E", E},
+                  {"x", A.col(2)}});
+  auto m = load_npz(path);
+  assert(m.size() == 5);
+  assert(m.at("A") == A && m.at("Bt") == B.t() && m.at("sub") == A.slice(1, 4, 2, 9));
+  assert(m.at("E").nr() == 0 && m.at("E").nc() == 5 && m.at("x") == A.col(2));
+
+  // 成员数据对齐且共享同一映射区
+  for(auto &[key, M] : m)
+    assert((uintptr_t)M.ptr() % 64 == 0 && M.ref() == 6);
+  Matrix x = m.at("x");
+  m.clear();
+  assert(x == A.col(2) && x.ref() == 2);
+
+  // 首个成员的本地文件头位于存档开头
+  string s = read_file(path);
+  size_t pos = s.find("A.npy");
+  assert(pos != string::npos && pos == 30);
+
+  save_npz(path, { });
+  assert(load_npz(path).empty());
+
+  ofstream(path) << "not a zip file, long enough to scan";
+  ASSERT_EXCEPTION(runtime_error, load_npz(path);)
+  remove(path.c_str());
+  ASSERT_EXCEPTION(system_error, load_npz(path);)
+  TEST_PASSED;
+}
+
+void test_npy_repeat()
+{
+  string path = temp_path("repeat.npy");
+  size_t n = 4096;
+  Matrix A(n, n);
+  A.fill(1);
+  clock_t start = clock();
+  save_npy(path, A.t());
+  clock_t diff = clock() - start;
+  cout << "It took " << (double)diff / CLOCKS_PER_SEC << " s to save a "
+       << n << "x" << n << " matrix in Fortran order." << endl;
+
+  start = clock();
+  for(int t = 0; t < 1000; ++t)
+    load_npy(path);
+  diff = clock() - start;
+  cout << "It took " << (double)diff / CLOCKS_PER_SEC << " s to load it 1000 times." << endl;
+  remove(path.c_str());
+  TEST_PASSED;
+}
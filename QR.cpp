@@ -0,0 +1,285 @@
+#include "QR.h"
+#include "Blas.h"
+#include "Kernel.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+constexpr size_t block = QR::block, chunk = QR::chunk;
+
+// [i0, i1) 按 chunk 行分成的段数
+size_t segments(size_t i0, size_t i1)
+{
+  return i1 > i0 ? (i1 - i0 + chunk - 1) / chunk : 0;
+}
+
+// 对 [i0, i1) 的第 s 段 [r0, r1) 调用 f(s, r0, r1)，多于一段时交给线程池
+template<class F>
+void for_segments(size_t i0, size_t i1, F f)
+{
+  size_t n = segments(i0, i1);
+  if(n == 1)
+    return f(0, i0, i1);
+  parallel_for(n, [&](size_t s) {
+    size_t r0 = i0 + s * chunk;
+    f(s, r0, std::min(r0 + chunk, i1));
+  });
+}
+
+// C += X^T Y，X 与 Y 行数相同且可以很多，按行分段求积后依次归约
+void crossprod(const Matrix &X, const Matrix &Y, const Matrix &C)
+{
+  size_t n = segments(0, X.nr()), p = C.nr();
+  if(n <= 1)
+  {
+    if(n)
+      gemm(1, X.t(), Y, 1, C);
+    return;
+  }
+  Matrix P(n * p, C.nc());
+  for_segments(0, X.nr(), [&](size_t s, size_t r0, size_t r1) {
+    gemm(1, X.row_slice(r0, r1).t(), Y.row_slice(r0, r1), 0, P.row_slice(s * p, s * p + p));
+  });
+  for(size_t s = 0; s < n; ++s)
+    C += P.row_slice(s * p, s * p + p);
+}
+
+// 第 [k0, k1) 列的反射向量的前 kb 行，显式写出单位下三角
+Matrix unit_lower(const Matrix &A, size_t k0, size_t k1)
+{
+  size_t kb = k1 - k0;
+  Matrix V1(kb, kb);
+  for(size_t r = 0; r < kb; ++r)
+    for(size_t c = 0; c < kb; ++c)
+      V1(r, c) = r == c ? 1 : r > c ? A(k0 + r, k0 + c) : 0;
+  return V1;
+}
+
+// 面板第 j 列在 [r0, r1) 行的一趟扫描，NW 为右侧列数
+// v = x * scale，A(i, j+1:j+1+NW) -= v w，再为第 j + 1 列累加平方和与交叉积
+template<size_t NW>
+void leaf_rows(const Matrix &A, size_t j, size_t r0, size_t r1, Number scale,
+    const Number *w, Number *acc)
+{
+  size_t sc = A.sc();
+  for(size_t i = r0; i < r1; ++i)
+  {
+    Number *a = &A(i, j);
+    Number v = a[0] *= scale;
+    for(size_t c = 0; c < NW; ++c)
+      a[(c + 1) * sc] -= v * w[c];
+    if(NW && i > j + 1)
+    {
+      Number x = a[sc];
+      acc[0] += x * x;
+      for(size_t c = 1; c < NW; ++c)
+        acc[c] += x * a[(c + 1) * sc];
+    }
+  }
+}
+
+// 逐列生成 [k0, k1) 列的反射并作用于其右侧各列，k1 - k0 不超过 leaf
+// 第 j 列所需的平方和 sigma 与交叉积 u = x^T A(j+1:m, j+1:k1) 由上一趟扫描顺带累加，
+// 缩放 v = x / (alpha - beta) 推迟到本趟，故每列只扫描一遍
+// part 为各段的累加缓冲区，至少 segments(0, m) 行 leaf 列
+void factor_leaf(const Matrix &A, std::vector<Number> &taus, size_t k0, size_t k1,
+    const Matrix &part)
+{
+  constexpr size_t leaf = QR::leaf;
+  size_t m = A.nr(), sc = A.sc();
+  Number u[leaf], w[leaf];
+
+  // 累加上一趟扫描的 ns 段结果，段数须与该趟一致
+  auto reduce = [&](size_t ns, size_t nw) {
+    for(size_t c = 0; c <= nw; ++c)
+    {
+      u[c] = 0;
+      for(size_t g = 0; g < ns; ++g)
+        u[c] += part(g, c);
+    }
+  };
+
+  // 累加第 j 列在 i 行的贡献，acc[0] 为平方和，acc[1 + c] 为交叉积
+  auto accumulate = [&](Number *acc, size_t i, size_t j, size_t nw) {
+    const Number *a = &A(i, j);
+    acc[0] += a[0] * a[0];
+    for(size_t c = 0; c < nw; ++c)
+      acc[1 + c] += a[0] * a[(c + 1) * sc];
+  };
+
+  size_t nw = k1 - k0 - 1;
+  for_segments(k0 + 1, m, [&](size_t s, size_t r0, size_t r1) {
+    Number *acc = &part(s, 0);
+    std::fill(acc, acc + nw + 1, 0);
+    for(size_t i = r0; i < r1; ++i)
+      accumulate(acc, i, k0, nw);
+  });
+  reduce(segments(k0 + 1, m), nw);
+
+  for(size_t j = k0; j < k1; ++j)
+  {
+    nw = k1 - j - 1;
+    Number sigma = u[0], alpha = A(j, j), beta = alpha, tau = 0, scale = 0;
+    if(sigma != 0)
+    {
+      beta = -std::copysign(std::sqrt(alpha * alpha + sigma), alpha);
+      tau = (beta - alpha) / beta;
+      scale = 1 / (alpha - beta);
+    }
+    A(j, j) = beta;
+    taus[j] = tau;
+    for(size_t c = 0; c < nw; ++c)
+    {
+      w[c] = tau * (A(j, j + 1 + c) + scale * u[1 + c]);
+      A(j, j + 1 + c) -= w[c];
+    }
+
+    // 缩放 v，更新右侧各列，并为下一列累加
+    for_segments(j + 1, m, [&](size_t s, size_t r0, size_t r1) {
+      Number *acc = &part(s, 0);
+      std::fill(acc, acc + nw, 0);
+      switch(nw)
+      {
+      case 0: leaf_rows<0>(A, j, r0, r1, scale, w, acc); break;
+      case 1: leaf_rows<1>(A, j, r0, r1, scale, w, acc); break;
+      case 2: leaf_rows<2>(A, j, r0, r1, scale, w, acc); break;
+      case 3: leaf_rows<3>(A, j, r0, r1, scale, w, acc); break;
+      case 4: leaf_rows<4>(A, j, r0, r1, scale, w, acc); break;
+      case 5: leaf_rows<5>(A, j, r0, r1, scale, w, acc); break;
+      case 6: leaf_rows<6>(A, j, r0, r1, scale, w, acc); break;
+      case 7: leaf_rows<7>(A, j, r0, r1, scale, w, acc); break;
+      }
+    });
+    if(nw)
+      reduce(segments(j + 1, m), nw - 1);
+  }
+}
+
+// 由 G = V^T V 按列递推 T(0:i, i) = -tau_i T(0:i, 0:i) G(0:i, i)
+void form_t(const Matrix &A, const std::vector<Number> &taus, size_t k0, size_t k1,
+    const Matrix &T)
+{
+  size_t m = A.nr(), kb = k1 - k0;
+  Matrix V1 = unit_lower(A, k0, k1), G(kb, kb);
+  gemm(1, V1.t(), V1, 0, G);
+  if(k1 < m)
+    crossprod(A.slice(k1, m, k0, k1), A.slice(k1, m, k0, k1), G);
+
+  for(size_t i = 0; i < kb; ++i)
+  {
+    Number tau = taus[k0 + i];
+    for(size_t r = 0; r < i; ++r)
+    {
+      Number z = 0;
+      for(size_t s = r; s < i; ++s)
+        z += T(r, s) * G(s, i);
+      T(r, i) = -tau * z;
+    }
+    T(i, i) = tau;
+    for(size_t r = i + 1; r < kb; ++r)
+      T(r, i) = 0;
+  }
+}
+
+// C = (I - V T V^T) C 或 trans 时 C = (I - V T^T V^T) C
+// V 为 A 的 [k0, k1) 列的反射，C 为 A 的第 k0 行起的 m - k0 行
+void apply_panel(const Matrix &A, const Matrix &T, size_t k0, size_t k1, bool trans,
+    const Matrix &C)
+{
+  size_t m = A.nr(), kb = k1 - k0;
+  Matrix V1 = unit_lower(A, k0, k1), W(kb, C.nc()), W2(kb, C.nc());
+  gemm(1, V1.t(), C.row_slice(0, kb), 0, W);
+  if(k1 < m)
+    crossprod(A.slice(k1, m, k0, k1), C.row_slice(kb), W);
+  gemm(1, trans ? T.t() : T, W, 0, W2);
+  gemm(-1, V1, W2, 1, C.row_slice(0, kb));
+  if(k1 < m)
+    gemm(-1, A.slice(k1, m, k0, k1), W2, 1, C.row_slice(kb));
+}
+
+// 递归分解 [k0, k1) 列，合并得到的 T 写入 kb 阶方阵视图 T
+// T = [T1, -T1 V1^T V2 T2; 0, T2]
+void factor_panel(const Matrix &A, std::vector<Number> &taus, size_t k0, size_t k1,
+    const Matrix &T, const Matrix &part)
+{
+  size_t m = A.nr(), kb = k1 - k0;
+  if(kb <= QR::leaf)
+  {
+    factor_leaf(A, taus, k0, k1, part);
+    form_t(A, taus, k0, k1, T);
+    return;
+  }
+  size_t h = kb / 2, mid = k0 + h;
+  Matrix T1 = T.slice(0, h), T2 = T.slice(h, kb), T12 = T.slice(0, h, h, kb);
+  factor_panel(A, taus, k0, mid, T1, part);
+  apply_panel(A, T1, k0, mid, true, A.slice(k0, m, mid, k1));
+  factor_panel(A, taus, mid, k1, T2, part);
+
+  // V1^T V2，V2 的前 kb - h 行为单位下三角，其上各行为零
+  gemm(1, A.slice(mid, k1, k0, mid).t(), unit_lower(A, mid, k1), 0, T12);
+  if(k1 < m)
+    crossprod(A.slice(k1, m, k0, mid), A.slice(k1, m, mid, k1), T12);
+  Matrix S(h, kb - h);
+  gemm(-1, T1, T12, 0, S);
+  gemm(1, S, T2, 0, T12);
+  T.slice(h, kb, 0, h).fill(0);
+}
+
+}  // namespace
+
+QR::QR(const Matrix &A)
+  : qr(A), t(block, std::min(A.nr(), A.nc())), taus(t.nc())
+{
+  size_t m = nr(), n = nc(), k = t.nc();
+  Matrix part(std::max<size_t>(segments(0, m), 1), leaf);
+  for(size_t k0 = 0; k0 < k; k0 += block)
+  {
+    size_t k1 = std::min(k0 + block, k);
+    Matrix T = t.slice(0, k1 - k0, k0, k1);
+    factor_panel(qr, taus, k0, k1, T, part);
+    if(k1 < n)
+      apply_panel(qr, T, k0, k1, true, qr.slice(k0, m, k1, n));
+  }
+}
+
+void QR::apply_qt(const Matrix &B) const
+{
+  if(B.nr() != nr())
+    throw std::invalid_argument("inconsistent A and B");
+  if(B.empty())
+    return;
+  for(size_t k0 = 0; k0 < t.nc(); k0 += block)
+  {
+    size_t k1 = std::min(k0 + block, t.nc());
+    apply_panel(qr, t.slice(0, k1 - k0, k0, k1), k0, k1, true, B.row_slice(k0));
+  }
+}
+
+void QR::apply_q(const Matrix &B) const
+{
+  if(B.nr() != nr())
+    throw std::invalid_argument("inconsistent A and B");
+  if(B.empty() || t.nc() == 0)
+    return;
+  for(size_t k0 = (t.nc() - 1) / block * block + block; k0 > 0; )
+  {
+    k0 -= block;
+    size_t k1 = std::min(k0 + block, t.nc());
+    apply_panel(qr, t.slice(0, k1 - k0, k0, k1), k0, k1, false, B.row_slice(k0));
+  }
+}
+
+void QR::solve(const Matrix &B) const
+{
+  if(nr() < nc())
+    throw std::domain_error("underdetermined least squares");
+  apply_qt(B);
+  for(size_t i = 0; i < nc(); ++i)
+    if(qr(i, i) == 0)
+      throw i;
+  trsm(Uplo::upper, Diag::non_unit, qr.slice(0, nc()), B.row_slice(0, nc()));
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "Basic.h"
+#include "Matrix.h"
+#include <vector>
+
+// Householder QR 分解 A = Q R，就地进行
+// A 为 m 行 n 列，共 k = min(m, n) 个反射 H_j = I - tau_j v_j v_j^T，Q = H_0 H_1 ... H_{k-1}
+// 每 block 个反射合为紧凑 WY 形式 I - V T V^T，T 为上三角
+// 面板按列对半递归分解（Elmroth-Gustavson），左半的反射以 V^T C 和 gemm 成块作用于右半，
+// T 随递归合并；不超过 leaf 列时逐列生成反射，按行分段交给线程池
+// 右侧子块和 Q 的作用同样以 V^T C 和 gemm 完成，V^T C 按行分段并行后归约
+// 分段长度固定，结果与线程数无关
+class QR {
+private:
+  Matrix  qr;  // 与 A 共享存储，上三角存 R，严格下三角存 v_j（首元为 1，不存）
+  Matrix  t;   // block 行 k 列，第 p 个面板的 T 存于 [p * block, p * block + kb) 列
+  std::vector<Number>  taus;  // 各反射的系数
+
+public:
+  static constexpr size_t block = 32;   // 面板宽度
+  static constexpr size_t leaf = 8;     // 递归到此宽度以下逐列分解
+  static constexpr size_t chunk = 2048; // 按行并行时每段的行数
+
+  // 就地分解 A；传入 A.copy() 可保留原矩阵
+  explicit QR(const Matrix &A);
+
+  size_t nr() const { return qr.nr(); }
+  size_t nc() const { return qr.nc(); }
+
+  // R 与反射向量所在的视图
+  const Matrix &factors() const { return qr; }
+
+  // 第 j 个反射的系数
+  Number tau(size_t j) const { return taus[j]; }
+
+  // B = Q^T B 或 B = Q B，不显式构造 Q
+  // B 行数与 A 不等时抛 invalid_argument
+  void apply_qt(const Matrix &B) const;
+  void apply_q(const Matrix &B) const;
+
+  // 最小二乘 min |A X - B|，B 可有任意列，结果 X 写入 B 的前 n 行，
+  // 其余 m - n 行为 Q^T B 的剩余部分，其各列的模即残差的模
+  // A 的行少于列时抛 domain_error，B 行数与 A 不等时抛 invalid_argument
+  // R 的对角元为零（A 列秩亏）时抛 size_t 所在行
+  void solve(const Matrix &B) const;
+};
@@ -0,0 +1,235 @@
+#include "TestBasic.h"
+#include "TestMatrix.h"
+#include "QR.h"
+#include "Cholesky.h"
+#include <random>
+#include <ctime>
+#include <cmath>
+
+using namespace std;
+
+void test_QR_factors();
+void test_QR_apply();
+void test_QR_least_squares();
+void test_QR_segments();
+void test_QR_errors();
+void test_QR_threads();
+void test_QR_repeat();
+
+int main()
+{
+  seed_engine();
+  test_QR_factors();
+  test_QR_apply();
+  test_QR_least_squares();
+  test_QR_segments();
+  test_QR_errors();
+  test_QR_threads();
+  test_QR_repeat();
+}
+
+// 显式构造 Q 和 R，检查 Q 正交且 Q R = A
+void test_QR_factors()
+{
+  for(auto shape : { make_pair(1, 1), make_pair(5, 3), make_pair(3, 5), make_pair(65, 65),
+                     make_pair(100, 37), make_pair(37, 100), make_pair(300, 70) })
+  {
+    size_t m = shape.first, n = shape.second;
+    Matrix A = random(m, n);
+    QR qr(A.copy());
+    Matrix Q = identity(m);
+    qr.apply_q(Q);
+    assert(max_abs(Q.t() * Q - identity(m)) < 1e-13 * m);
+
+    Matrix R(m, n);
+    R.fill(0);
+    for(size_t i = 0; i < m; ++i)
+      for(size_t j = i; j < n; ++j)
+        R(i, j) = qr.factors()(i, j);
+    assert(max_abs(Q * R - A) < 1e-13 * m);
+    for(size_t j = 0; j < min(m, n); ++j)
+      assert(qr.tau(j) == 0 || (qr.tau(j) >= 1 && qr.tau(j) <= 2));
+  }
+
+  // 已是上三角时反射为恒等
+  Matrix U = random(4, 4);
+  for(size_t i = 0; i < 4; ++i)
+    for(size_t j = 0; j < i; ++j)
+      U(i, j) = 0;
+  Matrix U0 = U.copy();
+  QR qu(U);
+  for(size_t j = 0; j < 3; ++j)
+    assert(qu.tau(j) == 0);
+  assert(U == U0);
+  TEST_PASSED;
+}
+
+void test_QR_apply()
+{
+  size_t m = 150, n = 80;
+  Matrix A = random(m, n);
+  QR qr(A.copy());
+  Matrix B = random(m, 9), C = B.copy();
+  qr.apply_qt(C);
+  qr.apply_q(C);
+  assert(max_abs(C - B) < 1e-13);
+
+  // Q^T A 即 R
+  Matrix R = A.copy();
+  qr.apply_qt(R);
+  for(size_t i = 0; i < m; ++i)
+    for(size_t j = 0; j < n; ++j)
+      assert(abs(R(i, j) - (j >= i ? qr.factors()(i, j) : 0)) < 1e-13);
+
+  // 转置视图
+  Matrix Bt = B.t().copy();
+  qr.apply_qt(Bt.t());
+  C = B.copy();
+  qr.apply_qt(C);
+  assert(max_abs(Bt.t() - C) < 1e-14);
+  TEST_PASSED;
+}
+
+void test_QR_least_squares()
+{
+  // 相容方程组得到精确解
+  size_t m = 200, n = 40;
+  Matrix A = random(m, n), X = random(n, 3);
+  Matrix B = A * X;
+  QR(A.copy()).solve(B);
+  assert(max_abs(B.row_slice(0, n) - X) < 1e-12);
+  assert(max_abs(B.row_slice(n)) < 1e-12);
+
+  // 残差与 A 的列空间正交，其模等于 Q^T B 的剩余部分
+  Matrix b = random(m, 1), x = b.copy();
+  QR(A.copy()).solve(x);
+  Matrix r = b - A * x.row_slice(0, n);
+  assert(max_abs(A.t() * r) < 1e-12);
+  Number rr = 0, tail = 0;
+  for(size_t i = 0; i < m; ++i)
+    rr += r(i, 0) * r(i, 0);
+  for(size_t i = n; i < m; ++i)
+    tail += x(i, 0) * x(i, 0);
+  assert(abs(sqrt(rr) - sqrt(tail)) < 1e-12);
+
+  // 与正规方程一致
+  Matrix N = A.t() * A, y = A.t() * b;
+  Cholesky(N).solve(y);
+  assert(max_abs(y - x.row_slice(0, n)) < 1e-10);
+
+  // 方阵即线性方程组
+  Matrix S = random(70, 70), s = random(70, 2), z = s.copy();
+  QR(S.copy()).solve(z);
+  assert(max_abs(S * z - s) < 1e-11);
+  TEST_PASSED;
+}
+
+// 行数跨过 chunk 的整数倍，各列分段数不同，归约须与扫描的段数一致
+void test_QR_segments()
+{
+  size_t chunk = QR::chunk;
+  for(size_t m : {chunk + 1, chunk + 2, chunk + 3, 2 * chunk + 1, 2 * chunk + 2})
+  for(size_t n : {3, 10})
+  {
+    Matrix A = random(m, n), b = random(m, 1), x = b.copy();
+    QR qr(A.copy());
+    Matrix R(n, n);
+    R.fill(0);
+    for(size_t i = 0; i < n; ++i)
+      for(size_t j = i; j < n; ++j)
+        R(i, j) = qr.factors()(i, j);
+    Matrix N = A.t() * A;
+    assert(max_abs(R.t() * R - N) < 1e-13 * max_abs(N));
+
+    qr.solve(x);
+    Matrix r = b - A * x.row_slice(0, n);
+    assert(max_abs(A.t() * r) < 1e-11);
+  }
+  TEST_PASSED;
+}
+
+void test_QR_errors()
+{
+  QR qr(random(5, 3));
+  ASSERT_EXCEPTION(invalid_argument, qr.apply_qt(Matrix(4, 1));)
+  ASSERT_EXCEPTION(invalid_argument, qr.apply_q(Matrix(6, 1));)
+  ASSERT_EXCEPTION(invalid_argument, qr.solve(Matrix(3, 1));)
+  ASSERT_EXCEPTION(domain_error, QR(random(3, 5)).solve(Matrix(3, 1));)
+  QR(Matrix(0, 0)).solve(Matrix(0, 2));
+  QR(Matrix(4, 0)).solve(Matrix(4, 2));
+
+  // 列秩亏：第 2 列为零
+  Matrix A = random(10, 4);
+  for(size_t i = 0; i < 10; ++i)
+    A(i, 2) = 0;
+  try
+  {
+    QR(A).solve(random(10, 1));
+    assert(false);
+  }
+  catch(size_t i)
+  {
+    assert(i == 2);
+  }
+  TEST_PASSED;
+}
+
+// 分段固定，结果与线程数无关
+void test_QR_threads()
+{
+  size_t m = 20000, n = 70;
+  Matrix A = random(m, n), b = random(m, 1);
+  Matrix F1 = A.copy(), x1 = b.copy(), F4 = A.copy(), x4 = b.copy();
+  with_threads(1, [&] { QR(F1).solve(x1); });
+  with_threads(4, [&] { QR(F4).solve(x4); });
+  assert(max_abs(F1 - F4) < 1e-12 && max_abs(x1 - x4) < 1e-12);
+  TEST_PASSED;
+}
+
+// 10^6 x 50 的多项式拟合
+void test_QR_repeat()
+{
+  size_t m = 1000000, n = 50;
+  Matrix A(m, n), b(m, 1);
+  uniform_real_distribution<Number> noise(-1e-3, 1e-3);
+  for(size_t i = 0; i < m; ++i)
+  {
+    Number s = -1 + 2.0 * i / (m - 1);
+    // 第 j 列为 Chebyshev 多项式 T_j(s)
+    A(i, 0) = 1;
+    A(i, 1) = s;
+    for(size_t j = 2; j < n; ++j)
+      A(i, j) = 2 * s * A(i, j - 1) - A(i, j - 2);
+    b(i, 0) = exp(s) + noise(engine);
+  }
+
+  Matrix F = A.copy(), x = b.copy();
+  clock_t start = clock();
+  QR qr(F);
+  double factor = (double)(clock() - start) / CLOCKS_PER_SEC;
+  start = clock();
+  qr.solve(x);
+  double solve = (double)(clock() - start) / CLOCKS_PER_SEC;
+  cout << "It took " << factor << " s to factorize a " << m << "x" << n << " matrix ("
+       << 2.0 * m * n * n / factor / 1e9 << " GFLOPS) and " << solve << " s to solve." << endl;
+
+  start = clock();
+  Matrix N(n, n), y(n, 1);
+  gemm(1, A.t(), A, 0, N);
+  gemm(1, A.t(), b, 0, y);
+  Cholesky(N).solve(y);
+  double normal = (double)(clock() - start) / CLOCKS_PER_SEC;
+  cout << "It took " << normal << " s through the normal equations." << endl;
+
+  // exp 的 Chebyshev 系数 2 I_j(1)（j > 0），高阶项应被噪声淹没
+  Number c1 = 2 * 0.5651591039924851;
+  cout << "Coefficient of T_1: " << x(1, 0) << " (QR), " << y(1, 0) << " (normal), "
+       << c1 << " (exact)." << endl;
+  assert(abs(x(1, 0) - c1) < 1e-5);
+
+  F = A;
+  double wall = threaded_seconds(4, [&] { QR(F).solve(b); });
+  cout << "It took " << wall << " s to factorize and solve with 4 threads." << endl;
+  assert(max_abs(b.row_slice(0, n) - x.row_slice(0, n)) < 1e-12);
+  TEST_PASSED;
+}
@@ -0,0 +1,300 @@
+#pragma once
+
+// 编译期定长的小矩阵，矩阵元直接存放于对象内，不使用堆内存
+// 适用于 3x3、4x4 等小规模运算；循环边界均为常量，运算全部展开
+// 与 Matrix 不同，SMatrix 具有值语义，拷贝即复制全部矩阵元
+
+#include "Matrix.h"
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+template<size_t Nr, size_t Nc, class T = Number>
+class SMatrix {
+  static_assert(Nr > 0 && Nc > 0, "empty fixed-size matrix");
+private:
+  T  a[Nr][Nc];
+
+public:
+  typedef T value_type;
+
+  // 矩阵元不初始化
+  SMatrix() = default;
+
+  template<class M>
+    constexpr SMatrix(const M (&m)[Nr][Nc]) : a{ }
+    {
+#pragma GCC unroll 64
+      for(size_t i = 0; i < Nr; ++i)
+#pragma GCC unroll 64
+        for(size_t j = 0; j < Nc; ++j)
+          a[i][j] = m[i][j];
+    }
+
+  // 从矩阵视图复制，形状不一致时抛 domain_error
+  explicit SMatrix(const BasicMatrix<T> &m) { *this = m; }
+  SMatrix &operator=(const BasicMatrix<T> &m);
+
+  static constexpr SMatrix filled(T v);
+  static constexpr SMatrix identity();
+
+  static constexpr size_t nr() { return Nr; }
+  static constexpr size_t nc() { return Nc; }
+  static constexpr bool square() { return Nr == Nc; }
+
+  T *ptr() { return &a[0][0]; }
+  const T *ptr() const { return &a[0][0]; }
+
+  // 行访问和矩阵元访问（无越界检查）
+  constexpr T *operator[](size_t i) { return a[i]; }
+  constexpr const T *operator[](size_t i) const { return a[i]; }
+  constexpr T &operator()(size_t i, size_t j) { return a[i][j]; }
+  constexpr const T &operator()(size_t i, size_t j) const { return a[i][j]; }
+
+  // 借用本对象存储的矩阵视图，不分配内存，见 BasicMatrix::borrow
+  // 视图及其切片须在本对象析构前析构
+  BasicMatrix<T> view() { return BasicMatrix<T>::borrow(ptr(), Nr, Nc, Nc); }
+
+  constexpr SMatrix<Nc, Nr, T> t() const;
+
+  constexpr SMatrix &operator+=(const SMatrix &);
+  constexpr SMatrix &operator-=(const SMatrix &);
+  constexpr SMatrix &operator*=(T);
+  constexpr SMatrix &operator/=(T);
+};
+
+template<size_t Nr, size_t Nc, class T>
+SMatrix<Nr, Nc, T> &SMatrix<Nr, Nc, T>::operator=(const BasicMatrix<T> &m)
+{
+  if(m.nr() != Nr || m.nc() != Nc)
+    throw std::domain_error("inconsistent shapes");
+  for(size_t i = 0; i < Nr; ++i)
+  {
+    const T *p = m.ptr() + i * m.sr();
+#pragma GCC unroll 64
+    for(size_t j = 0; j < Nc; ++j)
+      a[i][j] = p[j * m.sc()];
+  }
+  return *this;
+}
+
+template<size_t Nr, size_t Nc, class T>
+constexpr SMatrix<Nr, Nc, T> SMatrix<Nr, Nc, T>::filled(T v)
+{
+  SMatrix S{ };
+#pragma GCC unroll 64
+  for(size_t i = 0; i < Nr; ++i)
+#pragma GCC unroll 64
+    for(size_t j = 0; j < Nc; ++j)
+      S.a[i][j] = v;
+  return S;
+}
+
+template<size_t Nr, size_t Nc, class T>
+constexpr SMatrix<Nr, Nc, T> SMatrix<Nr, Nc, T>::identity()
+{
+  SMatrix S = filled(0);
+#pragma GCC unroll 64
+  for(size_t i = 0; i < Nr && i < Nc; ++i)
+    S.a[i][i] = 1;
+  return S;
+}
+
+template<size_t Nr, size_t Nc, class T>
+constexpr SMatrix<Nc, Nr, T> SMatrix<Nr, Nc, T>::t() const
+{
+  SMatrix<Nc, Nr, T> S{ };
+#pragma GCC unroll 64
+  for(size_t i = 0; i < Nr; ++i)
+#pragma GCC unroll 64
+    for(size_t j = 0; j < Nc; ++j)
+      S(j, i) = a[i][j];
+  return S;
+}
+
+template<size_t Nr, size_t Nc, class T>
+constexpr SMatrix<Nr, Nc, T> &SMatrix<Nr, Nc, T>::operator+=(const SMatrix &m)
+{
+#pragma GCC unroll 64
+  for(size_t i = 0; i < Nr; ++i)
+#pragma GCC unroll 64
+    for(size_t j = 0; j < Nc; ++j)
+      a[i][j] += m.a[i][j];
+  return *this;
+}
+
+template<size_t Nr, size_t Nc, class T>
+constexpr SMatrix<Nr, Nc, T> &SMatrix<Nr, Nc, T>::operator-=(const SMatrix &m)
+{
+#pragma GCC unroll 64
+  for(size_t i = 0; i < Nr; ++i)
+#pragma GCC unroll 64
+    for(size_t j = 0; j < Nc; ++j)
+      a[i][j] -= m.a[i][j];
+  return *this;
+}
+
+template<size_t Nr, size_t Nc, class T>
+constexpr SMatrix<Nr, Nc, T> &SMatrix<Nr, Nc, T>::operator*=(T k)
+{
+#pragma GCC unroll 64
+  for(size_t i = 0; i < Nr; ++i)
+#pragma GCC unroll 64
+    for(size_t j = 0; j < Nc; ++j)
+      a[i][j] *= k;
+  return *this;
+}
+
+template<size_t Nr, size_t Nc, class T>
+constexpr SMatrix<Nr, Nc, T> &SMatrix<Nr, Nc, T>::operator/=(T k)
+{
+#pragma GCC unroll 64
+  for(size_t i = 0; i < Nr; ++i)
+#pragma GCC unroll 64
+    for(size_t j = 0; j < Nc; ++j)
+      a[i][j] /= k;
+  return *this;
+}
+
+template<size_t Nr, size_t Nc, class T>
+constexpr SMatrix<Nr, Nc, T> operator+(SMatrix<Nr, Nc, T> A, const SMatrix<Nr, Nc, T> &B)
+{
+  return A += B;
+}
+
+template<size_t Nr, size_t Nc, class T>
+constexpr SMatrix<Nr, Nc, T> operator-(SMatrix<Nr, Nc, T> A, const SMatrix<Nr, Nc, T> &B)
+{
+  return A -= B;
+}
+
+template<size_t Nr, size_t Nc, class T>
+constexpr SMatrix<Nr, Nc, T> operator-(SMatrix<Nr, Nc, T> A)
+{
+  return A *= T(-1);
+}
+
+template<size_t Nr, size_t Nc, class T>
+constexpr SMatrix<Nr, Nc, T> operator*(SMatrix<Nr, Nc, T> A, scalar_t<T> k)
+{
+  return A *= k;
+}
+
+template<size_t Nr, size_t Nc, class T>
+constexpr SMatrix<Nr, Nc, T> operator*(scalar_t<T> k, SMatrix<Nr, Nc, T> A)
+{
+  return A *= k;
+}
+
+template<size_t Nr, size_t Nc, class T>
+constexpr SMatrix<Nr, Nc, T> operator/(SMatrix<Nr, Nc, T> A, scalar_t<T> k)
+{
+  return A /= k;
+}
+
+// 矩阵乘法，按 C 的行累加 A(i, k) * B 的第 k 行，内层两重循环展开后可向量化
+template<size_t Nr, size_t K, size_t Nc, class T>
+constexpr SMatrix<Nr, Nc, T> operator*(const SMatrix<Nr, K, T> &A, const SMatrix<K, Nc, T> &B)
+{
+  SMatrix<Nr, Nc, T> C{ };
+#pragma GCC unroll 64
+  for(size_t i = 0; i < Nr; ++i)
+  {
+#pragma GCC unroll 64
+    for(size_t j = 0; j < Nc; ++j)
+      C(i, j) = A(i, 0) * B(0, j);
+#pragma GCC unroll 64
+    for(size_t k = 1; k < K; ++k)
+#pragma GCC unroll 64
+      for(size_t j = 0; j < Nc; ++j)
+        C(i, j) += A(i, k) * B(k, j);
+  }
+  return C;
+}
+
+template<size_t Nr, size_t Nc, class T>
+constexpr bool operator==(const SMatrix<Nr, Nc, T> &A, const SMatrix<Nr, Nc, T> &B)
+{
+  for(size_t i = 0; i < Nr; ++i)
+    for(size_t j = 0; j < Nc; ++j)
+      if(A(i, j) != B(i, j))
+        return false;
+  return true;
+}
+
+template<size_t Nr, size_t Nc, class T>
+constexpr bool operator!=(const SMatrix<Nr, Nc, T> &A, const SMatrix<Nr, Nc, T> &B)
+{
+  return !(A == B);
+}
+
+template<size_t Nr, size_t Nc, class T>
+std::ostream &operator<<(std::ostream &os, const SMatrix<Nr, Nc, T> &A)
+{
+  SMatrix<Nr, Nc, T> S = A;
+  return os << S.view();
+}
+
+// 列主元高斯约当消元，就地将 Ab 化为 [I X]，Ab 中最左 Nr 列方阵视为 A，其余为 b
+// 主元为零时抛 size_t 失败行号，与 Equation.h 的 solve_GJ 一致
+template<size_t Nr, size_t Nc, class T>
+constexpr void solve_GJ(SMatrix<Nr, Nc, T> &Ab)
+{
+  static_assert(Nr <= Nc, "invalid argumented matrix");
+  using std::abs;
+#pragma GCC unroll 16
+  for(size_t k = 0; k < Nr; ++k)
+  {
+    size_t p = k;
+    for(size_t i = k + 1; i < Nr; ++i)
+      if(abs(Ab(i, k)) > abs(Ab(p, k)))
+        p = i;
+    if(Ab(p, k) == T(0))
+      throw k;
+    if(p != k)
+#pragma GCC unroll 64
+      for(size_t j = k; j < Nc; ++j)
+        std::swap(Ab(k, j), Ab(p, j));
+    T r = T(1) / Ab(k, k);
+    Ab(k, k) = 1;
+#pragma GCC unroll 64
+    for(size_t j = k + 1; j < Nc; ++j)
+      Ab(k, j) *= r;
+#pragma GCC unroll 16
+    for(size_t i = 0; i < Nr; ++i)
+    {
+      if(i == k)
+        continue;
+      T f = Ab(i, k);
+      Ab(i, k) = 0;
+#pragma GCC unroll 64
+      for(size_t j = k + 1; j < Nc; ++j)
+        Ab(i, j) -= f * Ab(k, j);
+    }
+  }
+}
+
+// 求解 A X = B，A 与 B 不被改写；A 奇异时抛 size_t 失败行号
+template<size_t N, size_t M, class T>
+constexpr SMatrix<N, M, T> solve(const SMatrix<N, N, T> &A, const SMatrix<N, M, T> &B)
+{
+  SMatrix<N, N + M, T> Ab{ };
+#pragma GCC unroll 16
+  for(size_t i = 0; i < N; ++i)
+  {
+#pragma GCC unroll 64
+    for(size_t j = 0; j < N; ++j)
+      Ab(i, j) = A(i, j);
+#pragma GCC unroll 64
+    for(size_t j = 0; j < M; ++j)
+      Ab(i, N + j) = B(i, j);
+  }
+  solve_GJ(Ab);
+  SMatrix<N, M, T> X{ };
+#pragma GCC unroll 16
+  for(size_t i = 0; i < N; ++i)
+#pragma GCC unroll 64
+    for(size_t j = 0; j < M; ++j)
+      X(i, j) = Ab(i, N + j);
+  return X;
+}
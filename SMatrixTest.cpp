@@ -0,0 +1,212 @@
+#include "TestBasic.h"
+#include "SMatrix.h"
+#include "Equation.h"
+#include <type_traits>
+#include <complex>
+#include <cstdlib>
+#include <ctime>
+#include <cmath>
+
+using namespace std;
+
+void test_SMatrix_basic();
+void test_SMatrix_view();
+void test_SMatrix_dot();
+void test_SMatrix_solve();
+void test_SMatrix_repeat();
+
+int main()
+{
+  test_SMatrix_basic();
+  test_SMatrix_view();
+  test_SMatrix_dot();
+  test_SMatrix_solve();
+  test_SMatrix_repeat();
+}
+
+template<size_t Nr, size_t Nc, class T>
+static void fill_random(SMatrix<Nr, Nc, T> &S)
+{
+  for(size_t i = 0; i < Nr; ++i)
+    for(size_t j = 0; j < Nc; ++j)
+      S(i, j) = (double)rand() / RAND_MAX - 0.5;
+}
+
+void test_SMatrix_basic()
+{
+  typedef SMatrix<3, 3> S33;
+  static_assert(sizeof(S33) == 9 * sizeof(Number));
+  static_assert(is_trivially_copyable_v<S33>);
+  static_assert(S33::nr() == 3 && SMatrix<2, 5>::nc() == 5);
+
+  // 编译期求值
+  constexpr int in[2][2] = { 1, 2, 3, 4 };
+  constexpr SMatrix<2, 2> A(in);
+  constexpr SMatrix<2, 2> B = A * A.t() + SMatrix<2, 2>::identity() * 2;
+  static_assert(B(0, 0) == 7 && B(0, 1) == 11 && B(1, 0) == 11 && B(1, 1) == 27);
+
+  S33 I = S33::identity(), C = S33::filled(2);
+  assert(C - I + I == C && C != I);
+  assert(-C == C * -1 && C / 2 == S33::filled(1));
+  C += I;
+  C -= I * 2;
+  assert(C(0, 0) == 1 && C(0, 1) == 2);
+  cout << C << endl;
+  TEST_PASSED;
+}
+
+// 借用视图与 Matrix 混合运算，写入直接落在 SMatrix 上
+void test_SMatrix_view()
+{
+  SMatrix<3, 4> S;
+  fill_random(S);
+  Matrix v = S.view();
+  assert(v.nr() == 3 && v.nc() == 4 && v.ptr() == S.ptr() && v.ref() != 1);
+  for(size_t i = 0; i < 3; ++i)
+    for(size_t j = 0; j < 4; ++j)
+      assert(v(i, j) == S(i, j));
+
+  // 视图的切片、拷贝和赋值
+  Matrix A(3, 4);
+  A.fill(1);
+  Matrix w = v.col_slice(1, 3), u = w;
+  u.fill(5);
+  assert(S(2, 1) == 5 && S(0, 2) == 5);
+  v = A * 2;
+  assert(S == (SMatrix<3, 4>::filled(2)));
+  v += A;
+  assert(S(1, 3) == 3);
+
+  // 右值视图不被就地改写
+  Matrix r = std::move(v) + A;
+  assert(S == (SMatrix<3, 4>::filled(3)) && r(0, 0) == 4);
+  Matrix B(3, 4);
+  B.fill(7);
+  Matrix x = S.view();
+  x = std::move(B);
+  assert(S == (SMatrix<3, 4>::filled(7)) && x.ptr() == S.ptr());
+
+  // 从任意视图复制，形状不一致时抛异常
+  SMatrix<4, 3> T(A.t() * 2);
+  assert(T == (SMatrix<4, 3>::filled(2)));
+  SMatrix<3, 2> Q(A.col_slice(1, 3));
+  assert(Q == (SMatrix<3, 2>::filled(1)));
+  typedef SMatrix<3, 3> S33;
+  ASSERT_EXCEPTION(domain_error, S33{ A };)
+  Matrix M(4, 3, T);
+  assert(M == A.t() * 2);
+
+  // 与 Matrix 的乘法结果一致
+  SMatrix<4, 4> P;
+  fill_random(P);
+  Matrix PT = P.view() * T.view();
+  assert((SMatrix<4, 3>(PT)) == P * T);
+  TEST_PASSED;
+}
+
+void test_SMatrix_dot()
+{
+  SMatrix<5, 7> A;
+  SMatrix<7, 3> B;
+  fill_random(A);
+  fill_random(B);
+  SMatrix<5, 3> C = A * B;
+  for(size_t i = 0; i < 5; ++i)
+    for(size_t j = 0; j < 3; ++j)
+    {
+      Number c = 0;
+      for(size_t k = 0; k < 7; ++k)
+        c += A(i, k) * B(k, j);
+      assert(fabs(C(i, j) - c) < 1e-14);
+    }
+  assert(C.t() == B.t() * A.t());
+
+  SMatrix<2, 2, complex<double>> Z = SMatrix<2, 2, complex<double>>::identity();
+  Z(0, 1) = complex<double>(0, 1);
+  assert((Z * Z)(0, 1) == complex<double>(0, 2));
+  TEST_PASSED;
+}
+
+void test_SMatrix_solve()
+{
+  double in[2][3] = {
+    2, 3, 11,
+    3, 1, 6,
+  };
+  SMatrix<2, 3> Ab(in);
+  solve_GJ(Ab);
+  cout << Ab << endl;
+  assert(fabs(Ab(0, 2) - 1) < 1e-15 && fabs(Ab(1, 2) - 3) < 1e-15);
+
+  for(int t = 0; t < 1000; ++t)
+  {
+    SMatrix<4, 4> A;
+    SMatrix<4, 2> B;
+    fill_random(A);
+    fill_random(B);
+    SMatrix<4, 2> X = solve(A, B), R = A * X - B;
+    for(size_t i = 0; i < 4; ++i)
+      for(size_t j = 0; j < 2; ++j)
+        assert(fabs(R(i, j)) < 1e-9);
+  }
+
+  // 奇异矩阵抛出失败行号
+  SMatrix<3, 3> S = SMatrix<3, 3>::filled(1);
+  ASSERT_EXCEPTION(size_t, solve(S, (SMatrix<3, 1>::filled(1)));)
+  SMatrix<3, 4, float> F = SMatrix<3, 4, float>::identity() * 4;
+  solve_GJ(F);
+  assert(F == (SMatrix<3, 4, float>::identity()));
+  TEST_PASSED;
+}
+
+// 与 Matrix 比较 3x3 矩阵乘法和方程求解的耗时
+void test_SMatrix_repeat()
+{
+  size_t n = 1000000;
+  SMatrix<3, 3> A, B;
+  fill_random(A);
+  fill_random(B);
+  SMatrix<3, 3> C = SMatrix<3, 3>::filled(0);
+  SMatrix<3, 1> b = SMatrix<3, 1>::filled(1), x = b;
+  Matrix MA(3, 3, A), MB(3, 3, B), MC(3, 3, C), MAb(3, 4);
+
+  clock_t start = clock();
+  for(size_t t = 0; t < n; ++t)
+  {
+    C += A * B;
+    A(0, 0) += 1e-9;
+  }
+  double fixed = (double)(clock() - start) / CLOCKS_PER_SEC;
+  start = clock();
+  for(size_t t = 0; t < n; ++t)
+  {
+    MC += MA * MB;
+    MA(0, 0) += 1e-9;
+  }
+  double dynamic = (double)(clock() - start) / CLOCKS_PER_SEC;
+  cout << "It took " << fixed << " s (SMatrix) and " << dynamic << " s (Matrix) to dot two 3x3 matrices "
+       << n << " times (" << dynamic / fixed << "x)." << endl;
+
+  fill_random(A);
+  MA = A.view();
+  start = clock();
+  for(size_t t = 0; t < n; ++t)
+  {
+    x += solve(A, b);
+    A(1, 1) += 1e-9;
+  }
+  fixed = (double)(clock() - start) / CLOCKS_PER_SEC;
+  start = clock();
+  for(size_t t = 0; t < n; ++t)
+  {
+    MAb.col_slice(0, 3) = MA;
+    MAb.col(3).fill(1);
+    solve_GJ(MAb);
+    MA(1, 1) += 1e-9;
+  }
+  dynamic = (double)(clock() - start) / CLOCKS_PER_SEC;
+  cout << "It took " << fixed << " s (SMatrix) and " << dynamic << " s (Matrix) to solve 3x3 equations "
+       << n << " times (" << dynamic / fixed << "x)." << endl;
+  assert(isfinite(x(0, 0)) && fabs(C(0, 0) - MC(0, 0)) < 1e-6 * fabs(C(0, 0)) + 1e-6);
+  TEST_PASSED;
+}
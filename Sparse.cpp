@@ -0,0 +1,291 @@
+#include "Sparse.h"
+#include "Kernel.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+// 非零元不少于此数时 spmm 交给线程池
+constexpr size_t spmm_parallel_min = 1 << 15;
+
+// 按 key 稳定地计数排序 order 中的位置，key 取值于 [0, n)
+template<class Key>
+std::vector<size_t> counting_sort(const std::vector<size_t> &order, size_t n, Key key)
+{
+  std::vector<size_t> start(n + 1, 0), sorted(order.size());
+  for(size_t t : order)
+    ++start[key(t) + 1];
+  for(size_t k = 0; k < n; ++k)
+    start[k + 1] += start[k];
+  for(size_t t : order)
+    sorted[start[key(t)]++] = t;
+  return sorted;
+}
+
+}  // namespace
+
+SparseMatrix::SparseMatrix(size_t nr, size_t nc, SparseLayout layout)
+  : nrow(nr), ncol(nc), lay(layout), p(nouter() + 1, 0)
+{
+  partition();
+}
+
+// 先按内层下标、再按外层下标做两趟稳定计数排序，随后合并重复位置
+SparseMatrix::SparseMatrix(size_t nr, size_t nc, const std::vector<Triplet> &ts,
+    SparseLayout layout)
+  : SparseMatrix(nr, nc, layout)
+{
+  bool csr = lay == SparseLayout::csr;
+  size_t ninner = csr ? ncol : nrow;
+  for(const Triplet &t : ts)
+    if(t.i >= nrow || t.j >= ncol)
+      throw std::out_of_range("triplet index out of range");
+  auto outer = [&](size_t k) { return csr ? ts[k].i : ts[k].j; };
+  auto inner = [&](size_t k) { return csr ? ts[k].j : ts[k].i; };
+
+  std::vector<size_t> order(ts.size());
+  for(size_t k = 0; k < ts.size(); ++k)
+    order[k] = k;
+  order = counting_sort(counting_sort(order, ninner, inner), nouter(), outer);
+
+  ix.reserve(ts.size());
+  v.reserve(ts.size());
+  for(size_t k = 0; k < order.size(); ++k)
+  {
+    size_t t = order[k], o = outer(t);
+    if(k && o == outer(order[k - 1]) && inner(t) == ix.back())
+      v.back() += ts[t].v;
+    else
+    {
+      ix.push_back(inner(t));
+      v.push_back(ts[t].v);
+      ++p[o + 1];
+    }
+  }
+  for(size_t o = 0; o < nouter(); ++o)
+    p[o + 1] += p[o];
+  partition();
+}
+
+SparseMatrix::SparseMatrix(const Matrix &A, SparseLayout layout, Number drop)
+  : SparseMatrix(A.nr(), A.nc(), layout)
+{
+  bool csr = lay == SparseLayout::csr;
+  size_t ninner = csr ? ncol : nrow;
+  for(size_t o = 0; o < nouter(); ++o)
+  {
+    for(size_t k = 0; k < ninner; ++k)
+    {
+      Number a = csr ? A(o, k) : A(k, o);
+      if(std::abs(a) > drop)
+      {
+        ix.push_back(k);
+        v.push_back(a);
+      }
+    }
+    p[o + 1] = v.size();
+  }
+  partition();
+}
+
+SparseMatrix::SparseMatrix(size_t nr, size_t nc, SparseLayout layout, std::vector<size_t> ptr,
+    std::vector<size_t> idx, std::vector<Number> val)
+  : nrow(nr), ncol(nc), lay(layout), p(std::move(ptr)), ix(std::move(idx)), v(std::move(val))
+{
+  size_t ninner = lay == SparseLayout::csr ? ncol : nrow;
+  if(p.size() != nouter() + 1 || p[0] != 0 || p.back() != ix.size() || ix.size() != v.size())
+    throw std::invalid_argument("invalid sparse arrays");
+  for(size_t o = 0; o < nouter(); ++o)
+  {
+    if(p[o] > p[o + 1])
+      throw std::invalid_argument("invalid sparse arrays");
+    for(size_t k = p[o]; k < p[o + 1]; ++k)
+      if(ix[k] >= ninner || (k > p[o] && ix[k] <= ix[k - 1]))
+        throw std::invalid_argument("invalid sparse arrays");
+  }
+  partition();
+}
+
+void SparseMatrix::partition()
+{
+  size_t n = nouter(), parts = spmm_segments;
+  seg.assign(parts + 1, n);
+  seg[0] = 0;
+  for(size_t t = 1; t < parts; ++t)
+    seg[t] = std::lower_bound(p.begin() + seg[t - 1], p.end() - 1, p.back() * t / parts)
+        - p.begin();
+}
+
+Number SparseMatrix::operator()(size_t i, size_t j) const
+{
+  size_t o = i, k = j;
+  if(lay == SparseLayout::csc)
+    std::swap(o, k);
+  auto begin = ix.begin() + p[o], end = ix.begin() + p[o + 1];
+  auto it = std::lower_bound(begin, end, k);
+  return it != end && *it == k ? v[it - ix.begin()] : 0;
+}
+
+SparseMatrix SparseMatrix::t() const &
+{
+  return SparseMatrix(*this).t();
+}
+
+SparseMatrix SparseMatrix::t() &&
+{
+  SparseMatrix T(std::move(*this));
+  std::swap(T.nrow, T.ncol);
+  T.lay = T.lay == SparseLayout::csr ? SparseLayout::csc : SparseLayout::csr;
+  return T;
+}
+
+// 按内层下标计数，依次扫描外层即得到另一方向的有序压缩数组
+SparseMatrix SparseMatrix::to(SparseLayout layout) const
+{
+  if(layout == lay)
+    return *this;
+  SparseMatrix S(nrow, ncol, layout);
+  size_t n = S.nouter();
+  for(size_t k : ix)
+    ++S.p[k + 1];
+  for(size_t o = 0; o < n; ++o)
+    S.p[o + 1] += S.p[o];
+  S.ix.resize(nnz());
+  S.v.resize(nnz());
+  std::vector<size_t> next(S.p.begin(), S.p.end() - 1);
+  for(size_t o = 0; o < nouter(); ++o)
+    for(size_t k = p[o]; k < p[o + 1]; ++k)
+    {
+      size_t dst = next[ix[k]]++;
+      S.ix[dst] = o;
+      S.v[dst] = v[k];
+    }
+  S.partition();
+  return S;
+}
+
+Matrix SparseMatrix::dense() const
+{
+  Matrix A(nrow, ncol);
+  A.fill(0);
+  bool csr = lay == SparseLayout::csr;
+  for(size_t o = 0; o < nouter(); ++o)
+    for(size_t k = p[o]; k < p[o + 1]; ++k)
+      (csr ? A(o, ix[k]) : A(ix[k], o)) = v[k];
+  return A;
+}
+
+namespace {
+
+// Y 的第 [i0, i1) 行 = alpha * A 的相应行 * X + beta * Y
+void spmm_rows(Number alpha, const SparseMatrix &A, const Matrix &X, Number beta,
+    const Matrix &Y, size_t i0, size_t i1)
+{
+  const size_t *p = A.ptr().data(), *ix = A.idx().data();
+  const Number *v = A.val().data();
+  const Number *x = X.ptr();
+  size_t sxr = X.sr();
+  if(X.nc() == 1)
+  {
+    for(size_t i = i0; i < i1; ++i)
+    {
+      Number s = 0;
+      for(size_t k = p[i]; k < p[i + 1]; ++k)
+        s += v[k] * x[ix[k] * sxr];
+      Number &y = Y(i, 0);
+      y = beta == 0 ? alpha * s : alpha * s + beta * y;
+    }
+    return;
+  }
+  const ElementKernels &ek = element_kernels();
+  size_t n = X.nc(), sxc = X.sc(), syc = Y.sc();
+  for(size_t i = i0; i < i1; ++i)
+  {
+    Number *y = &Y(i, 0);
+    if(beta == 0)
+      ek.fill(n, y, syc, 0);
+    else if(beta != 1)
+      ek.mul(n, y, syc, beta);
+    for(size_t k = p[i]; k < p[i + 1]; ++k)
+      ek.axpy(n, y, syc, x + ix[k] * sxr, sxc, alpha * v[k]);
+  }
+}
+
+// Y += alpha * A 的第 [j0, j1) 列 * X 的相应行
+void spmm_cols(Number alpha, const SparseMatrix &A, const Matrix &X, const Matrix &Y,
+    size_t j0, size_t j1)
+{
+  const size_t *p = A.ptr().data(), *ix = A.idx().data();
+  const Number *v = A.val().data();
+  const ElementKernels &ek = element_kernels();
+  size_t n = X.nc(), sxc = X.sc(), syc = Y.sc();
+  for(size_t j = j0; j < j1; ++j)
+  {
+    const Number *x = &X(j, 0);
+    for(size_t k = p[j]; k < p[j + 1]; ++k)
+      ek.axpy(n, &Y(ix[k], 0), syc, x, sxc, alpha * v[k]);
+  }
+}
+
+}  // namespace
+
+void spmm(Number alpha, const SparseMatrix &A, const Matrix &X, Number beta, const Matrix &Y)
+{
+  if(A.nc() != X.nr() || Y.nr() != A.nr() || Y.nc() != X.nc())
+    throw std::domain_error("inconsistent shapes");
+  if(Y.empty())
+    return;
+  size_t threads = A.nnz() >= spmm_parallel_min ? num_threads() : 1;
+
+  if(A.layout() == SparseLayout::csr)
+  {
+    if(threads == 1)
+      return spmm_rows(alpha, A, X, beta, Y, 0, A.nr());
+    // 以引用传入，std::function 不为捕获的变量分配内存
+    const std::vector<size_t> &seg = A.segments();
+    auto task = [&](size_t s) {
+      spmm_rows(alpha, A, X, beta, Y, seg[s], seg[s + 1]);
+    };
+    parallel_for(seg.size() - 1, std::cref(task));
+    return;
+  }
+
+  if(beta == 0)
+    Y.fill(0);
+  else if(beta != 1)
+    Y *= beta;
+  if(threads == 1)
+    return spmm_cols(alpha, A, X, Y, 0, A.nc());
+
+  // 各段按线程合并为列区间，第 0 个区间直接累加到 Y，其余累加到私有缓冲区，
+  // 最后按行区间并行归并
+  const std::vector<size_t> &seg = A.segments();
+  size_t parts = seg.size() - 1, m = Y.nr();
+  Matrix part((threads - 1) * m, Y.nc());
+  part.fill(0);
+  auto accumulate = [&](size_t t) {
+    size_t j0 = seg[parts * t / threads], j1 = seg[parts * (t + 1) / threads];
+    spmm_cols(alpha, A, X, t ? part.row_slice((t - 1) * m, t * m) : Y, j0, j1);
+  };
+  parallel_for(threads, std::cref(accumulate));
+  size_t rows = (m + threads - 1) / threads;
+  auto reduce = [&](size_t t) {
+    size_t i0 = std::min(t * rows, m), i1 = std::min(i0 + rows, m);
+    if(i0 == i1)
+      return;
+    for(size_t b = 0; b + 1 < threads; ++b)
+      Y.row_slice(i0, i1) += part.row_slice(b * m + i0, b * m + i1);
+  };
+  parallel_for(threads, std::cref(reduce));
+}
+
+Matrix operator*(const SparseMatrix &A, const Matrix &X)
+{
+  Matrix Y(A.nr(), X.nc());
+  spmm(1, A, X, 0, Y);
+  return Y;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "Basic.h"
+#include "Matrix.h"
+#include <vector>
+
+// 压缩存储的稀疏矩阵
+//   csr：按行压缩，第 i 行的非零元为 idx/val[ptr[i], ptr[i+1])，idx 为列号
+//   csc：按列压缩，第 j 列的非零元为 idx/val[ptr[j], ptr[j+1])，idx 为行号
+// 每行（列）内的下标严格递增；存储中的元素可以为零（如显式写入的零元）
+enum class SparseLayout { csr, csc };
+
+// 三元组 (i, j, v)，构造稀疏矩阵时同一位置的值相加
+struct Triplet {
+  size_t  i, j;
+  Number  v;
+};
+
+class SparseMatrix {
+private:
+  size_t               nrow;    // 行数
+  size_t               ncol;    // 列数
+  SparseLayout         lay;     // 压缩方向
+  std::vector<size_t>  p;       // 每行（列）的起始位置，共 nouter() + 1 个
+  std::vector<size_t>  ix;      // 非零元的列（行）号
+  std::vector<Number>  v;       // 非零元的值
+  std::vector<size_t>  seg;     // spmm 并行的分点，共 spmm_segments + 1 个
+
+  // 按非零元数将压缩方向均分为 spmm_segments 段，压缩数组确定后调用
+  void partition();
+
+public:
+  // spmm 并行时压缩方向的段数，分段在构造时确定，与线程数无关
+  static constexpr size_t spmm_segments = 64;
+
+  // nr 行 nc 列的零矩阵
+  SparseMatrix(size_t nr, size_t nc, SparseLayout = SparseLayout::csr);
+
+  // 由三元组构造，同一位置的值相加；下标越界时抛 out_of_range
+  SparseMatrix(size_t nr, size_t nc, const std::vector<Triplet> &,
+      SparseLayout = SparseLayout::csr);
+
+  // 由稠密矩阵构造，只保留绝对值大于 drop 的元素
+  explicit SparseMatrix(const Matrix &, SparseLayout = SparseLayout::csr, Number drop = 0);
+
+  // 直接接管压缩数组；数组长度或下标不合法时抛 invalid_argument
+  SparseMatrix(size_t nr, size_t nc, SparseLayout, std::vector<size_t> ptr,
+      std::vector<size_t> idx, std::vector<Number> val);
+
+  size_t nr() const { return nrow; }
+  size_t nc() const { return ncol; }
+  bool square() const { return nrow == ncol; }
+  SparseLayout layout() const { return lay; }
+  size_t nnz() const { return v.size(); }
+
+  // 压缩方向的长度，csr 为行数，csc 为列数
+  size_t nouter() const { return lay == SparseLayout::csr ? nrow : ncol; }
+
+  // 压缩数组，val 可就地修改而不改变非零结构
+  const std::vector<size_t> &ptr() const { return p; }
+  const std::vector<size_t> &idx() const { return ix; }
+  const std::vector<Number> &val() const { return v; }
+  std::vector<Number> &val() { return v; }
+
+  // 第 s 段为压缩方向的 [segments()[s], segments()[s+1])，各段非零元数大致相等
+  const std::vector<size_t> &segments() const { return seg; }
+
+  // 矩阵元，不在非零结构中时为 0（二分查找，无越界检查）
+  Number operator()(size_t i, size_t j) const;
+
+  // 转置，压缩方向随之交换，不重排数组
+  SparseMatrix t() const &;
+  SparseMatrix t() &&;
+
+  // 转换压缩方向，方向相同时拷贝
+  SparseMatrix to(SparseLayout) const;
+
+  // 稠密副本
+  Matrix dense() const;
+};
+
+// Y = alpha * A * X + beta * Y，X 与 Y 为稠密矩阵，列数任意（单列即 SpMV）
+// beta 为 0 时不读取 Y 的原值；Y 不得与 X 重叠
+// 非零元足够多时交给线程池并行，分段取自 A.segments()：csr 各段行区间为一个任务，
+// 不分配内存；csc 将各段按线程合并为列区间，累加到每次调用分配的私有缓冲区后归并，
+// 反复相乘时宜先转为 csr
+// 形状不一致时抛 domain_error
+void spmm(Number alpha, const SparseMatrix &A, const Matrix &X, Number beta, const Matrix &Y);
+
+// 稀疏矩阵与稠密矩阵（或列向量）之积
+Matrix operator*(const SparseMatrix &A, const Matrix &X);
@@ -0,0 +1,231 @@
+#include "TestBasic.h"
+#include "Sparse.h"
+#include "Blas.h"
+#include "ThreadPool.h"
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <chrono>
+
+using namespace std;
+
+void test_sparse_build();
+void test_sparse_convert();
+void test_spmm();
+void test_spmm_parallel();
+void test_spmv_repeat();
+
+int main()
+{
+  srand(time(NULL));
+  test_sparse_build();
+  test_sparse_convert();
+  test_spmm();
+  test_spmm_parallel();
+  test_spmv_repeat();
+}
+
+// 约 density 比例的元素非零，取小整数使乘积精确
+static Matrix random_sparse_dense(size_t nr, size_t nc, int density)
+{
+  Matrix A(nr, nc);
+  for(size_t i = 0; i < nr; ++i)
+    for(size_t j = 0; j < nc; ++j)
+      A(i, j) = rand() % 100 < density ? rand() % 17 - 8 : 0;
+  return A;
+}
+
+static void fill_random(const Matrix &A)
+{
+  for(size_t i = 0; i < A.nr(); ++i)
+    for(size_t j = 0; j < A.nc(); ++j)
+      A(i, j) = rand() % 17 - 8;
+}
+
+// 二维五点差分拉普拉斯算子，m*m 个未知量
+static SparseMatrix laplacian(size_t m, SparseLayout layout = SparseLayout::csr)
+{
+  vector<Triplet> ts;
+  for(size_t i = 0; i < m; ++i)
+    for(size_t j = 0; j < m; ++j)
+    {
+      size_t r = i * m + j;
+      ts.push_back({ r, r, 4 });
+      if(i)
+        ts.push_back({ r, r - m, -1 });
+      if(i + 1 < m)
+        ts.push_back({ r, r + m, -1 });
+      if(j)
+        ts.push_back({ r, r - 1, -1 });
+      if(j + 1 < m)
+        ts.push_back({ r, r + 1, -1 });
+    }
+  return SparseMatrix(m * m, m * m, ts, layout);
+}
+
+void test_sparse_build()
+{
+  // 乱序且含重复位置的三元组
+  vector<Triplet> ts = {
+    { 2, 1, 5 }, { 0, 3, 1 }, { 2, 1, -2 }, { 0, 0, 7 }, { 1, 2, 4 }, { 0, 3, 1 },
+  };
+  for(SparseLayout layout : { SparseLayout::csr, SparseLayout::csc })
+  {
+    SparseMatrix S(3, 4, ts, layout);
+    assert(S.nr() == 3 && S.nc() == 4 && S.nnz() == 4 && S.layout() == layout);
+    assert(S(2, 1) == 3 && S(0, 3) == 2 && S(0, 0) == 7 && S(1, 2) == 4 && S(1, 1) == 0);
+    for(size_t o = 0; o < S.nouter(); ++o)
+      for(size_t k = S.ptr()[o] + 1; k < S.ptr()[o + 1]; ++k)
+        assert(S.idx()[k - 1] < S.idx()[k]);
+  }
+  assert(SparseMatrix(3, 4, ts).ptr() == vector<size_t>({ 0, 2, 3, 4 }));
+  ASSERT_EXCEPTION(out_of_range, SparseMatrix(3, 3, ts);)
+
+  // 稠密矩阵往返
+  Matrix A = random_sparse_dense(37, 23, 20);
+  SparseMatrix S(A), C(A, SparseLayout::csc);
+  assert(S.dense() == A && C.dense() == A && S.nnz() == C.nnz());
+  Matrix B(2, 2);
+  B(0, 0) = 1e-12;
+  B(0, 1) = 1;
+  B(1, 0) = -2e-12;
+  B(1, 1) = 0;
+  assert(SparseMatrix(B).nnz() == 3 && SparseMatrix(B, SparseLayout::csr, 1e-9).nnz() == 1);
+
+  // 直接给出压缩数组
+  SparseMatrix D(2, 3, SparseLayout::csr, { 0, 1, 3 }, { 2, 0, 1 }, { 1, 2, 3 });
+  assert(D(0, 2) == 1 && D(1, 0) == 2 && D(1, 1) == 3);
+  ASSERT_EXCEPTION(invalid_argument, SparseMatrix(2, 3, SparseLayout::csr, { 0, 1 }, { 0 }, { 1 });)
+  ASSERT_EXCEPTION(invalid_argument, SparseMatrix(2, 3, SparseLayout::csr, { 0, 2, 2 }, { 1, 1 }, { 1, 1 });)
+  ASSERT_EXCEPTION(invalid_argument, SparseMatrix(2, 3, SparseLayout::csr, { 0, 1, 1 }, { 3 }, { 1 });)
+  Matrix Z(5, 6);
+  Z.fill(0);
+  assert(SparseMatrix(5, 6).nnz() == 0 && SparseMatrix(5, 6).dense() == Z);
+  TEST_PASSED;
+}
+
+// 分段覆盖压缩方向且单调，各段非零元数不超过均分值加一行（列）
+static void check_segments(const SparseMatrix &S)
+{
+  const vector<size_t> &seg = S.segments(), &p = S.ptr();
+  size_t parts = SparseMatrix::spmm_segments, widest = 0;
+  assert(seg.size() == parts + 1 && seg[0] == 0 && seg[parts] == S.nouter());
+  for(size_t o = 0; o < S.nouter(); ++o)
+    widest = max(widest, p[o + 1] - p[o]);
+  for(size_t t = 0; t < parts; ++t)
+    assert(seg[t] <= seg[t + 1] && p[seg[t + 1]] - p[seg[t]] <= S.nnz() / parts + 1 + widest);
+}
+
+void test_sparse_convert()
+{
+  Matrix A = random_sparse_dense(50, 31, 10);
+  SparseMatrix S(A);
+  SparseMatrix T = S.t();
+  assert(T.nr() == 31 && T.nc() == 50 && T.layout() == SparseLayout::csc);
+  assert(T.dense() == A.t());
+  SparseMatrix C = S.to(SparseLayout::csc);
+  assert(C.layout() == SparseLayout::csc && C.dense() == A);
+  assert(C.to(SparseLayout::csr).idx() == S.idx() && C.to(SparseLayout::csr).ptr() == S.ptr());
+  assert(SparseMatrix(S).t().dense() == A.t());
+  for(const SparseMatrix &M : { S, T, C, SparseMatrix(5, 6), laplacian(40, SparseLayout::csc) })
+    check_segments(M);
+
+  // 只改值不改结构
+  size_t i = 0;
+  while(S.ptr()[i + 1] == 0)
+    ++i;
+  size_t j = S.idx()[0];
+  S.val()[0] *= 2;
+  assert(S.nnz() == T.nnz() && S(i, j) == 2 * A(i, j));
+  TEST_PASSED;
+}
+
+void test_spmm()
+{
+  for(SparseLayout layout : { SparseLayout::csr, SparseLayout::csc })
+  for(size_t k : { 1, 3, 20 })
+  {
+    Matrix A = random_sparse_dense(60, 45, 15);
+    SparseMatrix S(A, layout);
+    Matrix X(45, k), Y(60, k), R(60, k);
+    fill_random(X);
+    fill_random(Y);
+    R = Y;
+    gemm(2, A, X, -3, R);
+    spmm(2, S, X, -3, Y);
+    assert(Y == R);
+    assert(S * X == A * X);
+
+    // 跳步视图
+    Matrix Xt(k, 45), Yt(k, 60);
+    Xt = X.t();
+    Yt.fill(NAN);
+    spmm(1, S, Xt.t(), 0, Yt.t());
+    assert(Yt.t() == A * X);
+  }
+  ASSERT_EXCEPTION(domain_error, SparseMatrix(3, 4) * Matrix(3, 1);)
+  ASSERT_EXCEPTION(domain_error, spmm(1, SparseMatrix(3, 4), Matrix(4, 2), 0, Matrix(3, 1));)
+  TEST_PASSED;
+}
+
+// 足够大时分给多个线程，结果与串行一致
+void test_spmm_parallel()
+{
+  size_t m = 150;
+  for(size_t threads : { 3, 4 })
+  for(SparseLayout layout : { SparseLayout::csr, SparseLayout::csc })
+  for(size_t k : { 1, 4 })
+  {
+    set_num_threads(threads);
+    SparseMatrix L = laplacian(m, layout);
+    Matrix X(m * m, k);
+    fill_random(X);
+    Matrix Y = L * X;
+    for(size_t i = 0; i < m * m; ++i)
+      for(size_t c = 0; c < k; ++c)
+      {
+        Number y = 4 * X(i, c);
+        if(i >= m)
+          y -= X(i - m, c);
+        if(i + m < m * m)
+          y -= X(i + m, c);
+        if(i % m)
+          y -= X(i - 1, c);
+        if((i + 1) % m)
+          y -= X(i + 1, c);
+        assert(Y(i, c) == y);
+      }
+  }
+  set_num_threads(0);
+  TEST_PASSED;
+}
+
+void test_spmv_repeat()
+{
+  size_t m = 1000, n = m * m;
+  clock_t start = clock();
+  SparseMatrix L = laplacian(m);
+  double build = (double)(clock() - start) / CLOCKS_PER_SEC;
+  cout << "It took " << build << " s to build a " << n << "x" << n << " Laplacian with "
+       << L.nnz() << " nonzeros from triplets." << endl;
+
+  Matrix x(n, 1), y(n, 1);
+  x.fill(1);
+  auto wall = chrono::steady_clock::now();
+  for(int t = 0; t < 20; ++t)
+    spmm(1, L, x, 0, y);
+  chrono::duration<double> d = chrono::steady_clock::now() - wall;
+  double bytes = 20.0 * (L.nnz() * (sizeof(Number) + sizeof(size_t)) + 3 * n * sizeof(Number));
+  cout << "It took " << d.count() << " s to multiply it by a vector 20 times with "
+       << num_threads() << " threads (" << bytes / d.count() / 1e9 << " GB/s)." << endl;
+  assert(y(0, 0) == 2 && y(m + 1, 0) == 0);
+
+  SparseMatrix C = L.to(SparseLayout::csc);
+  wall = chrono::steady_clock::now();
+  for(int t = 0; t < 20; ++t)
+    spmm(1, C, x, 0, y);
+  d = chrono::steady_clock::now() - wall;
+  cout << "It took " << d.count() << " s in csc layout." << endl;
+  assert(y(0, 0) == 2 && y(m + 1, 0) == 0);
+  TEST_PASSED;
+}
@@ -2,146 +2,168 @@
 
 #include "Basic.h"
 
-class StepIterator {
+// 以固定跳步遍历矩阵元类型为 T 的数据区
+template<class T>
+class BasicStepIterator {
   friend class StepIteratorTest;
 private:
-  Number  *data;  // 当前位置
+  T       *data;  // 当前位置
   size_t  step;   // 跳步大小
 
 public:
   // 从数据区位置和跳步大小创建跳步迭代器
-  StepIterator(Number *, size_t);
+  BasicStepIterator(T *, size_t);
 
   // 默认构造函数和三类拷贝控制函数
-  StepIterator() = default;  // 未初始化
-  ~StepIterator() = default;
-  StepIterator(const StepIterator &) = default;
-  StepIterator &operator=(const StepIterator &) = default;
+  BasicStepIterator() = default;  // 未初始化
+  ~BasicStepIterator() = default;
+  BasicStepIterator(const BasicStepIterator &) = default;
+  BasicStepIterator &operator=(const BasicStepIterator &) = default;
 
   // 前置增减
-  StepIterator &operator++();
-  StepIterator &operator--();
+  BasicStepIterator &operator++();
+  BasicStepIterator &operator--();
 
   // 后置增减
-  StepIterator operator++(int);
-  StepIterator operator--(int);
+  BasicStepIterator operator++(int);
+  BasicStepIterator operator--(int);
 
   // 解引用
-  Number &operator*() const;
+  T &operator*() const;
 
   // 全序比较
-  bool operator==(const StepIterator &) const;
-  bool operator!=(const StepIterator &) const;
-  bool operator<(const StepIterator &) const;
-  bool operator>(const StepIterator &) const;
-  bool operator<=(const StepIterator &) const;
-  bool operator>=(const StepIterator &) const;
+  bool operator==(const BasicStepIterator &) const;
+  bool operator!=(const BasicStepIterator &) const;
+  bool operator<(const BasicStepIterator &) const;
+  bool operator>(const BasicStepIterator &) const;
+  bool operator<=(const BasicStepIterator &) const;
+  bool operator>=(const BasicStepIterator &) const;
 
   // 随机跳步
-  StepIterator &operator+=(ptrdiff_t);
-  StepIterator &operator-=(ptrdiff_t);
-  StepIterator operator+(ptrdiff_t) const;
-  StepIterator operator-(ptrdiff_t) const;
-  Number &operator[](size_t) const;
+  BasicStepIterator &operator+=(ptrdiff_t);
+  BasicStepIterator &operator-=(ptrdiff_t);
+  BasicStepIterator operator+(ptrdiff_t) const;
+  BasicStepIterator operator-(ptrdiff_t) const;
+  T &operator[](size_t) const;
 
   // 步差计算
-  ptrdiff_t operator-(const StepIterator &) const;
+  ptrdiff_t operator-(const BasicStepIterator &) const;
 };
 
-inline StepIterator::StepIterator(Number *d, size_t s) : data(d), step(s)
+typedef BasicStepIterator<Number> StepIterator;
+
+template<class T>
+inline BasicStepIterator<T>::BasicStepIterator(T *d, size_t s) : data(d), step(s)
 {
   // empty function body
 }
 
-inline StepIterator &StepIterator::operator++()
+template<class T>
+inline BasicStepIterator<T> &BasicStepIterator<T>::operator++()
 {
   data += step;
   return *this;
 }
 
-inline StepIterator StepIterator::operator++(int)
+template<class T>
+inline BasicStepIterator<T> BasicStepIterator<T>::operator++(int)
 {
-  StepIterator iter(*this);
+  BasicStepIterator iter(*this);
   ++*this;
   return iter;
 }
 
-inline Number &StepIterator::operator*() const
+template<class T>
+inline T &BasicStepIterator<T>::operator*() const
 {
   return *data;
 }
 
-inline bool StepIterator::operator==(const StepIterator &iter) const
+template<class T>
+inline bool BasicStepIterator<T>::operator==(const BasicStepIterator &iter) const
 {
   return data == iter.data;
 }
 
-inline bool StepIterator::operator!=(const StepIterator &iter) const
+template<class T>
+inline bool BasicStepIterator<T>::operator!=(const BasicStepIterator &iter) const
 {
   return !(*this == iter);
 }
 
-inline StepIterator &StepIterator::operator--()
+template<class T>
+inline BasicStepIterator<T> &BasicStepIterator<T>::operator--()
 {
   data -= step;
   return *this;
 }
 
-inline StepIterator StepIterator::operator--(int)
+template<class T>
+inline BasicStepIterator<T> BasicStepIterator<T>::operator--(int)
 {
-  StepIterator iter(*this);
+  BasicStepIterator iter(*this);
   --*this;
   return iter;
 }
 
-inline StepIterator &StepIterator::operator+=(ptrdiff_t diff)
+template<class T>
+inline BasicStepIterator<T> &BasicStepIterator<T>::operator+=(ptrdiff_t diff)
 {
-  data += step * diff;
+  data += (ptrdiff_t)step * diff;
   return *this;
 }
 
-inline StepIterator &StepIterator::operator-=(ptrdiff_t diff)
+template<class T>
+inline BasicStepIterator<T> &BasicStepIterator<T>::operator-=(ptrdiff_t diff)
 {
-  data -= step * diff;
+  data -= (ptrdiff_t)step * diff;
   return *this;
 }
 
-inline StepIterator StepIterator::operator+(ptrdiff_t diff) const
+template<class T>
+inline BasicStepIterator<T> BasicStepIterator<T>::operator+(ptrdiff_t diff) const
 {
-  return StepIterator(*this) += diff;
+  return BasicStepIterator(*this) += diff;
 }
 
-inline StepIterator StepIterator::operator-(ptrdiff_t diff) const
+template<class T>
+inline BasicStepIterator<T> BasicStepIterator<T>::operator-(ptrdiff_t diff) const
 {
-  return StepIterator(*this) -= diff;
+  return BasicStepIterator(*this) -= diff;
 }
 
-inline bool StepIterator::operator<(const StepIterator &iter) const
+template<class T>
+inline bool BasicStepIterator<T>::operator<(const BasicStepIterator &iter) const
 {
   return data < iter.data;
 }
 
-inline bool StepIterator::operator<=(const StepIterator &iter) const
+template<class T>
+inline bool BasicStepIterator<T>::operator<=(const BasicStepIterator &iter) const
 {
   return *this < iter || *this == iter;
 }
 
-inline bool StepIterator::operator>(const StepIterator &iter) const
+template<class T>
+inline bool BasicStepIterator<T>::operator>(const BasicStepIterator &iter) const
 {
   return !(*this <= iter);
 }
 
-inline bool StepIterator::operator>=(const StepIterator &iter) const
+template<class T>
+inline bool BasicStepIterator<T>::operator>=(const BasicStepIterator &iter) const
 {
   return !(*this < iter);
 }
 
-inline Number &StepIterator::operator[](size_t i) const
+template<class T>
+inline T &BasicStepIterator<T>::operator[](size_t i) const
 {
   return data[i * step];
 }
 
-inline ptrdiff_t StepIterator::operator-(const StepIterator &iter) const
+template<class T>
+inline ptrdiff_t BasicStepIterator<T>::operator-(const BasicStepIterator &iter) const
 {
-  return (data - iter.data) / step;
+  return (data - iter.data) / (ptrdiff_t)step;
 }
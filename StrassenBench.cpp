@@ -0,0 +1,93 @@
+#include "Blas.h"
+#include "Matrix.h"
+#include "ThreadPool.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+#include <cmath>
+#include <functional>
+#include <complex>
+#include <string>
+
+using namespace std;
+
+// 比较 gemm 与 gemm_strassen，找出 Strassen-Winograd 的交叉点
+// 用法：StrassenBench [最大阶数 [线程数 [元类型]]]，默认 4096 阶、单线程、double
+// 元类型为 float、double、ldouble 或 complex
+// one level 列只递归一层（cutoff = n - 1），它稳定快于 gemm 的阶数
+// 即 strassen_cutoff() 对该类型单线程应取的值；default 列用默认 cutoff 完整递归
+
+static double seconds(const function<void()> &f)
+{
+  // 取两次中较快者，排除首次触页
+  double best = INFINITY;
+  for(int r = 0; r < 2; ++r)
+  {
+    auto start = chrono::steady_clock::now();
+    f();
+    chrono::duration<double> d = chrono::steady_clock::now() - start;
+    best = min(best, d.count());
+  }
+  return best;
+}
+
+template<class T>
+static void bench(size_t nmax)
+{
+  cout << "Threads: " << num_threads() << ", default cutoff: "
+       << strassen_cutoff<T>() << endl;
+  cout << setw(6) << "n" << setw(12) << "gemm/s" << setw(12) << "one level"
+       << setw(12) << "default" << setw(10) << "speedup" << setw(12) << "rel err" << endl;
+
+  default_random_engine engine;
+  uniform_real_distribution<double> urd(-1, 1);
+  for(size_t n : {64, 128, 256, 512, 768, 1024, 1536, 2048, 2560, 3072, 3584, 4096, 5120, 6144})
+  {
+    if(n > nmax)
+      break;
+    BasicMatrix<T> A(n, n), B(n, n), C(n, n), D(n, n), E(n, n);
+    for(size_t i = 0; i < n; ++i)
+      for(size_t j = 0; j < n; ++j)
+      {
+        A(i, j) = T(urd(engine));
+        B(i, j) = T(urd(engine));
+      }
+    scalar_t<T> one = 1, zero = 0;
+    double tg = seconds([&] { gemm(one, A, B, zero, C); });
+    double t1 = seconds([&] { gemm_strassen(one, A, B, zero, D, n - 1); });
+    double td = seconds([&] { gemm_strassen(one, A, B, zero, E); });
+
+    double err = 0, norm = 0;
+    for(size_t i = 0; i < n; ++i)
+      for(size_t j = 0; j < n; ++j)
+      {
+        err = max(err, (double)abs(E(i, j) - C(i, j)));
+        norm = max(norm, (double)abs(C(i, j)));
+      }
+    cout << setw(6) << n << setw(12) << tg << setw(12) << t1 << setw(12) << td
+         << setw(10) << setprecision(3) << tg / td << setw(12) << err / norm
+         << setprecision(6) << endl;
+  }
+}
+
+int main(int argc, char **argv)
+{
+  size_t nmax = argc > 1 ? strtoul(argv[1], NULL, 10) : 4096;
+  set_num_threads(argc > 2 ? strtoul(argv[2], NULL, 10) : 1);
+  string type = argc > 3 ? argv[3] : "double";
+  if(type == "float")
+    bench<float>(nmax);
+  else if(type == "double")
+    bench<double>(nmax);
+  else if(type == "ldouble")
+    bench<long double>(nmax);
+  else if(type == "complex")
+    bench<complex<double>>(nmax);
+  else
+  {
+    cerr << "Unknown element type: " << type << endl;
+    return 1;
+  }
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Matrix.h"
+#include "ThreadPool.h"
+#include <random>
+#include <ctime>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <algorithm>
+
+// 分解类测试共用的随机矩阵与计时辅助
+
+inline std::default_random_engine engine;
+
+// 以当前时间播种并打印种子，失败时可复现
+inline void seed_engine()
+{
+  time_t seed = time(NULL);
+  std::cout << "Use seed: " << seed << std::endl;
+  engine.seed(seed);
+}
+
+// 元素在 [-1, 1) 上均匀分布
+inline Matrix random(size_t nr, size_t nc)
+{
+  std::uniform_real_distribution<Number> urd(-1, 1);
+  Matrix A(nr, nc);
+  for(size_t i = 0; i < nr; ++i)
+    for(size_t j = 0; j < nc; ++j)
+      A(i, j) = urd(engine);
+  return A;
+}
+
+inline Matrix identity(size_t n)
+{
+  Matrix I(n, n);
+  I.fill(0);
+  for(size_t i = 0; i < n; ++i)
+    I(i, i) = 1;
+  return I;
+}
+
+inline Number max_abs(const Matrix &A)
+{
+  Number m = 0;
+  for(size_t i = 0; i < A.nr(); ++i)
+    for(size_t j = 0; j < A.nc(); ++j)
+      m = std::max(m, std::abs(A(i, j)));
+  return m;
+}
+
+// 以 threads 个线程运行 f 并返回其结果，结束后恢复默认线程数
+template<class F>
+auto with_threads(size_t threads, F f)
+{
+  struct Restore { ~Restore() { set_num_threads(0); } } restore;
+  set_num_threads(threads);
+  return f();
+}
+
+// 同上并返回墙钟秒数，多线程时 clock() 会累计各线程的 CPU 时间
+template<class F>
+double threaded_seconds(size_t threads, F f)
+{
+  std::chrono::duration<double> d{};
+  with_threads(threads, [&] {
+    auto wall = std::chrono::steady_clock::now();
+    f();
+    d = std::chrono::steady_clock::now() - wall;
+  });
+  return d.count();
+}
@@ -0,0 +1,220 @@
+#include "ThreadPool.h"
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+#include <exception>
+#include <atomic>
+#include <algorithm>
+
+namespace {
+
+// 每个线程持有一段任务区间 [lo, hi)
+struct alignas(64) TaskQueue {
+  std::mutex  mtx;
+  size_t      lo = 0;
+  size_t      hi = 0;
+};
+
+class ThreadPool {
+private:
+  std::unique_ptr<TaskQueue[]>  queues;
+  std::vector<std::thread>      threads;
+  std::mutex                    mtx;
+  std::condition_variable       cv_start;
+  std::condition_variable       cv_done;
+  size_t                        nthread;
+  size_t                        generation = 0;
+  size_t                        busy = 0;
+  bool                          stop = false;
+  const std::function<void(size_t)> *func = nullptr;
+  std::exception_ptr            error;
+
+  void worker(size_t id);
+  void work(size_t id);
+  bool pop(size_t id, size_t &task);
+  bool steal(size_t id, size_t &task);
+
+public:
+  explicit ThreadPool(size_t n);
+  ~ThreadPool();
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  size_t size() const { return nthread; }
+  void run(size_t n, const std::function<void(size_t)> &f);
+};
+
+thread_local bool in_pool = false;  // 当前线程正在执行池内任务
+
+ThreadPool::ThreadPool(size_t n) : queues(new TaskQueue[n]), nthread(n)
+{
+  threads.reserve(n - 1);
+  for(size_t id = 1; id < n; ++id)
+    threads.emplace_back(&ThreadPool::worker, this, id);
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lk(mtx);
+    stop = true;
+  }
+  cv_start.notify_all();
+  for(std::thread &t : threads)
+    t.join();
+}
+
+void ThreadPool::worker(size_t id)
+{
+  in_pool = true;
+  size_t seen = 0;
+  std::unique_lock<std::mutex> lk(mtx);
+  for(;;)
+  {
+    cv_start.wait(lk, [&] { return stop || generation != seen; });
+    if(stop)
+      return;
+    seen = generation;
+    lk.unlock();
+    work(id);
+    lk.lock();
+    if(!--busy)
+      cv_done.notify_one();
+  }
+}
+
+// 先取自己的区间，取空后窃取，全部取空时返回
+void ThreadPool::work(size_t id)
+{
+  size_t task;
+  while(pop(id, task) || steal(id, task))
+  {
+    try {
+      (*func)(task);
+    }
+    catch(...) {
+      std::lock_guard<std::mutex> lk(mtx);
+      if(!error)
+        error = std::current_exception();
+    }
+  }
+}
+
+bool ThreadPool::pop(size_t id, size_t &task)
+{
+  TaskQueue &q = queues[id];
+  std::lock_guard<std::mutex> lk(q.mtx);
+  if(q.lo == q.hi)
+    return false;
+  task = q.lo++;
+  return true;
+}
+
+// 从其他线程区间尾部窃取一半，首个任务立即执行，其余放入自己的区间
+bool ThreadPool::steal(size_t id, size_t &task)
+{
+  for(size_t d = 1; d < nthread; ++d)
+  {
+    TaskQueue &victim = queues[(id + d) % nthread];
+    size_t lo, hi;
+    {
+      std::lock_guard<std::mutex> lk(victim.mtx);
+      if(victim.lo == victim.hi)
+        continue;
+      hi = victim.hi;
+      lo = victim.hi -= (victim.hi - victim.lo + 1) / 2;
+    }
+    TaskQueue &q = queues[id];
+    std::lock_guard<std::mutex> lk(q.mtx);
+    task = lo;
+    q.lo = lo + 1;
+    q.hi = hi;
+    return true;
+  }
+  return false;
+}
+
+void ThreadPool::run(size_t n, const std::function<void(size_t)> &f)
+{
+  std::unique_lock<std::mutex> lk(mtx);
+  for(size_t id = 0; id < nthread; ++id)
+  {
+    std::lock_guard<std::mutex> qlk(queues[id].mtx);
+    queues[id].lo = n * id / nthread;
+    queues[id].hi = n * (id + 1) / nthread;
+  }
+  func = &f;
+  error = nullptr;
+  busy = nthread - 1;
+  ++generation;
+  lk.unlock();
+  cv_start.notify_all();
+
+  in_pool = true;
+  work(0);
+  in_pool = false;
+
+  lk.lock();
+  cv_done.wait(lk, [&] { return !busy; });
+  func = nullptr;
+  if(error)
+    std::rethrow_exception(error);
+}
+
+std::mutex                  pool_mtx;
+std::unique_ptr<ThreadPool> pool;
+std::atomic<size_t>         pool_size(0);  // 0 表示尚未确定，读取时不加锁
+
+size_t default_num_threads()
+{
+  const char *env = getenv("MATRIX_NUM_THREADS");
+  if(env && atol(env) > 0)
+    return atol(env);
+  return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+}  // namespace
+
+void set_num_threads(size_t n)
+{
+  if(!n)
+    n = std::max(std::thread::hardware_concurrency(), 1u);
+  std::lock_guard<std::mutex> lk(pool_mtx);
+  if(pool && pool->size() != n)
+    pool.reset();
+  pool_size = n;
+}
+
+size_t num_threads()
+{
+  size_t n = pool_size;
+  if(!n)
+  {
+    size_t expected = 0;
+    n = default_num_threads();
+    if(!pool_size.compare_exchange_strong(expected, n))
+      n = expected;
+  }
+  return n;
+}
+
+void parallel_for(size_t n, const std::function<void(size_t)> &f)
+{
+  std::unique_lock<std::mutex> lk(pool_mtx, std::defer_lock);
+  if(n > 1 && !in_pool && lk.try_lock())
+  {
+    size_t size = num_threads();
+    if(size > 1)
+    {
+      if(!pool)
+        pool.reset(new ThreadPool(size));
+      return pool->run(n, f);
+    }
+    lk.unlock();
+  }
+  for(size_t i = 0; i < n; ++i)
+    f(i);
+}
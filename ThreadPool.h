@@ -0,0 +1,17 @@
+#pragma once
+
+#include "Basic.h"
+#include <functional>
+
+// 设置库内并行使用的线程数（含调用线程），0 表示硬件线程数
+// 未调用时由环境变量 MATRIX_NUM_THREADS 决定，未设置则取硬件线程数
+void set_num_threads(size_t);
+
+// 获取库内并行使用的线程数
+size_t num_threads();
+
+// 对 [0, n) 中每个 i 调用一次 f(i)，阻塞直到全部完成
+// 任务按区间均分给各线程，空闲线程从其他线程的区间尾部窃取一半
+// 在任务内嵌套调用，或线程池正被其他线程占用时，在当前线程串行执行
+// 任务抛出的首个异常在全部任务结束后重新抛出
+void parallel_for(size_t n, const std::function<void(size_t)> &f);
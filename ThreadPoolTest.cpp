@@ -0,0 +1,89 @@
+#include "TestBasic.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <vector>
+#include <thread>
+#include <ctime>
+
+using namespace std;
+
+void test_num_threads();
+void test_parallel_for();
+void test_parallel_for_nested();
+void test_parallel_for_exception();
+void test_parallel_for_repeat();
+
+int main()
+{
+  test_num_threads();
+  test_parallel_for();
+  test_parallel_for_nested();
+  test_parallel_for_exception();
+  test_parallel_for_repeat();
+}
+
+void test_num_threads()
+{
+  set_num_threads(3);
+  assert(num_threads() == 3);
+  set_num_threads(0);
+  assert(num_threads() == max(thread::hardware_concurrency(), 1u));
+  TEST_PASSED;
+}
+
+void test_parallel_for()
+{
+  for(size_t nt : {1, 2, 4, 7})
+  {
+    set_num_threads(nt);
+    for(size_t n : {0, 1, 2, 5, 100, 10000})
+    {
+      vector<atomic<int>> hits(n);
+      parallel_for(n, [&](size_t i) { ++hits[i]; });
+      for(size_t i = 0; i < n; ++i)
+        assert(hits[i] == 1);
+    }
+  }
+  TEST_PASSED;
+}
+
+void test_parallel_for_nested()
+{
+  set_num_threads(4);
+  atomic<size_t> sum(0);
+  parallel_for(8, [&](size_t i) {
+    parallel_for(8, [&](size_t j) { sum += i * 8 + j; });
+  });
+  assert(sum == 64 * 63 / 2);
+  TEST_PASSED;
+}
+
+void test_parallel_for_exception()
+{
+  set_num_threads(4);
+  atomic<size_t> count(0);
+  ASSERT_EXCEPTION(out_of_range,
+    parallel_for(100, [&](size_t i) {
+      ++count;
+      if(i == 42)
+        throw out_of_range("task 42");
+    });
+  )
+  assert(count == 100);
+  TEST_PASSED;
+}
+
+void test_parallel_for_repeat()
+{
+  set_num_threads(4);
+  atomic<size_t> count(0);
+  clock_t start = clock();
+  for(int t = 0; t < 10000; ++t)
+    parallel_for(16, [&](size_t) { ++count; });
+  clock_t diff = clock() - start;
+  assert(count == 160000);
+  cout << "It took " << (double)diff / CLOCKS_PER_SEC
+       << " s to dispatch 10000 parallel loops of 16 tasks." << endl;
+  set_num_threads(0);
+  TEST_PASSED;
+}